@@ -78,6 +78,10 @@
 #define HASP_USE_MQTT_ASYNC (HASP_TARGET_PC)
 #endif
 
+#ifndef HASP_USE_MQTT_TRACE
+#define HASP_USE_MQTT_TRACE 0 // Adds the mqtttrace command to record the received messages for replay
+#endif
+
 #ifndef HASP_USE_WIREGUARD
 #define HASP_USE_WIREGUARD 0
 #endif
@@ -149,6 +153,66 @@
 #define HASP_USE_LITTLEFS (HASP_USE_SPIFFS <= 0)
 #endif
 
+#ifndef HASP_USE_PAGE_CACHE
+#define HASP_USE_PAGE_CACHE (HASP_USE_SPIFFS > 0 || HASP_USE_LITTLEFS > 0) // Compiled copy of the pages file
+#endif
+
+#ifndef HASP_FONT_GLYPH_CACHE
+#define HASP_FONT_GLYPH_CACHE (8 * 1024U) // Bytes of glyphs cached for .bin fonts, 0 = load the fonts completely in RAM
+#endif
+
+#ifndef HASP_FONT_LOW_MEMORY
+#define HASP_FONT_LOW_MEMORY (32 * 1024U) // Below this free heap, fonts without users are released
+#endif
+
+#ifndef HASP_FONT_IDLE_TIME
+#define HASP_FONT_IDLE_TIME 60000 // Milliseconds a font stays loaded after its last user is deleted
+#endif
+
+#ifndef HASP_CLOCK_ALL_PAGES
+#define HASP_CLOCK_ALL_PAGES 0 // Also update the template labels on pages that are not visible
+#endif
+
+#ifndef HASP_STATE_BATCH
+#define HASP_STATE_BATCH 0 // Milliseconds object states are collected for the batch subtopic, 0 = one message each
+#endif
+
+#ifndef HASP_STATE_BATCH_SIZE
+#define HASP_STATE_BATCH_SIZE 1024 // Bytes of object states in one batch message
+#endif
+
+#ifndef HASP_USE_IMAGE_FETCH
+#define HASP_USE_IMAGE_FETCH 1 // Download http images in a background task, only used on ESP32
+#endif
+
+#ifndef HASP_IMAGE_CACHE_SIZE
+#define HASP_IMAGE_CACHE_SIZE (32 * 1024U) // Bytes of downloaded images kept to show them again without a download
+#endif
+
+#ifndef HASP_IMAGE_CACHE_SIZE_PSRAM
+#define HASP_IMAGE_CACHE_SIZE_PSRAM (1024 * 1024U) // Bytes of downloaded images kept on boards with PSRAM
+#endif
+
+#ifndef HASP_IMAGE_DECODE_CACHE
+#define HASP_IMAGE_DECODE_CACHE (64 * 1024U) // Bytes of decoded images kept, at most 1/8 of the free heap, 0 = disabled
+#endif
+
+#ifndef HASP_IMAGE_DECODE_CACHE_PSRAM
+#define HASP_IMAGE_DECODE_CACHE_PSRAM (2048 * 1024U) // Bytes of decoded image files kept on boards with PSRAM
+#endif
+
+#ifndef HASP_LOG_MEM_INTERVAL
+#define HASP_LOG_MEM_INTERVAL 1000 // Milliseconds the memory stats of the log prefix are reused, 0 = measure every line
+#endif
+
+#ifndef HASP_LOG_BUFFER_SIZE
+#define HASP_LOG_BUFFER_SIZE 0 // Bytes of log lines queued for the background log task, 0 = write them right away
+#endif
+
+#ifndef HASP_LOG_RING_SIZE
+#define HASP_LOG_RING_SIZE 0 // Bytes of the binary log ring that is dumped with the logring command, 0 = disabled
+#endif
+
 #ifndef HASP_USE_EEPROM
 #define HASP_USE_EEPROM 1
 #endif
@@ -181,6 +245,10 @@
 #define HASP_USE_JPGDECODE 0
 #endif
 
+#ifndef HASP_USE_RLEDECODE
+#define HASP_USE_RLEDECODE 1 // RLE compressed .bin images of tools/hasp_img_convert.py
+#endif
+
 #ifndef HASP_NUM_GPIO_CONFIG
 #define HASP_NUM_GPIO_CONFIG 8
 #endif
@@ -201,6 +269,12 @@
 #endif
 #endif
 
+#ifndef HASP_RESIDENT_PAGES
+#define HASP_RESIDENT_PAGES 0 // Pages kept in memory when pages are built on demand, 0 = build all pages at load
+#endif
+
+#define HASP_USE_LAZY_PAGES (HASP_RESIDENT_PAGES > 0 && (HASP_USE_SPIFFS > 0 || HASP_USE_LITTLEFS > 0))
+
 #define HASP_OBJECT_NOTATION "p%ub%u"
 
 #ifndef HASP_ATTRIBUTE_FAST_MEM
@@ -134,6 +134,13 @@ typedef int16_t lv_coord_t;
 #endif
 #endif // LV_VDB_SIZE
 
+#ifndef LV_VDB_DOUBLE
+#  define LV_VDB_DOUBLE  0             // Allocate a second draw buffer so rendering overlaps the flush
+#endif
+#ifndef LV_VDB_PSRAM
+#  define LV_VDB_PSRAM   0             // Allocate the draw buffers in PSRAM when available
+#endif
+
 /* Garbage Collector settings
  * Used if lvgl is binded to higher level language and the memory is managed by that language */
 #define LV_ENABLE_GC 0
@@ -148,14 +148,32 @@
  **************************************************/
 //#define HASP_USE_MDNS 0                             // Disable MDNS
 //#define HASP_USE_CUSTOM 1                           // Enable compilation of custom code from /src/custom
+//#define HASP_USE_PAGE_CACHE 0                       // Parse pages.jsonl on every boot, without a compiled copy
+//#define HASP_RESIDENT_PAGES 3                       // Build pages when shown and keep only the 3 last used
+//#define HASP_FONT_GLYPH_CACHE (16 * 1024U)          // 16KiB of glyphs cached for .bin fonts read on demand
+//#define HASP_FONT_LOW_MEMORY (64 * 1024U)           // Release unused fonts when the free heap drops below 64KiB
+//#define HASP_CLOCK_ALL_PAGES 1                      // Keep the template labels on hidden pages up to date
+//#define HASP_STATE_BATCH 20                         // Send the object states of 20ms as one message on state/batch
+//#define HASP_USE_MQTT_TRACE 1                       // Record the received MQTT messages with the mqtttrace command
+//#define HASP_USE_IMAGE_FETCH 0                      // Download http images while the GUI waits, like before
+//#define HASP_IMAGE_CACHE_SIZE 0                     // Drop downloaded images that are no longer shown
+//#define HASP_IMAGE_CACHE_SIZE_PSRAM (4096 * 1024U)  // Keep 4MiB of downloaded images in PSRAM
+//#define HASP_IMAGE_DECODE_CACHE 0                   // Decode the image files again each time they are shown
+//#define HASP_IMAGE_DECODE_CACHE_PSRAM (4096 * 1024U) // Keep 4MiB of decoded image files in PSRAM
+//#define HASP_USE_RLEDECODE 0                        // Only draw uncompressed .bin images
 //#define HASP_START_CONSOLE 0                        // Disable starting of serial console at boot
 //#define HASP_START_TELNET 0                         // Disable starting of telnet service at boot
 //#define HASP_START_HTTP 0                           // Disable starting of web interface at boot
 //#define HASP_START_FTP 0                            // Disable starting of ftp server at boot
 //#define LV_MEM_SIZE (64 * 1024U)                    // 64KiB of lvgl memory (default 48)
 //#define LV_VDB_SIZE (32 * 1024U)                    // 32KiB of lvgl draw buffer (default 32)
+//#define LV_VDB_DOUBLE 1                             // Use two draw buffers to render while the display is flushing
+//#define LV_VDB_PSRAM 1                              // Put the draw buffers in PSRAM instead of internal RAM
 //#define HASP_DEBUG_OBJ_TREE                         // Output all objects to the log on page changes
 //#define HASP_LOG_LEVEL LOG_LEVEL_VERBOSE            // LOG_LEVEL_* can be DEBUG, VERBOSE, TRACE, INFO, WARNING, ERROR, CRITICAL, ALERT, FATAL, SILENT
 //#define HASP_LOG_TASKS                              // Also log the Taskname and watermark of ESP32 tasks
+//#define HASP_LOG_MEM_INTERVAL 0                     // Measure the memory for every log line instead of once per second
+//#define HASP_LOG_BUFFER_SIZE (4 * 1024U)            // Queue 4KiB of log lines and write them to serial, telnet and syslog in the background
+//#define HASP_LOG_RING_SIZE (16 * 1024U)             // Keep the last 16KiB of log commands in binary form, download from /logring
 
 #endif // HASP_USER_CONFIG_OVERRIDE_H
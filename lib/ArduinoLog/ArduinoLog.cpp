@@ -107,6 +107,42 @@ void Logging::setSuffix(printfunction f)
     #endif
 }
 
+void Logging::setQueue(queuefunction f)
+{
+    #ifndef DISABLE_LOGGING
+    _queue = f;
+    #endif
+}
+
+#if LOG_RECORDER > 0
+void Logging::setRecorder(recordfunction f, int level)
+{
+    #ifndef DISABLE_LOGGING
+    _recordLevel = level;
+    _recorder    = f;
+    #endif
+}
+#endif
+
+void Logging::printMessage(uint8_t tag, int level, const char * message)
+{
+    #ifndef DISABLE_LOGGING
+    for(int i = 0; i < 3; i++) {
+        if(_logOutput[i] == NULL || level > _level[i]) continue;
+
+        if(_prefix != NULL) {
+            _prefix(tag, level, _logOutput[i]);
+        }
+
+        _logOutput[i]->print(message);
+
+        if(_suffix != NULL) {
+            _suffix(tag, level, _logOutput[i]);
+        }
+    }
+    #endif
+}
+
 void Logging::print(Print * logOutput, const __FlashStringHelper * format, va_list args)
 {
     #ifndef DISABLE_LOGGING
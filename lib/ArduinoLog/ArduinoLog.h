@@ -16,13 +16,31 @@ Licensed under the MIT License <http://opensource.org/licenses/MIT>.
 #define LOGGING_H
 #include <inttypes.h>
 #include <stdarg.h>
+#include <string.h>
+#include <type_traits>
 #if defined(ARDUINO) && ARDUINO >= 100
 #include <Arduino.h>
 #else
 #include "WProgram.h"
 #endif
 //#include "StringStream.h"
+#if defined(USE_CONFIG_OVERRIDE) && !defined(HASP_LOG_RING_SIZE)
+#include "user_config_override.h" // the recorder is only compiled in when the log ring is used
+#endif
+
+#ifndef LOG_RECORDER
+#if defined(HASP_LOG_RING_SIZE) && HASP_LOG_RING_SIZE > 0
+#define LOG_RECORDER 1
+#else
+#define LOG_RECORDER 0
+#endif
+#endif
+
 typedef void (*printfunction)(uint8_t tag, int level, Print*);
+typedef void (*queuefunction)(uint8_t tag, int level, const char* message);
+#if LOG_RECORDER > 0
+typedef void (*recordfunction)(uint8_t tag, int level, const uint8_t* data, size_t length);
+#endif
 
 //#include <stdint.h>
 //#include <stddef.h>
@@ -48,6 +66,133 @@ typedef void (*printfunction)(uint8_t tag, int level, Print*);
 //#define CR "\n"
 #define LOGGING_VERSION 1_0_3
 
+#ifndef LOG_MESSAGE_SIZE
+#define LOG_MESSAGE_SIZE 128 // Longest queued message, it is formatted on the stack of the logging task
+#endif
+
+/**
+ * Print target that collects a formatted message in a fixed buffer
+ */
+class LogBuffer : public Print {
+  public:
+    LogBuffer() : _length(0)
+    {
+        _buffer[0] = 0;
+    }
+
+    size_t write(uint8_t c) override
+    {
+        if(_length >= sizeof(_buffer) - 1) return 0;
+        _buffer[_length++] = c;
+        _buffer[_length]   = 0;
+        return 1;
+    }
+
+    const char* c_str() const
+    {
+        return _buffer;
+    }
+
+  private:
+    char _buffer[LOG_MESSAGE_SIZE];
+    size_t _length;
+};
+
+#if LOG_RECORDER > 0
+#ifndef LOG_RECORD_SIZE
+#define LOG_RECORD_SIZE 128 // Bytes of a binary record, the arguments that do not fit are left out
+#endif
+
+/**
+ * Binary form of a log command for the recorder function: the format string and the raw
+ * arguments, to be formatted later on a host. Each item starts with its type character:
+ *
+ * 'F' address of a flash string (4 bytes)   's' string (length byte + characters)
+ * 'i' 32-bit integer   'q' 64-bit integer   'd' double   'p' pointer   '?' unsupported type
+ *
+ * The first item is the format string, the arguments follow in order.
+ */
+class LogRecord {
+  public:
+    LogRecord() : _length(0)
+    {}
+
+    void add(const __FlashStringHelper* s)
+    {
+        addValue('F', (uint32_t)(uintptr_t)s);
+    }
+
+    void add(const char* s)
+    {
+        if(s == NULL) s = "(null)";
+        size_t len = strlen(s);
+        if(len > 255) len = 255;
+        if(!reserve(2)) return;
+        if(_length + 2 + len > sizeof(_data)) len = sizeof(_data) - _length - 2; // cut off
+        _data[_length++] = 's';
+        _data[_length++] = len;
+        memcpy(_data + _length, s, len);
+        _length += len;
+    }
+
+    void add(char* s)
+    {
+        add((const char*)s);
+    }
+
+    void add(double v)
+    {
+        addValue('d', v);
+    }
+
+    template <class V>
+    typename std::enable_if<std::is_integral<V>::value || std::is_enum<V>::value>::type add(V v)
+    {
+        if(sizeof(V) > 4)
+            addValue('q', (int64_t)v);
+        else
+            addValue('i', (int32_t)v);
+    }
+
+    template <class V> void add(V* p)
+    {
+        addValue('p', (uint32_t)(uintptr_t)p);
+    }
+
+    template <class V> typename std::enable_if<std::is_class<V>::value>::type add(const V&)
+    {
+        if(reserve(1)) _data[_length++] = '?';
+    }
+
+    const uint8_t* data() const
+    {
+        return _data;
+    }
+
+    size_t length() const
+    {
+        return _length;
+    }
+
+  private:
+    bool reserve(size_t size)
+    {
+        return _length + size <= sizeof(_data);
+    }
+
+    template <class V> void addValue(char type, V value)
+    {
+        if(!reserve(1 + sizeof(value))) return;
+        _data[_length++] = type;
+        memcpy(_data + _length, &value, sizeof(value)); // little endian on all targets
+        _length += sizeof(value);
+    }
+
+    uint8_t _data[LOG_RECORD_SIZE];
+    size_t _length;
+};
+#endif // LOG_RECORDER
+
 /**
  * Logging is a helper class to output informations over
  * RS232. If you know log4j or log4net, this logging class
@@ -175,6 +320,38 @@ class Logging {
      */
     void setSuffix(printfunction f);
 
+    /**
+     * Sets a function that receives the formatted messages instead of
+     * the outputs. The queued messages are written with printMessage.
+     *
+     * \param f - The function to be called, NULL to print right away
+     * \return void
+     */
+    void setQueue(queuefunction f);
+
+    /**
+     * Output a formatted message to all outputs of its level,
+     * with the prefix and suffix.
+     *
+     * \param tag - the tag of the original log command
+     * \param level - the level of the original log command
+     * \param message - the formatted message
+     * \return void
+     */
+    void printMessage(uint8_t tag, int level, const char* message);
+
+#if LOG_RECORDER > 0
+    /**
+     * Sets a function that receives a binary LogRecord of each log command
+     * up to the given level, besides the text outputs.
+     *
+     * \param f - The function to be called, NULL to stop recording
+     * \param level - The highest level that is recorded
+     * \return void
+     */
+    void setRecorder(recordfunction f, int level);
+#endif
+
     /**
      * Output a fatal error message. Output message contains
      * F: followed by original message
@@ -317,9 +494,47 @@ class Logging {
 
     void printFormat(Print* logOutput, const char format, va_list* args);
 
-    template <class T> void printLevel(uint8_t tag, int level, T msg, ...)
+    template <class T, typename... Args> void printLevel(uint8_t tag, int level, T msg, Args... args)
+    {
+#ifndef DISABLE_LOGGING
+#if LOG_RECORDER > 0
+        if(_recorder != NULL && level <= _recordLevel) {
+            LogRecord record;
+            record.add(msg);
+            int unused[] = {0, (record.add(args), 0)...};
+            (void)unused;
+            _recorder(tag, level, record.data(), record.length());
+        }
+#endif
+
+        if(!isTextLevel(level)) return; // no output wants the text, don't format it
+        printText(tag, level, msg, args...);
+#endif
+    }
+
+    bool isTextLevel(int level)
     {
 #ifndef DISABLE_LOGGING
+        for(int i = 0; i < 3; i++) {
+            if(_logOutput[i] != NULL && level <= _level[i]) return true;
+        }
+#endif
+        return false;
+    }
+
+    template <class T> void printText(uint8_t tag, int level, T msg, ...)
+    {
+#ifndef DISABLE_LOGGING
+
+        if(_queue != NULL) {
+            LogBuffer buffer;
+            va_list args;
+            va_start(args, msg);
+            print(&buffer, msg, args);
+            va_end(args);
+            _queue(tag, level, buffer.c_str());
+            return;
+        }
 
         for(int i = 0; i < 3; i++) {
             if(_logOutput[i] == NULL || level > _level[i]) continue;
@@ -345,8 +560,13 @@ class Logging {
     bool _showLevel[3];
     Print* _logOutput[3] = {NULL,NULL,NULL};
 
-    printfunction _prefix = NULL;
-    printfunction _suffix = NULL;
+    printfunction _prefix    = NULL;
+    printfunction _suffix    = NULL;
+    queuefunction _queue     = NULL;
+#if LOG_RECORDER > 0
+    recordfunction _recorder = NULL;
+    int _recordLevel         = LOG_LEVEL_SILENT;
+#endif
 #endif
 };
 
@@ -17,6 +17,7 @@
 #include FT_OUTLINE_H
 
 #include "lv_freetype.h"
+#include "hasp_mem.h"
 #include "freertos/FreeRTOS.h"
 #include "freertos/queue.h"
 #include "freertos/task.h"
@@ -58,6 +59,12 @@ typedef bool FT_glyph_dsc_response;
 /*********************
  *      DEFINES
  *********************/
+#if LV_FREETYPE_DISK_CACHE > 0
+#define FT_DISK_MAGIC 0x43475446 /* "FTGC" */
+#define FT_DISK_VERSION 1
+#define FT_DISK_KEY_BYTES 512   /* covers the table directory, which holds a checksum of each table */
+#define FT_DISK_SAVE_DELAY 5000 /* ms to collect the glyphs of a page before the file is written */
+#endif
 
 /**********************
  *      TYPEDEFS
@@ -67,6 +74,45 @@ typedef struct
     lv_ll_t face_ll;
 } lv_faces_control_t;
 
+#if LV_FREETYPE_DISK_CACHE > 0
+/*
+ * Disk cache file: the header, the glyphs sorted by letter, then the 8 bpp bitmaps.
+ * The key identifies the font file, size and style. A file with another key is ignored
+ * and overwritten as soon as the first glyphs of the new font have been rendered.
+ */
+typedef struct
+{
+    uint32_t magic;
+    uint32_t key;
+    uint16_t version;
+    uint16_t count;       /* number of glyphs */
+    uint32_t bitmap_size; /* bytes of bitmaps after the glyphs */
+} ft_disk_header_t;
+
+typedef struct
+{
+    uint32_t letter;
+    uint32_t bitmap_index; /* offset of the bitmap */
+    uint16_t adv_w;
+    uint16_t box_w;
+    uint16_t box_h;
+    int16_t ofs_x;
+    int16_t ofs_y;
+    uint16_t reserved;
+} ft_disk_glyph_t;
+
+typedef struct ft_disk_cache_t
+{
+    ft_disk_header_t header;
+    ft_disk_glyph_t* glyphs;
+    uint8_t* bitmaps;
+    uint16_t glyph_capacity;
+    uint32_t bitmap_capacity;
+    lv_task_t* save_task; /* pending write of new glyphs */
+    char path[64];
+} ft_disk_cache_t;
+#endif
+
 typedef struct name_refer_t
 {
     const char* name; /* point to font name string */
@@ -94,6 +140,15 @@ static const char* name_refer_save(const char* name);
 static void name_refer_del(const char* name);
 static const char* name_refer_find(const char* name);
 
+#if LV_FREETYPE_DISK_CACHE > 0
+static void ft_disk_open(lv_font_t* font);
+static void ft_disk_close(lv_font_t* font);
+static bool ft_disk_get_glyph_dsc(const lv_font_t* font, lv_font_glyph_dsc_t* dsc_out, uint32_t unicode_letter,
+                                  uint32_t unicode_letter_next);
+static void ft_disk_add_glyph(const lv_font_t* font, const lv_font_glyph_dsc_t* dsc, uint32_t unicode_letter,
+                              uint32_t unicode_letter_next);
+#endif
+
 /**********************
  *  STATIC VARIABLES
  **********************/
@@ -117,6 +172,11 @@ static FT_Glyph image_glyph;
 static lv_faces_control_t face_control;
 #endif
 
+#if LV_FREETYPE_DISK_CACHE > 0
+static const uint8_t* ft_disk_bitmap = NULL; /* bitmap of the last glyph served from the disk cache */
+static lv_ft_disk_cache_stats_t ft_disk_stats;
+#endif
+
 /**********************
  *      MACROS
  **********************/
@@ -199,14 +259,23 @@ void lv_freetype_destroy(void)
 bool lv_ft_font_init(lv_ft_info_t* info)
 {
 #if LV_FREETYPE_CACHE_SIZE >= 0
-    return lv_ft_font_init_cache(info);
+    bool success = lv_ft_font_init_cache(info);
 #else
-    return lv_ft_font_init_nocache(info);
+    bool success = lv_ft_font_init_nocache(info);
+#endif
+
+#if LV_FREETYPE_DISK_CACHE > 0
+    if(success) ft_disk_open(info->font);
 #endif
+    return success;
 }
 
 void lv_ft_font_destroy(lv_font_t* font)
 {
+#if LV_FREETYPE_DISK_CACHE > 0
+    ft_disk_close(font);
+#endif
+
 #if LV_FREETYPE_CACHE_SIZE >= 0
     lv_ft_font_destroy_cache(font);
 #else
@@ -219,6 +288,15 @@ size_t lv_ft_freetype_high_watermark()
     return uxTaskGetStackHighWaterMark(FTTaskHandle);
 }
 
+void lv_ft_disk_cache_get_stats(lv_ft_disk_cache_stats_t* stats)
+{
+#if LV_FREETYPE_DISK_CACHE > 0
+    *stats = ft_disk_stats;
+#else
+    _lv_memset_00(stats, sizeof(lv_ft_disk_cache_stats_t));
+#endif
+}
+
 /**********************
  *   STATIC FUNCTIONS
  **********************/
@@ -380,6 +458,10 @@ static const uint8_t* get_glyph_bitmap_cb_cache(const lv_font_t* font, uint32_t
 {
     LV_UNUSED(unicode_letter);
 
+#if LV_FREETYPE_DISK_CACHE > 0
+    if(ft_disk_bitmap) return ft_disk_bitmap;
+#endif
+
     lv_font_fmt_ft_dsc_t* dsc = (lv_font_fmt_ft_dsc_t*)(font->dsc);
     if(dsc->style & FT_FONT_STYLE_BOLD) {
         if(current_face && current_face->glyph->format == FT_GLYPH_FORMAT_BITMAP) {
@@ -402,12 +484,19 @@ static bool get_glyph_dsc_cb(const lv_font_t* font, lv_font_glyph_dsc_t* dsc_out
     static FT_glyph_dsc_request request;
     static FT_glyph_dsc_response response;
 
+#if LV_FREETYPE_DISK_CACHE > 0
+    if(ft_disk_get_glyph_dsc(font, dsc_out, unicode_letter, unicode_letter_next)) return true;
+#endif
+
     request.font                = font;
     request.dsc_out             = dsc_out;
     request.unicode_letter      = unicode_letter;
     request.unicode_letter_next = unicode_letter_next;
     xQueueSendToBack(FTRequestQueue, &request, portMAX_DELAY);
     if(xQueueReceive(FTResponseQueue, &response, portMAX_DELAY)) {
+#if LV_FREETYPE_DISK_CACHE > 0
+        if(response) ft_disk_add_glyph(font, dsc_out, unicode_letter, unicode_letter_next);
+#endif
         return response;
     } else {
         return false; // should never happen
@@ -622,6 +711,10 @@ static bool get_glyph_dsc_cb_nocache(const lv_font_t* font, lv_font_glyph_dsc_t*
 static const uint8_t* get_glyph_bitmap_cb_nocache(const lv_font_t* font, uint32_t unicode_letter)
 {
     LV_UNUSED(unicode_letter);
+
+#if LV_FREETYPE_DISK_CACHE > 0
+    if(ft_disk_bitmap) return ft_disk_bitmap;
+#endif
     lv_font_fmt_ft_dsc_t* dsc = (lv_font_fmt_ft_dsc_t*)(font->dsc);
     FT_Face face              = dsc->size->face;
     return (const uint8_t*)(face->glyph->bitmap.buffer);
@@ -711,6 +804,263 @@ static void lv_ft_font_destroy_nocache(lv_font_t* font)
 
 #endif /* LV_FREETYPE_CACHE_SIZE */
 
+#if LV_FREETYPE_DISK_CACHE > 0
+
+static uint32_t ft_disk_hash(uint32_t hash, const void* data, size_t len)
+{
+    const uint8_t* p = (const uint8_t*)data;
+    while(len--) {
+        hash ^= *p++;
+        hash *= 16777619U;
+    }
+    return hash;
+}
+
+/* Identify the font file by its size and table directory, without reading the whole file */
+static bool ft_disk_key(const lv_font_fmt_ft_dsc_t* dsc, uint32_t* key)
+{
+    uint8_t buf[FT_DISK_KEY_BYTES];
+    uint32_t size = dsc->mem_size;
+    uint32_t read = 0;
+
+    if(dsc->mem) {
+        read = size < sizeof(buf) ? size : sizeof(buf);
+        memcpy(buf, dsc->mem, read);
+    } else {
+        lv_fs_file_t file;
+        if(lv_fs_open(&file, dsc->name, LV_FS_MODE_RD) != LV_FS_RES_OK) return false;
+        lv_fs_res_t res = lv_fs_size(&file, &size);
+        if(res == LV_FS_RES_OK) res = lv_fs_read(&file, buf, sizeof(buf), &read);
+        lv_fs_close(&file);
+        if(res != LV_FS_RES_OK) return false;
+    }
+
+    uint32_t hash = 2166136261U;
+    hash          = ft_disk_hash(hash, &size, sizeof(size));
+    hash          = ft_disk_hash(hash, buf, read);
+    hash          = ft_disk_hash(hash, &dsc->height, sizeof(dsc->height));
+    hash          = ft_disk_hash(hash, &dsc->style, sizeof(dsc->style));
+    *key          = hash;
+    return true;
+}
+
+/* L:\fontname_24.ftc next to the font file, L:\default_24.ftc for the embedded font */
+static void ft_disk_path(const lv_font_fmt_ft_dsc_t* dsc, char* path, size_t size)
+{
+    const char* name = dsc->name;
+    if(name[0] && name[1] == ':') name += 2;
+    while(*name == '\\' || *name == '/') name++;
+
+    size_t len      = strlen(name);
+    const char* ext = strrchr(name, '.');
+    if(ext) len = ext - name;
+
+    if(dsc->style)
+        lv_snprintf(path, size, "L:\\%.*s_%u_%u.ftc", (int)len, name, dsc->height, dsc->style);
+    else
+        lv_snprintf(path, size, "L:\\%.*s_%u.ftc", (int)len, name, dsc->height);
+}
+
+/* Read the glyphs rendered at a previous boot, if the font file has not changed since */
+static void ft_disk_open(lv_font_t* font)
+{
+    lv_font_fmt_ft_dsc_t* dsc = (lv_font_fmt_ft_dsc_t*)(font->dsc);
+    ft_disk_cache_t* disk     = hasp_calloc(1, sizeof(ft_disk_cache_t));
+    if(!disk) return;
+
+    if(!ft_disk_key(dsc, &disk->header.key)) {
+        hasp_free(disk);
+        return;
+    }
+    disk->header.magic   = FT_DISK_MAGIC;
+    disk->header.version = FT_DISK_VERSION;
+    ft_disk_path(dsc, disk->path, sizeof(disk->path));
+    dsc->disk = disk;
+
+    lv_fs_file_t file;
+    if(lv_fs_open(&file, disk->path, LV_FS_MODE_RD) != LV_FS_RES_OK) return; // not cached yet
+
+    ft_disk_header_t header;
+    uint32_t read;
+    if(lv_fs_read(&file, &header, sizeof(header), &read) != LV_FS_RES_OK || read != sizeof(header) ||
+       header.magic != FT_DISK_MAGIC || header.version != FT_DISK_VERSION || header.key != disk->header.key ||
+       header.count * sizeof(ft_disk_glyph_t) + header.bitmap_size > LV_FREETYPE_DISK_CACHE) {
+        LV_LOG_WARN("Font changed, rebuilding %s", disk->path);
+        lv_fs_close(&file);
+        return;
+    }
+
+    size_t glyphs_size = header.count * sizeof(ft_disk_glyph_t);
+    disk->glyphs       = hasp_malloc(glyphs_size);
+    disk->bitmaps      = hasp_malloc(header.bitmap_size);
+    if(disk->glyphs && disk->bitmaps && lv_fs_read(&file, disk->glyphs, glyphs_size, &read) == LV_FS_RES_OK &&
+       read == glyphs_size && lv_fs_read(&file, disk->bitmaps, header.bitmap_size, &read) == LV_FS_RES_OK &&
+       read == header.bitmap_size) {
+        disk->header          = header;
+        disk->glyph_capacity  = header.count;
+        disk->bitmap_capacity = header.bitmap_size;
+        LV_LOG_INFO("Loaded %u glyphs from %s", header.count, disk->path);
+    } else {
+        hasp_free(disk->glyphs);
+        hasp_free(disk->bitmaps);
+        disk->glyphs  = NULL;
+        disk->bitmaps = NULL;
+    }
+    lv_fs_close(&file);
+}
+
+static void ft_disk_save(ft_disk_cache_t* disk)
+{
+    lv_fs_file_t file;
+    if(lv_fs_open(&file, disk->path, LV_FS_MODE_WR) != LV_FS_RES_OK) {
+        LV_LOG_WARN("Failed to write %s", disk->path);
+        return;
+    }
+
+    lv_fs_write(&file, &disk->header, sizeof(disk->header), NULL);
+    lv_fs_write(&file, disk->glyphs, disk->header.count * sizeof(ft_disk_glyph_t), NULL);
+    lv_fs_write(&file, disk->bitmaps, disk->header.bitmap_size, NULL);
+    lv_fs_close(&file);
+    LV_LOG_INFO("Saved %u glyphs to %s", disk->header.count, disk->path);
+}
+
+static void ft_disk_save_cb(lv_task_t* task)
+{
+    ft_disk_cache_t* disk = (ft_disk_cache_t*)task->user_data;
+    ft_disk_save(disk);
+    disk->save_task = NULL;
+    lv_task_del(task);
+}
+
+static void ft_disk_close(lv_font_t* font)
+{
+    if(font == NULL) return;
+
+    lv_font_fmt_ft_dsc_t* dsc = (lv_font_fmt_ft_dsc_t*)(font->dsc);
+    ft_disk_cache_t* disk     = dsc ? dsc->disk : NULL;
+    if(!disk) return;
+
+    if(disk->save_task) { // write the glyphs that are still pending
+        lv_task_del(disk->save_task);
+        ft_disk_save(disk);
+    }
+    ft_disk_bitmap = NULL;
+    hasp_free(disk->glyphs);
+    hasp_free(disk->bitmaps);
+    hasp_free(disk);
+    dsc->disk = NULL;
+}
+
+/* Binary search, returns the index of the letter or where it should be inserted */
+static uint16_t ft_disk_find(const ft_disk_cache_t* disk, uint32_t letter)
+{
+    uint16_t low  = 0;
+    uint16_t high = disk->header.count;
+    while(low < high) {
+        uint16_t mid = (low + high) / 2;
+        if(disk->glyphs[mid].letter < letter)
+            low = mid + 1;
+        else
+            high = mid;
+    }
+    return low;
+}
+
+static bool ft_disk_get_glyph_dsc(const lv_font_t* font, lv_font_glyph_dsc_t* dsc_out, uint32_t unicode_letter,
+                                  uint32_t unicode_letter_next)
+{
+    lv_font_fmt_ft_dsc_t* dsc = (lv_font_fmt_ft_dsc_t*)(font->dsc);
+    ft_disk_cache_t* disk     = dsc->disk;
+    ft_disk_bitmap            = NULL;
+    if(!disk || unicode_letter < 0x20) return false;
+
+    uint16_t i = ft_disk_find(disk, unicode_letter);
+    if(i >= disk->header.count || disk->glyphs[i].letter != unicode_letter) {
+        ft_disk_stats.misses++;
+        return false;
+    }
+
+    const ft_disk_glyph_t* glyph = &disk->glyphs[i];
+    dsc_out->adv_w               = glyph->adv_w;
+    dsc_out->box_w               = glyph->box_w;
+    dsc_out->box_h               = glyph->box_h;
+    dsc_out->ofs_x               = glyph->ofs_x;
+    dsc_out->ofs_y               = glyph->ofs_y;
+    dsc_out->bpp                 = 8;
+
+    if((dsc->style & FT_FONT_STYLE_ITALIC) && (unicode_letter_next == '\0')) {
+        dsc_out->adv_w = dsc_out->box_w + dsc_out->ofs_x;
+    }
+
+    ft_disk_bitmap = disk->bitmaps + glyph->bitmap_index;
+    ft_disk_stats.hits++;
+    return true;
+}
+
+/* Keep a glyph that was just rendered, it is written to the file a few seconds later */
+static void ft_disk_add_glyph(const lv_font_t* font, const lv_font_glyph_dsc_t* dsc, uint32_t unicode_letter,
+                              uint32_t unicode_letter_next)
+{
+    lv_font_fmt_ft_dsc_t* ft_dsc = (lv_font_fmt_ft_dsc_t*)(font->dsc);
+    ft_disk_cache_t* disk        = ft_dsc->disk;
+    if(!disk || unicode_letter < 0x20) return;
+
+    /* The advance of the last italic letter is adjusted, it is not the advance of the glyph */
+    if((ft_dsc->style & FT_FONT_STYLE_ITALIC) && (unicode_letter_next == '\0')) return;
+
+    const uint8_t* bitmap = font->get_glyph_bitmap(font, unicode_letter);
+    uint32_t bitmap_size  = (uint32_t)dsc->box_w * dsc->box_h;
+    if(bitmap_size && !bitmap) return;
+
+    uint16_t count = disk->header.count;
+    if(count == UINT16_MAX ||
+       (count + 1) * sizeof(ft_disk_glyph_t) + disk->header.bitmap_size + bitmap_size > LV_FREETYPE_DISK_CACHE) {
+        return; // the cache file is full
+    }
+
+    uint16_t i = ft_disk_find(disk, unicode_letter);
+    if(i < count && disk->glyphs[i].letter == unicode_letter) return;
+
+    if(count == disk->glyph_capacity) {
+        uint16_t capacity       = count < 32 ? 32 : count * 2;
+        ft_disk_glyph_t* glyphs = hasp_realloc(disk->glyphs, capacity * sizeof(ft_disk_glyph_t));
+        if(!glyphs) return;
+        disk->glyphs         = glyphs;
+        disk->glyph_capacity = capacity;
+    }
+
+    if(disk->header.bitmap_size + bitmap_size > disk->bitmap_capacity) {
+        uint32_t capacity = disk->bitmap_capacity * 2;
+        if(capacity < disk->header.bitmap_size + bitmap_size) capacity = disk->header.bitmap_size + bitmap_size;
+        if(capacity < 1024) capacity = 1024;
+        if(capacity > LV_FREETYPE_DISK_CACHE) capacity = LV_FREETYPE_DISK_CACHE;
+        uint8_t* bitmaps = hasp_realloc(disk->bitmaps, capacity);
+        if(!bitmaps) return;
+        disk->bitmaps         = bitmaps;
+        disk->bitmap_capacity = capacity;
+    }
+
+    memmove(&disk->glyphs[i + 1], &disk->glyphs[i], (count - i) * sizeof(ft_disk_glyph_t));
+    ft_disk_glyph_t* glyph = &disk->glyphs[i];
+    glyph->letter          = unicode_letter;
+    glyph->bitmap_index    = disk->header.bitmap_size;
+    glyph->adv_w           = dsc->adv_w;
+    glyph->box_w           = dsc->box_w;
+    glyph->box_h           = dsc->box_h;
+    glyph->ofs_x           = dsc->ofs_x;
+    glyph->ofs_y           = dsc->ofs_y;
+    glyph->reserved        = 0;
+    if(bitmap_size) memcpy(disk->bitmaps + disk->header.bitmap_size, bitmap, bitmap_size);
+    disk->header.bitmap_size += bitmap_size;
+    disk->header.count++;
+
+    if(!disk->save_task) {
+        disk->save_task = lv_task_create(ft_disk_save_cb, FT_DISK_SAVE_DELAY, LV_TASK_PRIO_LOWEST, disk);
+    }
+}
+
+#endif /* LV_FREETYPE_DISK_CACHE */
+
 /**
  * find name string in names list.name string cnt += 1 if find.
  * @param name name string
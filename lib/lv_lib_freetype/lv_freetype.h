@@ -18,6 +18,9 @@ extern "C" {
 /*********************
  *      DEFINES
  *********************/
+#ifndef LV_FREETYPE_DISK_CACHE
+#define LV_FREETYPE_DISK_CACHE 0 /* bytes of rendered glyphs kept on the filesystem per font, 0 = disabled */
+#endif
 
 /**********************
  *      TYPEDEFS
@@ -45,6 +48,9 @@ typedef struct
     lv_font_t* font;
     uint16_t style;
     uint16_t height;
+#if LV_FREETYPE_DISK_CACHE > 0
+    struct ft_disk_cache_t* disk; /* glyphs rendered at a previous boot */
+#endif
 } lv_font_fmt_ft_dsc_t;
 
 /**********************
@@ -83,6 +89,18 @@ void lv_ft_font_destroy(lv_font_t* font);
 // Unsed Task memory
 size_t lv_ft_freetype_high_watermark();
 
+typedef struct
+{
+    uint32_t hits;   /* glyphs served from the disk cache */
+    uint32_t misses; /* glyphs rendered by FreeType */
+} lv_ft_disk_cache_stats_t;
+
+/**
+ * Get the number of glyphs served from the disk cache since boot
+ * @param stats receives the counters
+ */
+void lv_ft_disk_cache_get_stats(lv_ft_disk_cache_stats_t* stats);
+
 /**********************
  *      MACROS
  **********************/
@@ -87,6 +87,9 @@ class BaseTft {
 #elif USE_FBDEV && HASP_TARGET_PC
 // #warning Building for POSIX fbdev
 #include "tft_driver_posix_fbdev.h"
+#elif USE_HEADLESS && HASP_TARGET_PC
+// #warning Building for POSIX headless
+#include "tft_driver_posix_headless.h"
 #else
 // #warning Building for Generic Tfts
 using dev::BaseTft;
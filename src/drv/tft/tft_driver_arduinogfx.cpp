@@ -281,8 +281,7 @@ void ArduinoGfx::set_invert(bool invert)
     tft->invertDisplay(invert);
 }
 
-/* Update TFT */
-void IRAM_ATTR ArduinoGfx::flush_pixels(lv_disp_drv_t* disp, const lv_area_t* area, lv_color_t* color_p)
+static inline void IRAM_ATTR draw_pixels(Arduino_GFX* tft, const lv_area_t* area, lv_color_t* color_p)
 {
     uint32_t w = (area->x2 - area->x1 + 1);
     uint32_t h = (area->y2 - area->y1 + 1);
@@ -292,10 +291,74 @@ void IRAM_ATTR ArduinoGfx::flush_pixels(lv_disp_drv_t* disp, const lv_area_t* ar
 #else
     tft->draw16bitRGBBitmap(area->x1, area->y1, (uint16_t*)&color_p->full, w, h);
 #endif
+}
+
+#if defined(ARDUINO_ARCH_ESP32)
+/* Arduino_GFX has no asynchronous transfers, a separate task pushes the pixels instead */
+struct flush_job_t
+{
+    lv_disp_drv_t* disp;
+    lv_area_t area;
+    lv_color_t* color_p;
+};
+
+static QueueHandle_t flush_queue      = NULL;
+static volatile uint32_t flush_queued = 0; /* only written by the lvgl task */
+static volatile uint32_t flush_done   = 0; /* only written by the flush task */
+
+static void flush_task(void* args)
+{
+    Arduino_GFX* tft = (Arduino_GFX*)args;
+    flush_job_t job;
+
+    while(xQueueReceive(flush_queue, &job, portMAX_DELAY) == pdTRUE) {
+        draw_pixels(tft, &job.area, job.color_p);
+        lv_disp_flush_ready(job.disp); /* lvgl may now reuse this buffer */
+        flush_done = flush_done + 1;   /* after lv_disp_flush_ready, so flush_end() also waits for it */
+    }
+}
+
+static bool flush_task_start(Arduino_GFX* tft)
+{
+    flush_queue = xQueueCreate(1, sizeof(flush_job_t));
+    if(!flush_queue) return false;
+
+    /* lvgl runs on core 1 */
+    BaseType_t res = xTaskCreatePinnedToCore(flush_task, "flushTask", 1024 * 3, tft, 2, NULL, 0);
+    if(res != pdPASS) {
+        vQueueDelete(flush_queue);
+        flush_queue = NULL;
+        LOG_ERROR(TAG_TFT, F("Failed to start the flush task"));
+        return false;
+    }
+    return true;
+}
+#endif
 
+/* Update TFT */
+void IRAM_ATTR ArduinoGfx::flush_pixels(lv_disp_drv_t* disp, const lv_area_t* area, lv_color_t* color_p)
+{
+#if defined(ARDUINO_ARCH_ESP32)
+    /* Double buffered: lvgl renders into the other buffer while the flush task sends this one */
+    if(disp->buffer->buf2 && (flush_queue || flush_task_start(tft))) {
+        flush_job_t job = {disp, *area, color_p};
+        flush_queued    = flush_queued + 1;
+        xQueueSend(flush_queue, &job, portMAX_DELAY);
+        return;
+    }
+#endif
+
+    draw_pixels(tft, area, color_p);
     lv_disp_flush_ready(disp);
 }
 
+void ArduinoGfx::flush_end()
+{
+#if defined(ARDUINO_ARCH_ESP32)
+    while(flush_done != flush_queued) vTaskDelay(1); /* wait for the flush task to finish all stripes */
+#endif
+}
+
 bool ArduinoGfx::is_driver_pin(uint8_t pin)
 {
     if(false // start condition is always needed
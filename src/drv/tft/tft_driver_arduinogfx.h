@@ -23,6 +23,9 @@
 #include "custom/bootlogo_template.h" // Sketch tab header for xbm images
 #endif
 
+/* flush_pixels() can return before the pixels are sent, flush_end() waits for the transfer */
+#define HASP_TFT_ASYNC_FLUSH 1
+
 namespace dev {
 
 class ArduinoGfx : BaseTft {
@@ -39,6 +42,7 @@ class ArduinoGfx : BaseTft {
     void set_invert(bool invert);
 
     void flush_pixels(lv_disp_drv_t* disp, const lv_area_t* area, lv_color_t* color_p);
+    void flush_end();
     bool is_driver_pin(uint8_t pin);
 
     const char* get_tft_model();
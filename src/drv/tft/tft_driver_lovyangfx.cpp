@@ -1266,15 +1266,28 @@ void IRAM_ATTR LovyanGfx::flush_pixels(lv_disp_drv_t* disp, const lv_area_t* are
     uint32_t h   = (area->y2 - area->y1 + 1);
     uint32_t len = w * h;
 
-    tft.startWrite();                                        /* Start new TFT transaction */
-    tft.setAddrWindow(area->x1, area->y1, w, h);             /* set the working window */
-    tft.writePixels((lgfx::rgb565_t*)&color_p->full, w * h); /* Write words at once */
-    tft.endWrite();                                          /* terminate TFT transaction */
+    if(disp->buffer->buf2) {
+        /* Double buffered: lvgl renders into the other buffer while DMA sends this one.
+         * The transaction stays open, the next setAddrWindow waits for the running transfer */
+        if(tft.getStartCount() == 0) tft.startWrite();            /* Start new TFT transaction */
+        tft.setAddrWindow(area->x1, area->y1, w, h);              /* set the working window */
+        tft.writePixelsDMA((lgfx::rgb565_t*)&color_p->full, len); /* Write words in the background */
+    } else {
+        tft.startWrite();                                      /* Start new TFT transaction */
+        tft.setAddrWindow(area->x1, area->y1, w, h);           /* set the working window */
+        tft.writePixels((lgfx::rgb565_t*)&color_p->full, len); /* Write words at once */
+        tft.endWrite();                                        /* terminate TFT transaction */
+    }
 
     /* Tell lvgl that flushing is done */
     lv_disp_flush_ready(disp);
 }
 
+void LovyanGfx::flush_end()
+{
+    if(tft.getStartCount() > 0) tft.endWrite(); /* waits for the DMA transfer and releases the bus */
+}
+
 bool LovyanGfx::is_driver_pin(uint8_t pin)
 {
     auto panel = tft.getPanel();
@@ -21,6 +21,9 @@
 #include "custom/bootlogo_template.h" // Sketch tab header for xbm images
 #endif
 
+/* flush_pixels() can return before the pixels are sent, flush_end() waits for the transfer */
+#define HASP_TFT_ASYNC_FLUSH 1
+
 namespace dev {
 class LGFX : public lgfx::LGFX_Device {
   public:
@@ -41,6 +44,7 @@ class LovyanGfx : BaseTft {
     void set_invert(bool invert);
 
     void flush_pixels(lv_disp_drv_t* disp, const lv_area_t* area, lv_color_t* color_p);
+    void flush_end();
     bool is_driver_pin(uint8_t pin);
 
     const char* get_tft_model();
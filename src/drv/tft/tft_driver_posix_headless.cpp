@@ -0,0 +1,145 @@
+/* MIT License - Copyright (c) 2019-2024 Francis Van Roie
+   For full license information read the LICENSE file in the project folder */
+
+#if USE_HEADLESS && HASP_TARGET_PC
+
+#include "hasplib.h"
+#include "lvgl.h"
+
+#include "drv/tft/tft_driver.h"
+#include "tft_driver_posix_headless.h"
+
+#include "dev/device.h"
+#include "hasp_debug.h"
+#include "hasp_gui.h"
+
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <pthread.h>
+
+extern uint16_t tft_width;
+extern uint16_t tft_height;
+
+namespace dev {
+
+/**
+ * A task to measure the elapsed time for LittlevGL
+ * @param data unused
+ * @return never return
+ */
+static void* tick_thread(void* data)
+{
+    (void)data;
+
+    while(1) {
+        usleep(5000);   /*Sleep for 5 millisecond*/
+        lv_tick_inc(5); /*Tell LittelvGL that 5 milliseconds were elapsed*/
+    }
+
+    return 0;
+}
+
+static uint64_t headless_micros()
+{
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+int32_t TftHeadlessDrv::width()
+{
+    return _width;
+}
+int32_t TftHeadlessDrv::height()
+{
+    return _height;
+}
+
+static void* gui_entrypoint(void* arg)
+{
+#if HASP_USE_LVGL_TASK
+    // create an LVGL GUI task thread
+    pthread_t gui_pthread;
+    pthread_create(&gui_pthread, 0, (void* (*)(void*))gui_task, NULL);
+#endif
+    // create an LVGL tick thread
+    pthread_t tick_pthread;
+    pthread_create(&tick_pthread, 0, tick_thread, NULL);
+    return 0;
+}
+
+void TftHeadlessDrv::init(int32_t w, int h)
+{
+    _width  = w;
+    _height = h;
+    framebuffer.assign((size_t)w * h, lv_color_black());
+    reset_stats();
+
+    tft_width  = _width;
+    tft_height = _height;
+
+    gui_entrypoint(NULL);
+}
+void TftHeadlessDrv::show_info()
+{
+    LOG_VERBOSE(TAG_TFT, F("Driver     : %s"), get_tft_model());
+    LOG_VERBOSE(TAG_TFT, F("Resolution : %d x %d"), _width, _height);
+}
+
+void TftHeadlessDrv::splashscreen()
+{}
+void TftHeadlessDrv::set_rotation(uint8_t rotation)
+{}
+void TftHeadlessDrv::set_invert(bool invert)
+{}
+
+void TftHeadlessDrv::reset_stats()
+{
+    flush_count        = 0;
+    flush_time_us      = 0;
+    flush_max_us       = 0;
+    flush_pixels_total = 0;
+}
+
+void TftHeadlessDrv::flush_pixels(lv_disp_drv_t* disp, const lv_area_t* area, lv_color_t* color_p)
+{
+    uint64_t start = headless_micros();
+
+    /* Clip to the framebuffer, areas outside of it are only counted */
+    int32_t x1 = LV_MATH_MAX(area->x1, 0);
+    int32_t y1 = LV_MATH_MAX(area->y1, 0);
+    int32_t x2 = LV_MATH_MIN(area->x2, _width - 1);
+    int32_t y2 = LV_MATH_MIN(area->y2, _height - 1);
+    int32_t w  = area->x2 - area->x1 + 1;
+
+    if(x1 <= x2 && y1 <= y2) {
+        size_t len = (x2 - x1 + 1) * sizeof(lv_color_t);
+        for(int32_t y = y1; y <= y2; y++) {
+            const lv_color_t* src = color_p + (y - area->y1) * w + (x1 - area->x1);
+            memcpy(&framebuffer[(size_t)y * _width + x1], src, len);
+        }
+    }
+
+    uint32_t time = headless_micros() - start;
+    flush_count++;
+    flush_time_us += time;
+    flush_pixels_total += (uint64_t)w * (area->y2 - area->y1 + 1);
+    if(time > flush_max_us) flush_max_us = time;
+
+    lv_disp_flush_ready(disp);
+}
+bool TftHeadlessDrv::is_driver_pin(uint8_t pin)
+{
+    return false;
+}
+const char* TftHeadlessDrv::get_tft_model()
+{
+    return "Headless";
+}
+
+} // namespace dev
+
+dev::TftHeadlessDrv haspTft;
+
+#endif // USE_HEADLESS && HASP_TARGET_PC
@@ -0,0 +1,57 @@
+/* MIT License - Copyright (c) 2019-2024 Francis Van Roie
+ For full license information read the LICENSE file in the project folder */
+
+#ifndef HASP_HEADLESS_DRIVER_H
+#define HASP_HEADLESS_DRIVER_H
+
+#include "tft_driver.h"
+
+#if USE_HEADLESS && HASP_TARGET_PC
+// #warning Building H driver HEADLESS
+
+#include "lvgl.h"
+
+#include <vector>
+
+namespace dev {
+
+/* Renders into a framebuffer in memory, for benchmarks and tests without a display */
+class TftHeadlessDrv : BaseTft {
+  public:
+    void init(int w, int h);
+    void show_info();
+    void splashscreen();
+
+    void set_rotation(uint8_t rotation);
+    void set_invert(bool invert);
+
+    void flush_pixels(lv_disp_drv_t* disp, const lv_area_t* area, lv_color_t* color_p);
+    bool is_driver_pin(uint8_t pin);
+
+    const char* get_tft_model();
+
+    int32_t width();
+    int32_t height();
+
+    void reset_stats();
+
+  public:
+    std::vector<lv_color_t> framebuffer;
+
+    uint32_t flush_count;   // flushed areas since the last reset
+    uint64_t flush_time_us; // total time spent copying them
+    uint32_t flush_max_us;  // slowest flush
+    uint64_t flush_pixels_total;
+
+  private:
+    int32_t _width, _height;
+};
+
+} // namespace dev
+
+using dev::TftHeadlessDrv;
+extern dev::TftHeadlessDrv haspTft;
+
+#endif // HASP_TARGET_PC
+
+#endif // HASP_HEADLESS_DRIVER_H
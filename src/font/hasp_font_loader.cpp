@@ -67,11 +67,46 @@ typedef struct cmap_table_bin
     uint8_t padding;
 } cmap_table_bin_t;
 
+#if HASP_FONT_GLYPH_CACHE > 0
+/* Font that reads its glyphs from the file when they are first drawn, only the cmaps are kept in RAM */
+typedef struct
+{
+    lv_font_fmt_txt_dsc_t dsc; /* glyph_dsc and glyph_bitmap stay NULL */
+    lv_fs_file_t file;         /* kept open until the font is freed */
+    font_header_bin_t header;
+    uint32_t loca_start; /* first entry of the loca table */
+    uint32_t loca_count;
+    uint32_t glyph_start; /* start of the glyf table */
+    uint32_t glyph_length;
+} font_stream_dsc_t;
+
+/* A cached glyph, the bitmap directly follows the entry */
+typedef struct glyph_cache_entry
+{
+    struct glyph_cache_entry* hash_next;
+    struct glyph_cache_entry* lru_prev; /* more recently used */
+    struct glyph_cache_entry* lru_next; /* less recently used */
+    const lv_font_t* font;
+    uint32_t letter;
+    lv_font_glyph_dsc_t dsc;
+    bool found;
+    uint16_t size;
+} glyph_cache_entry_t;
+
+#define GLYPH_CACHE_BUCKETS 64
+#endif
+
 /**********************
  *  STATIC PROTOTYPES
  **********************/
 static bit_iterator_t init_bit_iterator(lv_fs_file_t* fp);
 static bool lvgl_load_font(lv_fs_file_t* fp, lv_font_t* font);
+#if HASP_FONT_GLYPH_CACHE > 0
+static bool font_stream_get_glyph_dsc(const lv_font_t* font, lv_font_glyph_dsc_t* dsc_out, uint32_t letter,
+                                      uint32_t letter_next);
+static const uint8_t* font_stream_get_glyph_bitmap(const lv_font_t* font, uint32_t letter);
+static void glyph_cache_purge(const lv_font_t* font);
+#endif
 int32_t load_kern(lv_fs_file_t* fp, lv_font_fmt_txt_dsc_t* font_dsc, uint8_t format, uint32_t start);
 
 static int read_bits_signed(bit_iterator_t* it, int n_bits, lv_fs_res_t* res);
@@ -81,6 +116,24 @@ static unsigned int read_bits(bit_iterator_t* it, int n_bits, lv_fs_res_t* res);
  *      MACROS
  **********************/
 
+/**********************
+ *  STATIC VARIABLES
+ **********************/
+#if HASP_FONT_GLYPH_CACHE > 0
+static glyph_cache_entry_t* glyph_cache_table[GLYPH_CACHE_BUCKETS];
+static glyph_cache_entry_t* glyph_cache_head; /* most recently used */
+static glyph_cache_entry_t* glyph_cache_tail; /* least recently used */
+static hasp_font_cache_stats_t glyph_cache_stats;
+#endif
+static size_t font_load_size; /* bytes allocated for the font being loaded */
+
+/* Allocations that stay with the font are counted, temporary buffers use malloc directly */
+static inline void* font_malloc(size_t size)
+{
+    font_load_size += size;
+    return malloc(size);
+}
+
 /**********************
  *   GLOBAL FUNCTIONS
  **********************/
@@ -88,13 +141,15 @@ static unsigned int read_bits(bit_iterator_t* it, int n_bits, lv_fs_res_t* res);
 /**
  * Loads a `lv_font_t` object from a binary font file
  * @param font_name filename where the font file is located
+ * @param size receives the number of bytes allocated for the font, can be NULL
  * @return a pointer to the font or NULL in case of error
  */
-lv_font_t* hasp_font_load(const char* font_name)
+lv_font_t* hasp_font_load(const char* font_name, size_t* size)
 {
-    bool success = false;
+    bool success   = false;
+    font_load_size = 0;
 
-    lv_font_t* font = (lv_font_t*)malloc(sizeof(lv_font_t));
+    lv_font_t* font = (lv_font_t*)font_malloc(sizeof(lv_font_t));
     memset(font, 0, sizeof(lv_font_t));
 
     lv_fs_file_t file;
@@ -104,7 +159,12 @@ lv_font_t* hasp_font_load(const char* font_name)
         success = lvgl_load_font(&file, font);
     }
 
+#if HASP_FONT_GLYPH_CACHE > 0
+    /* A streamed font took over the file */
+    if(!success || font->get_glyph_bitmap != font_stream_get_glyph_bitmap) lv_fs_close(&file);
+#else
     lv_fs_close(&file);
+#endif
 
     if(!success) {
         // LOG_WARNING(TAG_FONT, "Error loading font %s", font_name);
@@ -117,6 +177,7 @@ lv_font_t* hasp_font_load(const char* font_name)
         font = NULL;
     }
 
+    if(size) *size = font ? font_load_size : 0;
     return font;
 }
 
@@ -171,12 +232,31 @@ void hasp_font_free(lv_font_t* font)
             if(NULL != dsc->glyph_dsc) {
                 free((void*)dsc->glyph_dsc);
             }
+
+#if HASP_FONT_GLYPH_CACHE > 0
+            if(font->get_glyph_bitmap == font_stream_get_glyph_bitmap) {
+                glyph_cache_purge(font);
+                lv_fs_close(&((font_stream_dsc_t*)dsc)->file);
+            }
+#endif
             free(dsc);
         }
         free(font);
     }
 }
 
+#if HASP_FONT_GLYPH_CACHE > 0
+/**
+ * Get the usage of the glyph cache shared by the streamed fonts
+ * @param stats receives the counters
+ */
+void hasp_font_cache_get_stats(hasp_font_cache_stats_t* stats)
+{
+    *stats      = glyph_cache_stats;
+    stats->size = HASP_FONT_GLYPH_CACHE;
+}
+#endif
+
 /**********************
  *   STATIC FUNCTIONS
  **********************/
@@ -260,7 +340,7 @@ static bool load_cmaps_tables(lv_fs_file_t* fp, lv_font_fmt_txt_dsc_t* font_dsc,
         switch(cmap_table[i].format_type) {
             case LV_FONT_FMT_TXT_CMAP_FORMAT0_FULL: {
                 uint8_t ids_size           = sizeof(uint8_t) * cmap_table[i].data_entries_count;
-                uint8_t* glyph_id_ofs_list = (uint8_t*)malloc(ids_size);
+                uint8_t* glyph_id_ofs_list = (uint8_t*)font_malloc(ids_size);
 
                 cmap->glyph_id_ofs_list = glyph_id_ofs_list;
 
@@ -276,7 +356,7 @@ static bool load_cmaps_tables(lv_fs_file_t* fp, lv_font_fmt_txt_dsc_t* font_dsc,
             case LV_FONT_FMT_TXT_CMAP_SPARSE_FULL:
             case LV_FONT_FMT_TXT_CMAP_SPARSE_TINY: {
                 uint32_t list_size     = sizeof(uint16_t) * cmap_table[i].data_entries_count;
-                uint16_t* unicode_list = (uint16_t*)malloc(list_size);
+                uint16_t* unicode_list = (uint16_t*)font_malloc(list_size);
 
                 cmap->unicode_list = unicode_list;
                 cmap->list_length  = cmap_table[i].data_entries_count;
@@ -286,7 +366,7 @@ static bool load_cmaps_tables(lv_fs_file_t* fp, lv_font_fmt_txt_dsc_t* font_dsc,
                 }
 
                 if(cmap_table[i].format_type == LV_FONT_FMT_TXT_CMAP_SPARSE_FULL) {
-                    uint16_t* buf = (uint16_t*)malloc(sizeof(uint16_t) * cmap->list_length);
+                    uint16_t* buf = (uint16_t*)font_malloc(sizeof(uint16_t) * cmap->list_length);
 
                     cmap->glyph_id_ofs_list = buf;
 
@@ -317,7 +397,7 @@ static int32_t load_cmaps(lv_fs_file_t* fp, lv_font_fmt_txt_dsc_t* font_dsc, uin
     }
 
     lv_font_fmt_txt_cmap_t* cmaps =
-        (lv_font_fmt_txt_cmap_t*)malloc(cmaps_subtables_count * sizeof(lv_font_fmt_txt_cmap_t));
+        (lv_font_fmt_txt_cmap_t*)font_malloc(cmaps_subtables_count * sizeof(lv_font_fmt_txt_cmap_t));
 
     memset(cmaps, 0, cmaps_subtables_count * sizeof(lv_font_fmt_txt_cmap_t));
 
@@ -342,7 +422,7 @@ static int32_t load_glyph(lv_fs_file_t* fp, lv_font_fmt_txt_dsc_t* font_dsc, uin
     }
 
     lv_font_fmt_txt_glyph_dsc_t* glyph_dsc =
-        (lv_font_fmt_txt_glyph_dsc_t*)malloc(loca_count * sizeof(lv_font_fmt_txt_glyph_dsc_t));
+        (lv_font_fmt_txt_glyph_dsc_t*)font_malloc(loca_count * sizeof(lv_font_fmt_txt_glyph_dsc_t));
 
     memset(glyph_dsc, 0, loca_count * sizeof(lv_font_fmt_txt_glyph_dsc_t));
 
@@ -413,6 +493,7 @@ static int32_t load_glyph(lv_fs_file_t* fp, lv_font_fmt_txt_dsc_t* font_dsc, uin
 
     uint8_t* glyph_bmp;
     glyph_bmp = (uint8_t*)hasp_malloc(sizeof(uint8_t) * cur_bmp_size);
+    font_load_size += cur_bmp_size;
 
     font_dsc->glyph_bitmap = glyph_bmp;
 
@@ -475,9 +556,14 @@ static int32_t load_glyph(lv_fs_file_t* fp, lv_font_fmt_txt_dsc_t* font_dsc, uin
  */
 static bool lvgl_load_font(lv_fs_file_t* fp, lv_font_t* font)
 {
-    lv_font_fmt_txt_dsc_t* font_dsc = (lv_font_fmt_txt_dsc_t*)malloc(sizeof(lv_font_fmt_txt_dsc_t));
+#if HASP_FONT_GLYPH_CACHE > 0
+    const size_t dsc_size = sizeof(font_stream_dsc_t); /* room for the stream state */
+#else
+    const size_t dsc_size = sizeof(lv_font_fmt_txt_dsc_t);
+#endif
+    lv_font_fmt_txt_dsc_t* font_dsc = (lv_font_fmt_txt_dsc_t*)font_malloc(dsc_size);
 
-    memset(font_dsc, 0, sizeof(lv_font_fmt_txt_dsc_t));
+    memset(font_dsc, 0, dsc_size);
 
     font->dsc = font_dsc;
 
@@ -523,6 +609,27 @@ static bool lvgl_load_font(lv_fs_file_t* fp, lv_font_t* font)
         return false;
     }
 
+#if HASP_FONT_GLYPH_CACHE > 0
+    /* Plain bitmaps are read on demand, compressed fonts are still loaded completely */
+    if(font_header.compression_id == 0 && font_header.index_to_loc_format <= 1) {
+        font_stream_dsc_t* stream = (font_stream_dsc_t*)font_dsc;
+        stream->file              = *fp;
+        stream->header            = font_header;
+        stream->loca_start        = loca_start + 12; /* after the label and the count */
+        stream->loca_count        = loca_count;
+        stream->glyph_start       = loca_start + loca_length;
+        int32_t glyph_length      = read_label(fp, stream->glyph_start, "glyf");
+        if(glyph_length < 0) {
+            return false;
+        }
+        stream->glyph_length = glyph_length;
+
+        font->get_glyph_dsc    = font_stream_get_glyph_dsc;
+        font->get_glyph_bitmap = font_stream_get_glyph_bitmap;
+        return true;
+    }
+#endif
+
     bool failed            = false;
     uint32_t* glyph_offset = (uint32_t*)malloc(sizeof(uint32_t) * (loca_count + 1));
 
@@ -575,6 +682,232 @@ static bool lvgl_load_font(lv_fs_file_t* fp, lv_font_t* font)
     // return kern_length >= 0;
 }
 
+#if HASP_FONT_GLYPH_CACHE > 0
+/* Find the glyph id of a letter in the cmaps, 0 if the font doesn't have it */
+static uint32_t font_stream_glyph_id(const lv_font_fmt_txt_dsc_t* fdsc, uint32_t letter)
+{
+    for(uint16_t i = 0; i < fdsc->cmap_num; i++) {
+        const lv_font_fmt_txt_cmap_t* cmap = &fdsc->cmaps[i];
+        uint32_t rcp                       = letter - cmap->range_start;
+        if(rcp > cmap->range_length) continue;
+
+        if(cmap->type == LV_FONT_FMT_TXT_CMAP_FORMAT0_TINY) {
+            return cmap->glyph_id_start + rcp;
+        } else if(cmap->type == LV_FONT_FMT_TXT_CMAP_FORMAT0_FULL) {
+            return cmap->glyph_id_start + ((const uint8_t*)cmap->glyph_id_ofs_list)[rcp];
+        }
+
+        /* Sparse, binary search in the sorted list of offsets */
+        int32_t low  = 0;
+        int32_t high = cmap->list_length - 1;
+        while(low <= high) {
+            int32_t mid    = (low + high) / 2;
+            uint16_t value = cmap->unicode_list[mid];
+            if(value < rcp) {
+                low = mid + 1;
+            } else if(value > rcp) {
+                high = mid - 1;
+            } else if(cmap->type == LV_FONT_FMT_TXT_CMAP_SPARSE_TINY) {
+                return cmap->glyph_id_start + mid;
+            } else {
+                return cmap->glyph_id_start + ((const uint16_t*)cmap->glyph_id_ofs_list)[mid];
+            }
+        }
+        return 0;
+    }
+    return 0;
+}
+
+static bool font_stream_read_loca(font_stream_dsc_t* stream, uint32_t gid, uint32_t* offset, uint32_t* next_offset)
+{
+    uint8_t entry_size = stream->header.index_to_loc_format == 0 ? 2 : 4;
+    uint8_t buf[8];
+    uint8_t count = gid + 1 < stream->loca_count ? 2 : 1;
+
+    if(LV_FS_SEEK(&stream->file, stream->loca_start + gid * entry_size) != LV_FS_RES_OK ||
+       lv_fs_read(&stream->file, buf, count * entry_size, NULL) != LV_FS_RES_OK)
+        return false;
+
+    if(entry_size == 2) {
+        *offset      = buf[0] | (buf[1] << 8);
+        *next_offset = count == 2 ? (uint32_t)(buf[2] | (buf[3] << 8)) : stream->glyph_length;
+    } else {
+        memcpy(offset, buf, 4);
+        if(count == 2)
+            memcpy(next_offset, buf + 4, 4);
+        else
+            *next_offset = stream->glyph_length;
+    }
+    return *next_offset >= *offset;
+}
+
+static void glyph_cache_unlink(glyph_cache_entry_t* entry)
+{
+    if(entry->lru_prev)
+        entry->lru_prev->lru_next = entry->lru_next;
+    else
+        glyph_cache_head = entry->lru_next;
+
+    if(entry->lru_next)
+        entry->lru_next->lru_prev = entry->lru_prev;
+    else
+        glyph_cache_tail = entry->lru_prev;
+}
+
+static void glyph_cache_push_front(glyph_cache_entry_t* entry)
+{
+    entry->lru_prev = NULL;
+    entry->lru_next = glyph_cache_head;
+    if(glyph_cache_head) glyph_cache_head->lru_prev = entry;
+    glyph_cache_head = entry;
+    if(!glyph_cache_tail) glyph_cache_tail = entry;
+}
+
+static inline uint8_t glyph_cache_bucket(const lv_font_t* font, uint32_t letter)
+{
+    return (((uintptr_t)font >> 4) ^ (letter * 2654435761u)) % GLYPH_CACHE_BUCKETS;
+}
+
+static void glyph_cache_remove(glyph_cache_entry_t* entry)
+{
+    glyph_cache_entry_t** link = &glyph_cache_table[glyph_cache_bucket(entry->font, entry->letter)];
+    while(*link != entry) link = &(*link)->hash_next;
+    *link = entry->hash_next;
+
+    glyph_cache_unlink(entry);
+    glyph_cache_stats.used -= sizeof(glyph_cache_entry_t) + entry->size;
+    hasp_free(entry);
+}
+
+/* Remove all glyphs of a font that is freed */
+static void glyph_cache_purge(const lv_font_t* font)
+{
+    glyph_cache_entry_t* entry = glyph_cache_head;
+    while(entry) {
+        glyph_cache_entry_t* next = entry->lru_next;
+        if(entry->font == font) glyph_cache_remove(entry);
+        entry = next;
+    }
+}
+
+/* Read the descriptor and bitmap of a glyph from the font file */
+static glyph_cache_entry_t* font_stream_load_glyph(const lv_font_t* font, uint32_t letter)
+{
+    font_stream_dsc_t* stream = (font_stream_dsc_t*)font->dsc;
+    font_header_bin_t* header = &stream->header;
+    lv_fs_file_t* fp          = &stream->file;
+    bool is_tab               = letter == '\t';
+    uint32_t gid              = font_stream_glyph_id(&stream->dsc, is_tab ? ' ' : letter);
+
+    lv_font_fmt_txt_glyph_dsc_t gdsc;
+    memset(&gdsc, 0, sizeof(gdsc));
+    uint32_t offset, next_offset;
+    lv_fs_res_t res = LV_FS_RES_OK;
+    int nbits       = header->advance_width_bits + 2 * header->xy_bits + 2 * header->wh_bits;
+    int bmp_size    = 0;
+    bool found      = gid > 0 && gid < stream->loca_count && font_stream_read_loca(stream, gid, &offset, &next_offset);
+
+    bit_iterator_t bit_it = init_bit_iterator(fp);
+    if(found) found = LV_FS_SEEK(fp, stream->glyph_start + offset) == LV_FS_RES_OK;
+    if(found) {
+        gdsc.adv_w = header->advance_width_bits == 0 ? header->default_advance_width
+                                                     : read_bits(&bit_it, header->advance_width_bits, &res);
+        if(header->advance_width_format == 0) gdsc.adv_w *= 16;
+        if(res == LV_FS_RES_OK) gdsc.ofs_x = read_bits_signed(&bit_it, header->xy_bits, &res);
+        if(res == LV_FS_RES_OK) gdsc.ofs_y = read_bits_signed(&bit_it, header->xy_bits, &res);
+        if(res == LV_FS_RES_OK) gdsc.box_w = read_bits(&bit_it, header->wh_bits, &res);
+        if(res == LV_FS_RES_OK) gdsc.box_h = read_bits(&bit_it, header->wh_bits, &res);
+        found = res == LV_FS_RES_OK;
+
+        if(gdsc.box_w * gdsc.box_h != 0) bmp_size = next_offset - offset - nbits / 8;
+        if(bmp_size < 0 || bmp_size > UINT16_MAX) found = false;
+    }
+    if(!found) bmp_size = 0;
+
+    glyph_cache_entry_t* entry = (glyph_cache_entry_t*)hasp_malloc(sizeof(glyph_cache_entry_t) + bmp_size);
+    if(!entry) return NULL;
+    memset(entry, 0, sizeof(glyph_cache_entry_t));
+
+    entry->font   = font;
+    entry->letter = letter;
+    entry->size   = bmp_size;
+    entry->found  = found;
+
+    /* Same bit alignment as when the whole font is loaded */
+    uint8_t* bitmap = (uint8_t*)(entry + 1);
+    if(bmp_size > 0 && nbits % 8 == 0) {
+        entry->found = lv_fs_read(fp, bitmap, bmp_size, NULL) == LV_FS_RES_OK;
+    } else if(bmp_size > 0) {
+        for(int k = 0; k < bmp_size - 1 && res == LV_FS_RES_OK; ++k) bitmap[k] = read_bits(&bit_it, 8, &res);
+        if(res == LV_FS_RES_OK) bitmap[bmp_size - 1] = read_bits(&bit_it, 8 - nbits % 8, &res);
+        entry->found = res == LV_FS_RES_OK;
+    }
+
+    /* Same rounding as lv_font_get_glyph_dsc_fmt_txt without kerning */
+    uint32_t adv_w   = is_tab ? gdsc.adv_w * 2 : gdsc.adv_w;
+    entry->dsc.adv_w = (adv_w + (1 << 3)) >> 4;
+    entry->dsc.box_w = is_tab ? gdsc.box_w * 2 : gdsc.box_w;
+    entry->dsc.box_h = gdsc.box_h;
+    entry->dsc.ofs_x = gdsc.ofs_x;
+    entry->dsc.ofs_y = gdsc.ofs_y;
+    entry->dsc.bpp   = header->bits_per_pixel;
+    return entry;
+}
+
+/* Get a glyph from the cache, or load it and make room by dropping the least recently used glyphs */
+static glyph_cache_entry_t* glyph_cache_get(const lv_font_t* font, uint32_t letter)
+{
+    uint8_t bucket             = glyph_cache_bucket(font, letter);
+    glyph_cache_entry_t* entry = glyph_cache_table[bucket];
+
+    while(entry && (entry->font != font || entry->letter != letter)) entry = entry->hash_next;
+
+    if(entry) {
+        glyph_cache_stats.hits++;
+        if(entry != glyph_cache_head) {
+            glyph_cache_unlink(entry);
+            glyph_cache_push_front(entry);
+        }
+        return entry;
+    }
+
+    glyph_cache_stats.misses++;
+    entry = font_stream_load_glyph(font, letter);
+    if(!entry) return NULL;
+
+    size_t size = sizeof(glyph_cache_entry_t) + entry->size;
+    while(glyph_cache_tail && glyph_cache_stats.used + size > HASP_FONT_GLYPH_CACHE) {
+        glyph_cache_remove(glyph_cache_tail);
+        glyph_cache_stats.evictions++;
+    }
+
+    entry->hash_next          = glyph_cache_table[bucket];
+    glyph_cache_table[bucket] = entry;
+    glyph_cache_stats.used += size;
+    glyph_cache_push_front(entry);
+    return entry;
+}
+
+static bool font_stream_get_glyph_dsc(const lv_font_t* font, lv_font_glyph_dsc_t* dsc_out, uint32_t letter,
+                                      uint32_t letter_next)
+{
+    glyph_cache_entry_t* entry = glyph_cache_get(font, letter);
+    if(!entry || !entry->found) return false;
+
+    *dsc_out = entry->dsc;
+    return true;
+}
+
+/* The bitmap stays valid until another glyph is loaded, lvgl draws it right after getting the descriptor */
+static const uint8_t* font_stream_get_glyph_bitmap(const lv_font_t* font, uint32_t letter)
+{
+    glyph_cache_entry_t* entry = glyph_cache_get(font, letter);
+    if(!entry || !entry->found) return NULL;
+
+    return (const uint8_t*)(entry + 1);
+}
+#endif
+
 // int32_t load_kern(lv_fs_file_t * fp, lv_font_fmt_txt_dsc_t * font_dsc, uint8_t format, uint32_t start)
 // {
 //     int32_t kern_length = read_label(fp, start, "kern");
@@ -21,6 +21,14 @@ extern "C" {
 /**********************
  *      TYPEDEFS
  **********************/
+typedef struct
+{
+    uint32_t hits;      /* glyphs found in the cache */
+    uint32_t misses;    /* glyphs read from the font file */
+    uint32_t evictions; /* glyphs dropped to stay within the budget */
+    uint32_t used;      /* bytes in use */
+    uint32_t size;      /* byte budget */
+} hasp_font_cache_stats_t;
 
 /**********************
  * GLOBAL PROTOTYPES
@@ -28,8 +36,9 @@ extern "C" {
 
 #if LV_USE_FILESYSTEM
 
-lv_font_t * hasp_font_load(const char * fontName);
+lv_font_t * hasp_font_load(const char * fontName, size_t * size);
 void hasp_font_free(lv_font_t * font);
+void hasp_font_cache_get_stats(hasp_font_cache_stats_t * stats);
 
 #endif
 
@@ -217,8 +217,8 @@ void hasp_antiburn_cb(lv_task_t* task)
 {
     lv_obj_t* layer = lv_disp_get_layer_sys(NULL);
     if(layer) {
-        // Fill a buffer with random colors
-        lv_color_t color[1223]; // prime
+        // Fill a buffer with random colors, static because an async flush may still read it after flush_pixels
+        static lv_color_t color[1223]; // prime
         size_t max_len = sizeof(color) / sizeof(color[0]);
         for(size_t x = 0; x < max_len; x++) {
             color[x].full = HASP_RANDOM(UINT16_MAX);
@@ -270,6 +270,10 @@ void hasp_antiburn_cb(lv_task_t* task)
             w = prime[HASP_RANDOM(sizeof(prime) / sizeof(prime[0]))]; // new random width
             area.y1 += h;
         }
+
+#ifdef HASP_TFT_ASYNC_FLUSH
+        haspTft.flush_end(); // wait for the last stripe and release the bus before lvgl refreshes again
+#endif
     }
 
     // task is about to get deleted
@@ -359,6 +363,7 @@ void haspEverySecond()
 {
     hasp_update_sleep_state();
     dispatchEverySecond();
+    font_release_unused(HASP_FONT_IDLE_TIME);
 }
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -612,6 +617,7 @@ void haspSetup(void)
     hasp_init();
     hasp_load_json();
     haspPages.set(haspStartPage, LV_SCR_LOAD_ANIM_NONE, 0, 0);
+    gui_measure_first_frame();
 
     // lv_obj_t* obj        = lv_datetime_create(haspPages.get_obj(haspPages.get()), NULL);
     // obj->user_data.objid = LV_HASP_DATETIME;
@@ -762,6 +768,12 @@ void hasp_get_info(JsonDocument& doc)
     info[F("Idle")]        = size_buf;
     info[F("Active Page")] = haspPages.get();
 
+    gui_perf_t perf        = gui_get_perf();
+    info[F("Refresh Rate")] = std::to_string(perf.fps) + " fps";
+    info[F("Refresh Time")] = std::to_string(perf.refresh_ms) + " ms";
+    info[F("Flush Time")]   = std::to_string(perf.flush_ms) + " ms";
+    if(perf.first_frame_ms) info[F("First Frame")] = std::to_string(perf.first_frame_ms) + " ms";
+
     info = doc.createNestedObject(F(D_INFO_DEVICE_MEMORY));
     Parser::format_bytes(haspDevice.get_free_heap(), size_buf, sizeof(size_buf));
     info[F(D_INFO_FREE_HEAP)] = size_buf;
@@ -778,6 +790,30 @@ void hasp_get_info(JsonDocument& doc)
     }
 #endif
 
+#if LV_USE_FILESYSTEM > 0 && HASP_FONT_GLYPH_CACHE > 0
+    hasp_font_cache_stats_t glyphs;
+    hasp_font_cache_get_stats(&glyphs);
+    Parser::format_bytes(glyphs.used, size_buf, sizeof(size_buf));
+    info[F("Glyph Cache")] = std::string(size_buf) + " (" + std::to_string(glyphs.hits) + " hits, " +
+                             std::to_string(glyphs.misses) + " misses)";
+#endif
+
+#if HASP_IMAGE_DECODE_CACHE > 0 && LV_USE_FILESYSTEM > 0
+    image_cache_stats_t images;
+    image_cache_get_stats(&images);
+    Parser::format_bytes(images.used, size_buf, sizeof(size_buf));
+    info[F("Image Cache")] = std::string(size_buf) + " (" + std::to_string(images.hits) + " hits, " +
+                             std::to_string(images.misses) + " misses, " +
+                             std::to_string(images.misses ? images.decode_ms / images.misses : 0) + " ms/decode)";
+#endif
+
+#if HASP_USE_FREETYPE > 0 && LV_FREETYPE_DISK_CACHE > 0
+    lv_ft_disk_cache_stats_t ft_glyphs;
+    lv_ft_disk_cache_get_stats(&ft_glyphs);
+    info[F("FreeType Cache")] =
+        std::to_string(ft_glyphs.hits) + " hits, " + std::to_string(ft_glyphs.misses) + " misses";
+#endif
+
 #if LV_MEM_CUSTOM == 0
     info = doc.createNestedObject(F(D_INFO_LVGL_MEMORY));
     lv_mem_monitor_t mem_mon;
@@ -788,6 +824,8 @@ void hasp_get_info(JsonDocument& doc)
     info[F(D_INFO_FREE_MEMORY)]   = size_buf;
     info[F(D_INFO_FRAGMENTATION)] = std::to_string(mem_mon.frag_pct) + "%";
 #endif
+
+    font_get_info(doc);
 }
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
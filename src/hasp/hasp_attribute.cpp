@@ -37,6 +37,9 @@ void my_image_release_resources(lv_obj_t* obj)
         case LV_IMG_SRC_VARIABLE: {
             lv_img_set_src(obj, LV_SYMBOL_DUMMY); // empty symbol to clear the image
             lv_img_cache_invalidate_src(src);     // remove src from image cache
+#if HASP_USE_IMAGE_FETCH > 0 && defined(ARDUINO_ARCH_ESP32) && (HASP_USE_WIFI > 0 || HASP_USE_ETHERNET > 0)
+            if(image_fetch_release(src)) break; // downloaded image is freed by the image fetch cache
+#endif
 
             lv_img_dsc_t* img_dsc = (lv_img_dsc_t*)src;
             hasp_free((uint8_t*)img_dsc->data); // free image data
@@ -700,390 +703,6 @@ static void hasp_attribute_get_part_state(lv_obj_t* obj, const char* attr_in, ch
         hasp_attribute_get_part_state_old(obj, attr_in, attr_out, part, state);
 }
 
-/**
- * Change or Retrieve the value of a local attribute of an object PART
- * @param obj lv_obj_t*: the object to get/set the attribute
- * @param attr_p char*: the attribute name (with or without leading ".")
- * @param attr_hash uint16_t: the sbdm hash of the attribute name without leading "."
- * @param payload char*: the new value of the attribute
- * @param update  bool: change/set the value if true, dispatch/get value if false
- * @note setting a value won't return anything, getting will dispatch the value
- */
-static hasp_attribute_type_t hasp_local_style_attr(lv_obj_t* obj, const char* attr_p, uint16_t attr_hash,
-                                                   const char* payload, bool update, int32_t& val)
-{
-    char attr[32];
-    uint8_t part  = LV_OBJ_PART_MAIN;
-    uint8_t state = LV_STATE_DEFAULT;
-    int16_t var   = atoi(payload);
-
-    // test_prop(attr_hash);
-
-    hasp_attribute_get_part_state(obj, attr_p, attr, part, state);
-    attr_hash = Parser::get_sdbm(attr); // attribute name without the index number
-
-    /* ***** WARNING ****************************************************
-     * when using hasp_out use attr_p for the original attribute name
-     * *************************************************************** */
-
-    switch(attr_hash) {
-
-/* 1: Use other blend modes than normal (`LV_BLEND_MODE_...`)*/
-#if LV_USE_BLEND_MODES
-        case ATTR_BG_BLEND_MODE:
-            return attribute_bg_blend_mode(obj, part, state, update, (lv_blend_mode_t)var, val);
-            // case ATTR_TEXT_BLEND_MODE:
-            //     return lv_obj_set_style_local_text_blend_mode(obj, part, state, (lv_blend_mode_t)var);
-            // case ATTR_BORDER_BLEND_MODE:
-            //     return lv_obj_set_style_local_border_blend_mode(obj, part, state, (lv_blend_mode_t)var);
-            // case ATTR_OUTLINE_BLEND_MODE:
-            //     return lv_obj_set_style_local_outline_blend_mode(obj, part, state, (lv_blend_mode_t)var);
-            // case ATTR_SHADOW_BLEND_MODE:
-            //     return lv_obj_set_style_local_shadow_blend_mode(obj, part, state, (lv_blend_mode_t)var);
-            // case ATTR_LINE_BLEND_MODE:
-            //     return lv_obj_set_style_local_line_blend_mode(obj, part, state, (lv_blend_mode_t)var);
-            // case ATTR_VALUE_BLEND_MODE:
-            //     return lv_obj_set_style_local_value_blend_mode(obj, part, state, (lv_blend_mode_t)var);
-            // case ATTR_PATTERN_BLEND_MODE:
-            //     return lv_obj_set_style_local_pattern_blend_mode(obj, part, state, (lv_blend_mode_t)var);
-#endif
-
-        case ATTR_SIZE:
-            return attribute_size(obj, part, state, update, var, val);
-        case ATTR_RADIUS:
-            return attribute_radius(obj, part, state, update, var, val);
-        case ATTR_CLIP_CORNER:
-            return attribute_clip_corner(obj, part, state, update, var, val);
-
-        case ATTR_OPA_SCALE:
-            return attribute_opa_scale(obj, part, state, update, (lv_opa_t)var, val);
-        case ATTR_TRANSFORM_WIDTH:
-            return attribute_transform_width(obj, part, state, update, (lv_style_int_t)var, val);
-        case ATTR_TRANSFORM_HEIGHT:
-            return attribute_transform_height(obj, part, state, update, (lv_style_int_t)var, val);
-
-            /* Background attributes */
-        case ATTR_BG_MAIN_STOP:
-            return attribute_bg_main_stop(obj, part, state, update, (lv_style_int_t)var, val);
-        case ATTR_BG_GRAD_STOP:
-            return attribute_bg_grad_stop(obj, part, state, update, (lv_style_int_t)var, val);
-        case ATTR_BG_GRAD_DIR:
-            return attribute_bg_grad_dir(obj, part, state, update, (lv_grad_dir_t)var, val);
-        case ATTR_BG_COLOR: {
-            if(update) {
-                lv_color32_t c;
-                if(Parser::haspPayloadToColor(payload, c) && part != 64)
-                    lv_obj_set_style_local_bg_color(obj, part, state, lv_color_make(c.ch.red, c.ch.green, c.ch.blue));
-            } else {
-                attr_out_color(obj, attr, lv_obj_get_style_bg_color(obj, part));
-            }
-            return HASP_ATTR_TYPE_METHOD_OK;
-        }
-        case ATTR_BG_GRAD_COLOR:
-            if(update) {
-                lv_color32_t c;
-                if(Parser::haspPayloadToColor(payload, c))
-                    lv_obj_set_style_local_bg_grad_color(obj, part, state,
-                                                         lv_color_make(c.ch.red, c.ch.green, c.ch.blue));
-            } else {
-                attr_out_color(obj, attr, lv_obj_get_style_bg_grad_color(obj, part));
-            }
-            return HASP_ATTR_TYPE_METHOD_OK;
-
-        case ATTR_BG_OPA:
-            return attribute_bg_opa(obj, part, state, update, (lv_opa_t)var, val);
-
-        /* Margin attributes */
-        case ATTR_MARGIN_TOP:
-            return attribute_margin_top(obj, part, state, update, (lv_style_int_t)var, val);
-        case ATTR_MARGIN_BOTTOM:
-            return attribute_margin_bottom(obj, part, state, update, (lv_style_int_t)var, val);
-        case ATTR_MARGIN_LEFT:
-            return attribute_margin_left(obj, part, state, update, (lv_style_int_t)var, val);
-        case ATTR_MARGIN_RIGHT:
-            return attribute_margin_right(obj, part, state, update, (lv_style_int_t)var, val);
-
-        /* Padding attributes */
-        case ATTR_PAD_TOP:
-            return attribute_pad_top(obj, part, state, update, (lv_style_int_t)var, val);
-        case ATTR_PAD_BOTTOM:
-            return attribute_pad_bottom(obj, part, state, update, (lv_style_int_t)var, val);
-        case ATTR_PAD_LEFT:
-            return attribute_pad_left(obj, part, state, update, (lv_style_int_t)var, val);
-        case ATTR_PAD_RIGHT:
-            return attribute_pad_right(obj, part, state, update, (lv_style_int_t)var, val);
-#if LVGL_VERSION_MAJOR == 7
-        case ATTR_PAD_INNER:
-            return attribute_pad_inner(obj, part, state, update, (lv_style_int_t)var, val);
-#endif
-
-        /* Scale attributes */
-        case ATTR_SCALE_GRAD_COLOR: {
-            if(update) {
-                lv_color32_t c;
-                if(Parser::haspPayloadToColor(payload, c) && part != 64)
-                    lv_obj_set_style_local_scale_grad_color(obj, part, state,
-                                                            lv_color_make(c.ch.red, c.ch.green, c.ch.blue));
-            } else {
-                attr_out_color(obj, attr, lv_obj_get_style_scale_grad_color(obj, part));
-            }
-            return HASP_ATTR_TYPE_METHOD_OK;
-        }
-        case ATTR_SCALE_END_COLOR:
-            if(update) {
-                lv_color32_t c;
-                if(Parser::haspPayloadToColor(payload, c))
-                    lv_obj_set_style_local_scale_end_color(obj, part, state,
-                                                           lv_color_make(c.ch.red, c.ch.green, c.ch.blue));
-            } else {
-                attr_out_color(obj, attr, lv_obj_get_style_scale_end_color(obj, part));
-            }
-            return HASP_ATTR_TYPE_METHOD_OK;
-        case ATTR_SCALE_END_LINE_WIDTH:
-            return attribute_scale_end_line_width(obj, part, state, update, (lv_style_int_t)var, val);
-        case ATTR_SCALE_END_BORDER_WIDTH:
-            return attribute_scale_end_border_width(obj, part, state, update, (lv_style_int_t)var, val);
-        case ATTR_SCALE_BORDER_WIDTH:
-            return attribute_scale_border_width(obj, part, state, update, (lv_style_int_t)var, val);
-        case ATTR_SCALE_WIDTH:
-            return attribute_scale_width(obj, part, state, update, (lv_style_int_t)var, val);
-
-        /* Text attributes */
-        case ATTR_TEXT_LETTER_SPACE:
-            return attribute_text_letter_space(obj, part, state, update, (lv_style_int_t)var, val);
-        case ATTR_TEXT_LINE_SPACE:
-            return attribute_text_line_space(obj, part, state, update, (lv_style_int_t)var, val);
-        case ATTR_TEXT_DECOR:
-            return attribute_text_decor(obj, part, state, update, (lv_text_decor_t)var, val);
-        case ATTR_TEXT_OPA:
-            return attribute_text_opa(obj, part, state, update, (lv_opa_t)var, val);
-        case ATTR_TEXT_COLOR: {
-            if(update) {
-                lv_color32_t c;
-                if(Parser::haspPayloadToColor(payload, c))
-                    lv_obj_set_style_local_text_color(obj, part, state, lv_color_make(c.ch.red, c.ch.green, c.ch.blue));
-            } else {
-                attr_out_color(obj, attr, lv_obj_get_style_text_color(obj, part));
-            }
-            return HASP_ATTR_TYPE_METHOD_OK;
-        }
-        case ATTR_TEXT_SEL_COLOR: {
-            if(update) {
-                lv_color32_t c;
-                if(Parser::haspPayloadToColor(payload, c))
-                    lv_obj_set_style_local_text_sel_color(obj, part, state,
-                                                          lv_color_make(c.ch.red, c.ch.green, c.ch.blue));
-            } else {
-                attr_out_color(obj, attr, lv_obj_get_style_text_sel_color(obj, part));
-            }
-            return HASP_ATTR_TYPE_METHOD_OK;
-        }
-        case ATTR_TEXT_FONT: {
-            lv_font_t* font = haspPayloadToFont(payload);
-            if(font) {
-                LOG_DEBUG(TAG_ATTR, "%s %d %x", __FILE__, __LINE__, font);
-                uint8_t count = 3;
-                if(obj_check_type(obj, LV_HASP_ROLLER)) count = my_roller_get_visible_row_count(obj);
-                lv_obj_set_style_local_text_font(obj, part, state, font);
-                if(obj_check_type(obj, LV_HASP_ROLLER)) lv_roller_set_visible_row_count(obj, count);
-                lv_obj_set_style_local_text_font(obj, part, state, font); // again, for roller
-
-                if(obj_check_type(obj, LV_HASP_DROPDOWN)) { // issue #43
-                    lv_obj_set_style_local_text_font(obj, LV_DROPDOWN_PART_MAIN, state, font);
-                    lv_obj_set_style_local_text_font(obj, LV_DROPDOWN_PART_LIST, state, font);
-                    lv_obj_set_style_local_text_font(obj, LV_DROPDOWN_PART_SELECTED, state, font);
-                };
-
-            } else {
-                LOG_WARNING(TAG_ATTR, F("Unknown Font ID %s"), payload);
-            }
-            return HASP_ATTR_TYPE_METHOD_OK;
-        }
-
-        /* Border attributes */
-        case ATTR_BORDER_WIDTH:
-            return attribute_border_width(obj, part, state, update, (lv_style_int_t)var, val);
-        case ATTR_BORDER_SIDE:
-            return attribute_border_side(obj, part, state, update, (lv_border_side_t)var, val);
-        case ATTR_BORDER_POST:
-            attribute_border_post(obj, part, state, update, Parser::is_true(payload), val);
-            return HASP_ATTR_TYPE_BOOL;
-        case ATTR_BORDER_OPA:
-            return attribute_border_opa(obj, part, state, update, (lv_opa_t)var, val);
-        case ATTR_BORDER_COLOR: {
-            if(update) {
-                lv_color32_t c;
-                if(Parser::haspPayloadToColor(payload, c))
-                    lv_obj_set_style_local_border_color(obj, part, state,
-                                                        lv_color_make(c.ch.red, c.ch.green, c.ch.blue));
-            } else {
-                attr_out_color(obj, attr, lv_obj_get_style_border_color(obj, part));
-            }
-            return HASP_ATTR_TYPE_METHOD_OK;
-        }
-
-        /* Outline attributes */
-        case ATTR_OUTLINE_WIDTH:
-            return attribute_outline_width(obj, part, state, update, (lv_style_int_t)var, val);
-        case ATTR_OUTLINE_PAD:
-            return attribute_outline_pad(obj, part, state, update, (lv_style_int_t)var, val);
-        case ATTR_OUTLINE_OPA:
-            return attribute_outline_opa(obj, part, state, update, (lv_opa_t)var, val);
-        case ATTR_OUTLINE_COLOR: {
-            if(update) {
-                lv_color32_t c;
-                if(Parser::haspPayloadToColor(payload, c))
-                    lv_obj_set_style_local_outline_color(obj, part, state,
-                                                         lv_color_make(c.ch.red, c.ch.green, c.ch.blue));
-            } else {
-                attr_out_color(obj, attr, lv_obj_get_style_outline_color(obj, part));
-            }
-            return HASP_ATTR_TYPE_METHOD_OK;
-        }
-
-        /* Shadow attributes */
-#if LV_USE_SHADOW
-        case ATTR_SHADOW_WIDTH:
-            return attribute_shadow_width(obj, part, state, update, (lv_style_int_t)var, val);
-        case ATTR_SHADOW_OFS_X:
-            return attribute_shadow_ofs_x(obj, part, state, update, (lv_style_int_t)var, val);
-        case ATTR_SHADOW_OFS_Y:
-            return attribute_shadow_ofs_y(obj, part, state, update, (lv_style_int_t)var, val);
-        case ATTR_SHADOW_SPREAD:
-            return attribute_shadow_spread(obj, part, state, update, (lv_style_int_t)var, val);
-        case ATTR_SHADOW_OPA:
-            return attribute_shadow_opa(obj, part, state, update, (lv_opa_t)var, val);
-        case ATTR_SHADOW_COLOR: {
-            if(update) {
-                lv_color32_t c;
-                if(Parser::haspPayloadToColor(payload, c))
-                    lv_obj_set_style_local_shadow_color(obj, part, state,
-                                                        lv_color_make(c.ch.red, c.ch.green, c.ch.blue));
-            } else {
-                attr_out_color(obj, attr, lv_obj_get_style_shadow_color(obj, part));
-            }
-            return HASP_ATTR_TYPE_METHOD_OK;
-        }
-#endif
-
-        /* Line attributes */
-        case ATTR_LINE_WIDTH:
-            return attribute_line_width(obj, part, state, update, (lv_style_int_t)var, val);
-        case ATTR_LINE_DASH_WIDTH:
-            return attribute_line_dash_width(obj, part, state, update, (lv_style_int_t)var, val);
-        case ATTR_LINE_DASH_GAP:
-            return attribute_line_dash_gap(obj, part, state, update, (lv_style_int_t)var, val);
-        case ATTR_LINE_ROUNDED:
-            attribute_line_rounded(obj, part, state, update, Parser::is_true(payload), val);
-            return HASP_ATTR_TYPE_BOOL;
-        case ATTR_LINE_OPA:
-            return attribute_line_opa(obj, part, state, update, (lv_opa_t)var, val);
-        case ATTR_LINE_COLOR: {
-            if(update) {
-                lv_color32_t c;
-                if(Parser::haspPayloadToColor(payload, c))
-                    lv_obj_set_style_local_line_color(obj, part, state, lv_color_make(c.ch.red, c.ch.green, c.ch.blue));
-            } else {
-                attr_out_color(obj, attr, lv_obj_get_style_line_color(obj, part));
-            }
-            return HASP_ATTR_TYPE_METHOD_OK;
-        }
-
-        /* Value attributes */
-        case ATTR_VALUE_LETTER_SPACE:
-            return attribute_value_letter_space(obj, part, state, update, (lv_style_int_t)var, val);
-        case ATTR_VALUE_LINE_SPACE:
-            return attribute_value_line_space(obj, part, state, update, (lv_style_int_t)var, val);
-        case ATTR_VALUE_OFS_X:
-            return attribute_value_ofs_x(obj, part, state, update, (lv_style_int_t)var, val);
-        case ATTR_VALUE_OFS_Y:
-            return attribute_value_ofs_y(obj, part, state, update, (lv_style_int_t)var, val);
-        case ATTR_VALUE_ALIGN:
-            return attribute_value_align(obj, part, state, update, (lv_align_t)var, val);
-        case ATTR_VALUE_OPA:
-            return attribute_value_opa(obj, part, state, update, (lv_opa_t)var, val);
-        case ATTR_VALUE_STR: {
-            if(update) {
-                my_obj_set_value_str_text(obj, part, state, payload);
-            } else {
-                attr_out_str(obj, attr, my_obj_get_value_str_text(obj, part, state));
-            }
-            return HASP_ATTR_TYPE_METHOD_OK;
-        }
-        case ATTR_VALUE_COLOR: {
-            if(update) {
-                lv_color32_t c;
-                if(Parser::haspPayloadToColor(payload, c))
-                    lv_obj_set_style_local_value_color(obj, part, state,
-                                                       lv_color_make(c.ch.red, c.ch.green, c.ch.blue));
-            } else {
-                attr_out_color(obj, attr, lv_obj_get_style_value_color(obj, part));
-            }
-            return HASP_ATTR_TYPE_METHOD_OK;
-        }
-        case ATTR_VALUE_FONT: {
-            lv_font_t* font = haspPayloadToFont(payload);
-            if(font) {
-                lv_obj_set_style_local_value_font(obj, part, state, font);
-            } else {
-                LOG_WARNING(TAG_ATTR, F("Unknown Font ID %s"), attr_p);
-            }
-            return HASP_ATTR_TYPE_METHOD_OK;
-        }
-
-        /* Pattern attributes */
-        case ATTR_PATTERN_REPEAT:
-            attribute_pattern_repeat(obj, part, state, update, Parser::is_true(payload), val);
-            return HASP_ATTR_TYPE_BOOL;
-        case ATTR_PATTERN_OPA:
-            return attribute_pattern_opa(obj, part, state, update, (lv_opa_t)var, val);
-        case ATTR_PATTERN_RECOLOR_OPA:
-            return attribute_pattern_recolor_opa(obj, part, state, update, (lv_opa_t)var, val);
-        case ATTR_PATTERN_RECOLOR: {
-            if(update) {
-                lv_color32_t c;
-                if(Parser::haspPayloadToColor(payload, c))
-                    lv_obj_set_style_local_pattern_recolor(obj, part, state,
-                                                           lv_color_make(c.ch.red, c.ch.green, c.ch.blue));
-            } else {
-                attr_out_color(obj, attr, lv_obj_get_style_pattern_recolor(obj, part));
-            }
-            return HASP_ATTR_TYPE_METHOD_OK;
-        }
-
-        case ATTR_PATTERN_IMAGE:
-            //   return lv_obj_set_style_local_pattern_image(obj, part, state, (constvoid *)var);
-            // return;
-
-            /* Image attributes */
-        case ATTR_IMAGE_RECOLOR_OPA:
-            return attribute_image_recolor_opa(obj, part, state, update, (lv_opa_t)var, val);
-        case ATTR_IMAGE_OPA:
-            return attribute_image_opa(obj, part, state, update, (lv_opa_t)var, val);
-        case ATTR_IMAGE_RECOLOR: {
-            if(update) {
-                lv_color32_t c;
-                if(Parser::haspPayloadToColor(payload, c))
-                    lv_obj_set_style_local_image_recolor(obj, part, state,
-                                                         lv_color_make(c.ch.red, c.ch.green, c.ch.blue));
-            } else {
-                attr_out_color(obj, attr, lv_obj_get_style_image_recolor(obj, part));
-            }
-            return HASP_ATTR_TYPE_METHOD_OK;
-        }
-
-            /* Transition attributes */
-            // Todo
-
-        default:
-            break;
-    }
-
-    // LOG_WARNING(TAG_ATTR, F(D_ATTRIBUTE_UNKNOWN " (%d)"), attr_p, attr_hash);
-    // result = false;
-    return HASP_ATTR_TYPE_NOT_FOUND;
-}
-
 static hasp_attribute_type_t hasp_process_arc_attribute(lv_obj_t* obj, uint16_t attr_hash, int32_t& val, bool update)
 {
     // We already know it's a arc object
@@ -1331,6 +950,9 @@ static hasp_attribute_type_t special_attribute_src(lv_obj_t* obj, const char* pa
 
         if(payload != strstr_P(payload, PSTR("http://")) &&  // not start with http
            payload != strstr_P(payload, PSTR("https://"))) { // not start with https
+#if HASP_USE_IMAGE_FETCH > 0 && defined(ARDUINO_ARCH_ESP32) && (HASP_USE_WIFI > 0 || HASP_USE_ETHERNET > 0)
+            image_fetch_cancel(obj); // a pending download must not replace this src
+#endif
 
             if(payload == strstr_P(payload, PSTR("L:"))) { // startsWith command/
                 my_image_release_resources(obj);
@@ -1352,6 +974,9 @@ static hasp_attribute_type_t special_attribute_src(lv_obj_t* obj, const char* pa
         } else {
 #if defined(ARDUINO) && defined(ARDUINO_ARCH_ESP32)
 #if HASP_USE_WIFI > 0 || HASP_USE_ETHERNET > 0
+#if HASP_USE_IMAGE_FETCH > 0
+            image_fetch_src(obj, payload); // swapped in when the download is complete
+#else
             HTTPClient http;
             // http.begin(payload, (const char*)rootca_crt_bundle_start);
             http.begin(payload);
@@ -1497,6 +1122,7 @@ static hasp_attribute_type_t special_attribute_src(lv_obj_t* obj, const char* pa
                 LOG_WARNING(TAG_ATTR, "HTTP result %d", httpCode);
             }
             http.end();
+#endif // HASP_USE_IMAGE_FETCH
 #endif // HASP_USE_NETWORK
 #endif // ESP32
         }
@@ -1697,37 +1323,28 @@ static hasp_attribute_type_t attribute_common_json(lv_obj_t* obj, uint16_t attr_
 {
     switch(attr_hash) {
         case ATTR_JSONL: {
-            DeserializationError jsonError = DeserializationError::Ok;
+            hasp_jsonl_result_t result = HASP_JSONL_OK;
 
             if(update) {
-
-                // StaticJsonDocument<1024> json;
-                size_t maxsize = (512u + JSON_OBJECT_SIZE(25));
-                DynamicJsonDocument json(maxsize);
-
-                // Note: Deserialization can to be (char *) so the objects WILL NOT be copied
-                // this uses less memory since the data is already copied from the mqtt receive buffer and cannot
-                // get overwritten by the send buffer !!
-                DeserializationError jsonError = deserializeJson(json, (char*)payload);
-                json.shrinkToFit();
-
-                if(jsonError == DeserializationError::Ok) {
-                    // Make sure we have a valid JsonObject to start from
-                    if(JsonObject keys = json.as<JsonObject>()) {
-                        hasp_parse_json_attributes(obj, keys); // json is valid object, cast as a JsonObject
-                    } else {
-                        LOG_DEBUG(TAG_ATTR, "%s %d", __FILE__, __LINE__);
-                        jsonError = DeserializationError::InvalidInput;
+                // The tokenizer works in place, so it needs a writable copy of the payload
+                size_t len = strlen(payload);
+                char* json = (char*)hasp_malloc(len + 1);
+                if(!json) return HASP_ATTR_TYPE_JSON_INVALID;
+                memcpy(json, payload, len + 1);
+
+                hasp_jsonl_pair_t pairs[HASP_JSONL_MAX_PAIRS];
+                uint8_t count;
+                result = hasp_jsonl_parse_object(json, len, pairs, count);
+                if(result == HASP_JSONL_OK) {
+                    for(uint8_t i = 0; i < count; i++) {
+                        hasp_process_obj_attribute(obj, pairs[i].key, pairs[i].value, true);
                     }
-                } else {
-                    LOG_DEBUG(TAG_ATTR, "%s %d", __FILE__, __LINE__);
-                    jsonError = DeserializationError::IncompleteInput;
                 }
+                hasp_free(json);
             }
-            LOG_DEBUG(TAG_ATTR, "%s %d", __FILE__, __LINE__);
 
-            if(jsonError) { // Couldn't parse incoming JSON object
-                dispatch_json_error(TAG_ATTR, jsonError);
+            if(result != HASP_JSONL_OK) { // Couldn't parse incoming JSON object
+                LOG_ERROR(TAG_ATTR, F(D_JSON_FAILED " %s"), hasp_jsonl_result_name(result));
                 return HASP_ATTR_TYPE_JSON_INVALID;
             }
 
@@ -2221,6 +1838,26 @@ bool attribute_set_normalized_value(lv_obj_t* obj, hasp_update_value_t& value)
     return true;
 }
 
+// Get the current value of an object that has a val attribute
+bool attribute_get_value(lv_obj_t* obj, int32_t& val)
+{
+    return attribute_common_val(obj, val, false) != HASP_ATTR_TYPE_NOT_FOUND;
+}
+
+// Get the text of an object that can be set again with its text attribute
+bool attribute_get_text(lv_obj_t* obj, const char*& text)
+{
+    // the text of a dropdown or roller is its selected option, a template fills in the text
+    if(obj_check_type(obj, LV_HASP_DROPDOWN) || obj_check_type(obj, LV_HASP_ROLLER) || my_obj_get_template(obj))
+        return false;
+
+    char* str = NULL;
+    if(attribute_common_text(obj, ATTR_TEXT, NULL, &str, false) != HASP_ATTR_TYPE_STR || !str) return false;
+
+    text = str;
+    return true;
+}
+
 static hasp_attribute_type_t attribute_common_range(lv_obj_t* obj, int32_t& val, bool update, bool set_min,
                                                     bool set_max)
 {
@@ -2365,17 +2002,24 @@ static hasp_attribute_type_t attribute_common_int(lv_obj_t* obj, uint16_t attr_h
 {
     switch(attr_hash) {
         case ATTR_ID:
-            if(update)
+            if(update) {
+                uint8_t pageid;
+                object_index_remove(obj);
                 obj->user_data.id = (uint8_t)val;
-            else
+                if(haspPages.get_id(obj, &pageid)) object_index_add(pageid, obj);
+            } else {
                 val = obj->user_data.id;
+            }
             break; // attribute_found
 
         case ATTR_GROUPID:
-            if(update)
+            if(update) {
+                object_group_remove(obj);
                 obj->user_data.groupid = (uint8_t)val;
-            else
+                object_group_add(obj);
+            } else {
                 val = obj->user_data.groupid;
+            }
             break; // attribute_found
 
             // case ATTR_TRANSITION:
@@ -2566,27 +2210,14 @@ void attr_out(lv_obj_t* obj, const char* attribute, const char* data, bool is_js
 
     if(!attribute || !hasp_find_id_from_obj(obj, &pageid, &objid)) return;
 
-    size_t len = 10;
-    if(data) {
-        len = strlen(data); // crashes if NULL
-    }
-
-    const size_t size = 32 + strlen(attribute) + len;
-    char payload[size];
-
-    {
-        StaticJsonDocument<64> doc; // Total (recommended) size for const char*
-        if(data)
-            if(is_json)
-                doc[attribute].set(serialized(data));
-            else
-                doc[attribute].set(data);
-        else
-            doc[attribute].set(nullptr);
-        serializeJson(doc, payload, size);
-    }
+    char payload[HASP_JSON_STATE_SIZE];
+    JsonWriter json(payload, sizeof(payload));
+    if(is_json)
+        json.add_json(attribute, data);
+    else
+        json.add_str(attribute, data);
 
-    object_dispatch_state(pageid, objid, payload);
+    if(const char* out = json.end()) object_dispatch_state(pageid, objid, out);
 }
 
 void attr_out_str(lv_obj_t* obj, const char* attribute, const char* data)
@@ -2618,284 +2249,794 @@ void attr_out_color(lv_obj_t* obj, const char* attribute, lv_color_t color)
 
     if(!attribute || !hasp_find_id_from_obj(obj, &pageid, &objid)) return;
 
-    const size_t size = 64 + strlen(attribute);
-    char payload[size];
-    {
-        StaticJsonDocument<128> doc; // Total (recommended) size for const char*
-        char buffer[16];
-        lv_color32_t c32;
+    lv_color32_t c32;
+    c32.full = lv_color_to32(color);
 
-        c32.full = lv_color_to32(color);
-        snprintf_P(buffer, sizeof(buffer), PSTR("#%02x%02x%02x"), c32.ch.red, c32.ch.green, c32.ch.blue);
+    char payload[HASP_JSON_STATE_SIZE];
+    JsonWriter json(payload, sizeof(payload));
+    json.add_color(attribute, c32);
 
-        doc[attribute].set(buffer);
-        doc["r"].set(c32.ch.red);
-        doc["g"].set(c32.ch.green);
-        doc["b"].set(c32.ch.blue);
-        serializeJson(doc, payload, size);
-    }
-    object_dispatch_state(pageid, objid, payload);
+    if(const char* out = json.end()) object_dispatch_state(pageid, objid, out);
 }
 
-/**
- * Change or Retrieve the value of the attribute of an object
- * @param obj lv_obj_t*: the object to get/set the attribute
- * @param attribute char*: the attribute name (with or without leading ".")
- * @param payload char*: the new value of the attribute
- * @param update  bool: change/set the value if true, dispatch/get value if false
- * @note setting a value won't return anything, getting will dispatch the value
- */
-void hasp_process_obj_attribute(lv_obj_t* obj, const char* attribute, const char* payload, bool update)
+// ##################### Attribute Table ########################################################
+
+/* Uniform handler signature of the attribute table, the value is returned in text, val or color.
+ * Numeric and boolean attributes get their payload already parsed into val.
+ * Style attributes get the part and state that were resolved from the attribute name. */
+typedef hasp_attribute_type_t (*hasp_attr_handler_t)(lv_obj_t* obj, uint16_t attr_hash, const char* attribute,
+                                                     const char* payload, uint8_t part, uint8_t state, char** text,
+                                                     int32_t& val, lv_color_t& color, bool update);
+
+static hasp_attribute_type_t attribute_handle_int(lv_obj_t* obj, uint16_t attr_hash, const char* attribute,
+                                                  const char* payload, uint8_t part, uint8_t state, char** text,
+                                                  int32_t& val, lv_color_t& color, bool update)
 {
-    // unsigned long start = millis();
-    if(!obj) return;
+    return attribute_common_int(obj, attr_hash, val, update);
+}
 
-    lv_color_t color;
-    int32_t val;
-    char temp_buffer[128]     = "";                       // buffer to hold return strings
-    char* text                = &temp_buffer[0];          // pointer to temp_buffer
-    hasp_attribute_type_t ret = HASP_ATTR_TYPE_NOT_FOUND; // the return code determines the attribute return value type
-    uint16_t attr_hash        = Parser::get_sdbm(attribute);
+static hasp_attribute_type_t attribute_handle_bool(lv_obj_t* obj, uint16_t attr_hash, const char* attribute,
+                                                   const char* payload, uint8_t part, uint8_t state, char** text,
+                                                   int32_t& val, lv_color_t& color, bool update)
+{
+    return attribute_common_bool(obj, attr_hash, val, update);
+}
 
-    switch(attr_hash) {
-        case ATTR_GROUPID:
-        case ATTR_ID:
-        // case ATTR_TRANSITION:
-        case ATTR_OBJID:
-        case ATTR_X:
-        case ATTR_Y:
-        case ATTR_H:
-        case ATTR_W:
-        case ATTR_OPACITY:
-        case ATTR_EXT_CLICK_H:
-        case ATTR_EXT_CLICK_V:
-        case ATTR_SIZE:
-            val = strtol(payload, nullptr, DEC);
-            ret = attribute_common_int(obj, attr_hash, val, update);
-            break;
+static hasp_attribute_type_t attribute_handle_min(lv_obj_t* obj, uint16_t attr_hash, const char* attribute,
+                                                  const char* payload, uint8_t part, uint8_t state, char** text,
+                                                  int32_t& val, lv_color_t& color, bool update)
+{
+    return attribute_common_range(obj, val, update, true, false);
+}
 
-        case ATTR_VIS:
-        case ATTR_HIDDEN:
-        case ATTR_TOGGLE:
-        case ATTR_CLICK:
-        // case ATTR_SWIPE:
-        case ATTR_ENABLED:
-            val = Parser::is_true(payload);
-            ret = attribute_common_bool(obj, attr_hash, val, update);
-            break;
+static hasp_attribute_type_t attribute_handle_max(lv_obj_t* obj, uint16_t attr_hash, const char* attribute,
+                                                  const char* payload, uint8_t part, uint8_t state, char** text,
+                                                  int32_t& val, lv_color_t& color, bool update)
+{
+    return attribute_common_range(obj, val, update, false, true);
+}
 
-        case ATTR_MIN:
-            val = strtol(payload, nullptr, DEC);
-            ret = attribute_common_range(obj, val, update, true, false);
-            break;
+static hasp_attribute_type_t attribute_handle_val(lv_obj_t* obj, uint16_t attr_hash, const char* attribute,
+                                                  const char* payload, uint8_t part, uint8_t state, char** text,
+                                                  int32_t& val, lv_color_t& color, bool update)
+{
+    return attribute_common_val(obj, val, update);
+}
 
-        case ATTR_MAX:
-            val = strtol(payload, nullptr, DEC);
-            ret = attribute_common_range(obj, val, update, false, true);
-            break;
+static hasp_attribute_type_t attribute_handle_text(lv_obj_t* obj, uint16_t attr_hash, const char* attribute,
+                                                   const char* payload, uint8_t part, uint8_t state, char** text,
+                                                   int32_t& val, lv_color_t& color, bool update)
+{
+    return attribute_common_text(obj, attr_hash, payload, text, update);
+}
 
-        case ATTR_VAL:
-            val = strtol(payload, nullptr, DEC);
-            ret = attribute_common_val(obj, val, update);
-            break;
+static hasp_attribute_type_t attribute_handle_align(lv_obj_t* obj, uint16_t attr_hash, const char* attribute,
+                                                    const char* payload, uint8_t part, uint8_t state, char** text,
+                                                    int32_t& val, lv_color_t& color, bool update)
+{
+    return attribute_common_align(obj, attribute, payload, text, update);
+}
 
-        // case ATTR_TXT: // TODO: remove
-        //     LOG_WARNING(TAG_HASP, F(D_ATTRIBUTE_OBSOLETE D_ATTRIBUTE_INSTEAD), attribute, "text");
-        case ATTR_TEXT:
-        case ATTR_TEMPLATE:
-            ret = attribute_common_text(obj, attr_hash, payload, &text, update);
-            break;
+static hasp_attribute_type_t attribute_handle_tag(lv_obj_t* obj, uint16_t attr_hash, const char* attribute,
+                                                  const char* payload, uint8_t part, uint8_t state, char** text,
+                                                  int32_t& val, lv_color_t& color, bool update)
+{
+    return attribute_common_tag(obj, attr_hash, payload, text, update);
+}
 
-        case ATTR_ALIGN:
-            ret = attribute_common_align(obj, attribute, payload, &text, update);
-            break;
-        case ATTR_TAG:
-        case ATTR_ACTION:
-        case ATTR_SWIPE:
-            ret = attribute_common_tag(obj, attr_hash, payload, &text, update);
-            break;
-        case ATTR_JSONL:
-            ret = attribute_common_json(obj, attr_hash, payload, &text, update);
-            break;
+static hasp_attribute_type_t attribute_handle_json(lv_obj_t* obj, uint16_t attr_hash, const char* attribute,
+                                                   const char* payload, uint8_t part, uint8_t state, char** text,
+                                                   int32_t& val, lv_color_t& color, bool update)
+{
+    return attribute_common_json(obj, attr_hash, payload, text, update);
+}
 
-        case ATTR_OBJ:
-            text = (char*)obj_get_type_name(obj);
-            if(update && strcasecmp(payload, text) == 0)
-                ret = HASP_ATTR_TYPE_METHOD_OK; // Value is already correct
-            else if(update)
-                ret = HASP_ATTR_TYPE_STR_READONLY; // Can't change to the new value
-            else
-                ret = HASP_ATTR_TYPE_STR; // Reply the current value
-            break;
+static hasp_attribute_type_t attribute_handle_obj(lv_obj_t* obj, uint16_t attr_hash, const char* attribute,
+                                                  const char* payload, uint8_t part, uint8_t state, char** text,
+                                                  int32_t& val, lv_color_t& color, bool update)
+{
+    *text = (char*)obj_get_type_name(obj);
+    if(update && strcasecmp(payload, *text) == 0)
+        return HASP_ATTR_TYPE_METHOD_OK; // Value is already correct
+    else if(update)
+        return HASP_ATTR_TYPE_STR_READONLY; // Can't change to the new value
+    else
+        return HASP_ATTR_TYPE_STR; // Reply the current value
+}
 
-        case ATTR_MODE:
-            ret = attribute_common_mode(obj, payload, &text, val, update);
-            break;
+static hasp_attribute_type_t attribute_handle_mode(lv_obj_t* obj, uint16_t attr_hash, const char* attribute,
+                                                   const char* payload, uint8_t part, uint8_t state, char** text,
+                                                   int32_t& val, lv_color_t& color, bool update)
+{
+    return attribute_common_mode(obj, payload, text, val, update);
+}
 
-        case ATTR_OPTIONS:
-            ret = specific_options_attribute(obj, payload, &text, update);
-            break;
+static hasp_attribute_type_t attribute_handle_options(lv_obj_t* obj, uint16_t attr_hash, const char* attribute,
+                                                      const char* payload, uint8_t part, uint8_t state, char** text,
+                                                      int32_t& val, lv_color_t& color, bool update)
+{
+    return specific_options_attribute(obj, payload, text, update);
+}
 
-            // case ATTR_BTN_POS:
+static hasp_attribute_type_t attribute_handle_method(lv_obj_t* obj, uint16_t attr_hash, const char* attribute,
+                                                     const char* payload, uint8_t part, uint8_t state, char** text,
+                                                     int32_t& val, lv_color_t& color, bool update)
+{
+    return attribute_common_method(obj, attr_hash, attribute, payload);
+}
 
-            /*    case ATTR_ACTION:
-                    if(update)
-                        obj->user_data.actionid = Parser::get_action_id(payload);
-                    else
-                        val = obj->user_data.actionid;
-                    ret = HASP_ATTR_TYPE_INT;
-                    break;*/
+// Skip this key
+static hasp_attribute_type_t attribute_handle_comment(lv_obj_t* obj, uint16_t attr_hash, const char* attribute,
+                                                      const char* payload, uint8_t part, uint8_t state, char** text,
+                                                      int32_t& val, lv_color_t& color, bool update)
+{
+    return HASP_ATTR_TYPE_METHOD_OK;
+}
 
-            // case ATTR_SYMBOL:
-            //     (update) ? lv_dropdown_set_symbol(obj, payload) :
-            //     attr_out_str(obj, attr, lv_dropdown_get_symbol(obj));
-            //     return true;
+static hasp_attribute_type_t attribute_handle_specific_int(lv_obj_t* obj, uint16_t attr_hash, const char* attribute,
+                                                           const char* payload, uint8_t part, uint8_t state,
+                                                           char** text, int32_t& val, lv_color_t& color, bool update)
+{
+    return specific_int_attribute(obj, attr_hash, val, update);
+}
 
-        case ATTR_DELETE:
-        case ATTR_CLEAR:
-        case ATTR_TO_FRONT:
-        case ATTR_TO_BACK:
-        case ATTR_OPEN:
-        case ATTR_CLOSE:
-            ret = attribute_common_method(obj, attr_hash, attribute, payload);
-            break;
+static hasp_attribute_type_t attribute_handle_specific_coord(lv_obj_t* obj, uint16_t attr_hash, const char* attribute,
+                                                             const char* payload, uint8_t part, uint8_t state,
+                                                             char** text, int32_t& val, lv_color_t& color, bool update)
+{
+    return specific_coord_attribute(obj, attr_hash, val, update);
+}
 
-        case ATTR_COMMENT: // skip this key
-            ret = HASP_ATTR_TYPE_METHOD_OK;
-            break;
+static hasp_attribute_type_t attribute_handle_specific_bool(lv_obj_t* obj, uint16_t attr_hash, const char* attribute,
+                                                            const char* payload, uint8_t part, uint8_t state,
+                                                            char** text, int32_t& val, lv_color_t& color, bool update)
+{
+    return specific_bool_attribute(obj, attr_hash, val, update);
+}
 
-        case ATTR_COLS:
-        case ATTR_ROWS:
-        case ATTR_AUTO_CLOSE:
-        case ATTR_SPEED:
-        case ATTR_ANIM_TIME:
-        case ATTR_ANIM_SPEED:
-        case ATTR_ANGLE:
-        case ATTR_ROTATION:
-        case ATTR_ZOOM:
-        case ATTR_START_VALUE:
-        case ATTR_START_ANGLE:
-        case ATTR_END_ANGLE:
-        case ATTR_START_ANGLE1:
-        case ATTR_END_ANGLE1:
-        case ATTR_COUNT:
-        case ATTR_BTN_POS:
-            val = strtol(payload, nullptr, DEC);
-            ret = specific_int_attribute(obj, attr_hash, val, update);
-            break;
-
-        case ATTR_OFFSET_X:
-        case ATTR_OFFSET_Y:
-        case ATTR_PIVOT_X:
-        case ATTR_PIVOT_Y:
-        case ATTR_MAX_HEIGHT:
-            val = strtol(payload, nullptr, DEC);
-            ret = specific_coord_attribute(obj, attr_hash, val, update);
-            break;
-
-        case ATTR_ADJUSTABLE:
-        case ATTR_ONE_CHECK:
-        case ATTR_AUTO_SIZE:
-        case ATTR_SHOW_SELECTED:
-        case ATTR_Y_INVERT:
-        case ATTR_ANTIALIAS:
-        case ATTR_MODE_FIXED:
-            val = Parser::is_true(payload);
-            ret = specific_bool_attribute(obj, attr_hash, val, update);
-            break;
-
-        case ATTR_NEXT:
-        case ATTR_PREV:
-        case ATTR_BACK:
-            val = strtol(payload, nullptr, DEC);
-            ret = specific_page_attribute(obj, attr_hash, val, update);
-            break;
-        case ATTR_NAME: {
-            uint8_t pageid = 99;
-            haspPages.get_id(obj, &pageid);
-            if(update) {
-                haspPages.set_name(pageid, payload);
-                LOG_VERBOSE(TAG_HASP, F("%s %d"), haspPages.get_name(pageid), pageid);
-            } else {
-                text = haspPages.get_name(pageid);
-                LOG_VERBOSE(TAG_HASP, F("%s %d"), haspPages.get_name(pageid), pageid);
-            }
-            ret = HASP_ATTR_TYPE_STR;
-            break;
-        }
+static hasp_attribute_type_t attribute_handle_page(lv_obj_t* obj, uint16_t attr_hash, const char* attribute,
+                                                   const char* payload, uint8_t part, uint8_t state, char** text,
+                                                   int32_t& val, lv_color_t& color, bool update)
+{
+    return specific_page_attribute(obj, attr_hash, val, update);
+}
 
-        case ATTR_DIRECTION:
-            val = strtol(payload, nullptr, DEC);
-            ret = special_attribute_direction(obj, attr_hash, val, update);
-            break;
+static hasp_attribute_type_t attribute_handle_name(lv_obj_t* obj, uint16_t attr_hash, const char* attribute,
+                                                   const char* payload, uint8_t part, uint8_t state, char** text,
+                                                   int32_t& val, lv_color_t& color, bool update)
+{
+    uint8_t pageid = 99;
+    haspPages.get_id(obj, &pageid);
+    if(update) {
+        haspPages.set_name(pageid, payload);
+    } else {
+        *text = haspPages.get_name(pageid);
+    }
+    LOG_VERBOSE(TAG_HASP, F("%s %d"), haspPages.get_name(pageid), pageid);
+    return HASP_ATTR_TYPE_STR;
+}
 
-        case ATTR_SRC:
-            ret = special_attribute_src(obj, payload, &text, update);
-            break;
+static hasp_attribute_type_t attribute_handle_direction(lv_obj_t* obj, uint16_t attr_hash, const char* attribute,
+                                                        const char* payload, uint8_t part, uint8_t state, char** text,
+                                                        int32_t& val, lv_color_t& color, bool update)
+{
+    return special_attribute_direction(obj, attr_hash, val, update);
+}
 
-        default: {
-            ret = hasp_local_style_attr(obj, attribute, attr_hash, payload, update, val);
-        }
+static hasp_attribute_type_t attribute_handle_src(lv_obj_t* obj, uint16_t attr_hash, const char* attribute,
+                                                  const char* payload, uint8_t part, uint8_t state, char** text,
+                                                  int32_t& val, lv_color_t& color, bool update)
+{
+    return special_attribute_src(obj, payload, text, update);
+}
+
+/* Style attribute handlers, the table resolves the part and state from the attribute name before the call */
+#define HASP_STYLE_HANDLER(func_name, value_type)                                                                      \
+    static hasp_attribute_type_t attribute_handle_##func_name(lv_obj_t* obj, uint16_t attr_hash,                       \
+                                                              const char* attribute, const char* payload,              \
+                                                              uint8_t part, uint8_t state, char** text, int32_t& val,  \
+                                                              lv_color_t& color, bool update)                          \
+    {                                                                                                                  \
+        int16_t var = atoi(payload);                                                                                   \
+        return attribute_##func_name(obj, part, state, update, (value_type)var, val);                                  \
+    }
+
+#define HASP_STYLE_HANDLER_BOOL(func_name)                                                                             \
+    static hasp_attribute_type_t attribute_handle_##func_name(lv_obj_t* obj, uint16_t attr_hash,                       \
+                                                              const char* attribute, const char* payload,              \
+                                                              uint8_t part, uint8_t state, char** text, int32_t& val,  \
+                                                              lv_color_t& color, bool update)                          \
+    {                                                                                                                  \
+        attribute_##func_name(obj, part, state, update, Parser::is_true(payload), val);                                \
+        return HASP_ATTR_TYPE_BOOL;                                                                                    \
+    }
+
+#define HASP_STYLE_HANDLER_COLOR(func_name)                                                                            \
+    static hasp_attribute_type_t attribute_handle_##func_name(lv_obj_t* obj, uint16_t attr_hash,                       \
+                                                              const char* attribute, const char* payload,              \
+                                                              uint8_t part, uint8_t state, char** text, int32_t& val,  \
+                                                              lv_color_t& color, bool update)                          \
+    {                                                                                                                  \
+        lv_color32_t c;                                                                                                \
+        if(!update) {                                                                                                  \
+            color = lv_obj_get_style_##func_name(obj, part);                                                           \
+            return HASP_ATTR_TYPE_COLOR;                                                                               \
+        }                                                                                                              \
+        if(Parser::haspPayloadToColor(payload, c))                                                                     \
+            lv_obj_set_style_local_##func_name(obj, part, state, lv_color_make(c.ch.red, c.ch.green, c.ch.blue));      \
+        return HASP_ATTR_TYPE_METHOD_OK;                                                                               \
     }
 
-    if(ret == HASP_ATTR_TYPE_NOT_FOUND) {
-        switch(obj_get_type(obj)) { // Properties by object type
+#if LV_USE_BLEND_MODES
+HASP_STYLE_HANDLER(bg_blend_mode, lv_blend_mode_t)
+#endif
+HASP_STYLE_HANDLER(size, lv_style_int_t)
+HASP_STYLE_HANDLER(radius, lv_style_int_t)
+HASP_STYLE_HANDLER(clip_corner, bool)
+HASP_STYLE_HANDLER(opa_scale, lv_opa_t)
+HASP_STYLE_HANDLER(transform_width, lv_style_int_t)
+HASP_STYLE_HANDLER(transform_height, lv_style_int_t)
+HASP_STYLE_HANDLER(bg_main_stop, lv_style_int_t)
+HASP_STYLE_HANDLER(bg_grad_stop, lv_style_int_t)
+HASP_STYLE_HANDLER(bg_grad_dir, lv_grad_dir_t)
+HASP_STYLE_HANDLER(bg_opa, lv_opa_t)
+HASP_STYLE_HANDLER(margin_top, lv_style_int_t)
+HASP_STYLE_HANDLER(margin_bottom, lv_style_int_t)
+HASP_STYLE_HANDLER(margin_left, lv_style_int_t)
+HASP_STYLE_HANDLER(margin_right, lv_style_int_t)
+HASP_STYLE_HANDLER(pad_top, lv_style_int_t)
+HASP_STYLE_HANDLER(pad_bottom, lv_style_int_t)
+HASP_STYLE_HANDLER(pad_left, lv_style_int_t)
+HASP_STYLE_HANDLER(pad_right, lv_style_int_t)
+#if LVGL_VERSION_MAJOR == 7
+HASP_STYLE_HANDLER(pad_inner, lv_style_int_t)
+#endif
+HASP_STYLE_HANDLER(scale_end_line_width, lv_style_int_t)
+HASP_STYLE_HANDLER(scale_end_border_width, lv_style_int_t)
+HASP_STYLE_HANDLER(scale_border_width, lv_style_int_t)
+HASP_STYLE_HANDLER(scale_width, lv_style_int_t)
+HASP_STYLE_HANDLER(text_letter_space, lv_style_int_t)
+HASP_STYLE_HANDLER(text_line_space, lv_style_int_t)
+HASP_STYLE_HANDLER(text_decor, lv_text_decor_t)
+HASP_STYLE_HANDLER(text_opa, lv_opa_t)
+HASP_STYLE_HANDLER(border_width, lv_style_int_t)
+HASP_STYLE_HANDLER(border_side, lv_border_side_t)
+HASP_STYLE_HANDLER(border_opa, lv_opa_t)
+HASP_STYLE_HANDLER(outline_width, lv_style_int_t)
+HASP_STYLE_HANDLER(outline_pad, lv_style_int_t)
+HASP_STYLE_HANDLER(outline_opa, lv_opa_t)
+#if LV_USE_SHADOW
+HASP_STYLE_HANDLER(shadow_width, lv_style_int_t)
+HASP_STYLE_HANDLER(shadow_ofs_x, lv_style_int_t)
+HASP_STYLE_HANDLER(shadow_ofs_y, lv_style_int_t)
+HASP_STYLE_HANDLER(shadow_spread, lv_style_int_t)
+HASP_STYLE_HANDLER(shadow_opa, lv_opa_t)
+HASP_STYLE_HANDLER_COLOR(shadow_color)
+#endif
+HASP_STYLE_HANDLER(line_width, lv_style_int_t)
+HASP_STYLE_HANDLER(line_dash_width, lv_style_int_t)
+HASP_STYLE_HANDLER(line_dash_gap, lv_style_int_t)
+HASP_STYLE_HANDLER(line_opa, lv_opa_t)
+HASP_STYLE_HANDLER(value_letter_space, lv_style_int_t)
+HASP_STYLE_HANDLER(value_line_space, lv_style_int_t)
+HASP_STYLE_HANDLER(value_ofs_x, lv_style_int_t)
+HASP_STYLE_HANDLER(value_ofs_y, lv_style_int_t)
+HASP_STYLE_HANDLER(value_align, lv_align_t)
+HASP_STYLE_HANDLER(value_opa, lv_opa_t)
+HASP_STYLE_HANDLER(pattern_opa, lv_opa_t)
+HASP_STYLE_HANDLER(pattern_recolor_opa, lv_opa_t)
+HASP_STYLE_HANDLER(image_recolor_opa, lv_opa_t)
+HASP_STYLE_HANDLER(image_opa, lv_opa_t)
+HASP_STYLE_HANDLER_BOOL(border_post)
+HASP_STYLE_HANDLER_BOOL(line_rounded)
+HASP_STYLE_HANDLER_BOOL(pattern_repeat)
+HASP_STYLE_HANDLER_COLOR(bg_grad_color)
+HASP_STYLE_HANDLER_COLOR(scale_end_color)
+HASP_STYLE_HANDLER_COLOR(text_color)
+HASP_STYLE_HANDLER_COLOR(text_sel_color)
+HASP_STYLE_HANDLER_COLOR(border_color)
+HASP_STYLE_HANDLER_COLOR(outline_color)
+HASP_STYLE_HANDLER_COLOR(line_color)
+HASP_STYLE_HANDLER_COLOR(value_color)
+HASP_STYLE_HANDLER_COLOR(pattern_recolor)
+HASP_STYLE_HANDLER_COLOR(image_recolor)
+#undef HASP_STYLE_HANDLER
+#undef HASP_STYLE_HANDLER_BOOL
+#undef HASP_STYLE_HANDLER_COLOR
+
+static hasp_attribute_type_t attribute_handle_bg_color(lv_obj_t* obj, uint16_t attr_hash, const char* attribute,
+                                                       const char* payload, uint8_t part, uint8_t state, char** text,
+                                                       int32_t& val, lv_color_t& color, bool update)
+{
+    if(!update) {
+        color = lv_obj_get_style_bg_color(obj, part);
+        return HASP_ATTR_TYPE_COLOR;
+    }
+    lv_color32_t c;
+    if(Parser::haspPayloadToColor(payload, c) && part != 64)
+        lv_obj_set_style_local_bg_color(obj, part, state, lv_color_make(c.ch.red, c.ch.green, c.ch.blue));
+    return HASP_ATTR_TYPE_METHOD_OK;
+}
 
-            case LV_HASP_ARC:
-                val = strtol(payload, nullptr, DEC);
-                ret = hasp_process_arc_attribute(obj, attr_hash, val, update);
-                break;
+static hasp_attribute_type_t attribute_handle_scale_grad_color(lv_obj_t* obj, uint16_t attr_hash, const char* attribute,
+                                                               const char* payload, uint8_t part, uint8_t state,
+                                                               char** text, int32_t& val, lv_color_t& color,
+                                                               bool update)
+{
+    if(!update) {
+        color = lv_obj_get_style_scale_grad_color(obj, part);
+        return HASP_ATTR_TYPE_COLOR;
+    }
+    lv_color32_t c;
+    if(Parser::haspPayloadToColor(payload, c) && part != 64)
+        lv_obj_set_style_local_scale_grad_color(obj, part, state, lv_color_make(c.ch.red, c.ch.green, c.ch.blue));
+    return HASP_ATTR_TYPE_METHOD_OK;
+}
 
-            case LV_HASP_SLIDER:
-                val = strtol(payload, nullptr, DEC);
-                ret = hasp_process_slider_attribute(obj, attr_hash, val, update);
-                break;
+static hasp_attribute_type_t attribute_handle_text_font(lv_obj_t* obj, uint16_t attr_hash, const char* attribute,
+                                                        const char* payload, uint8_t part, uint8_t state, char** text,
+                                                        int32_t& val, lv_color_t& color, bool update)
+{
+    lv_font_t* font = haspPayloadToFont(payload);
+    if(font) {
+        LOG_DEBUG(TAG_ATTR, "%s %d %x", __FILE__, __LINE__, font);
+        uint8_t count = 3;
+        if(obj_check_type(obj, LV_HASP_ROLLER)) count = my_roller_get_visible_row_count(obj);
+        lv_obj_set_style_local_text_font(obj, part, state, font);
+        if(obj_check_type(obj, LV_HASP_ROLLER)) lv_roller_set_visible_row_count(obj, count);
+        lv_obj_set_style_local_text_font(obj, part, state, font); // again, for roller
+
+        if(obj_check_type(obj, LV_HASP_DROPDOWN)) { // issue #43
+            lv_obj_set_style_local_text_font(obj, LV_DROPDOWN_PART_MAIN, state, font);
+            lv_obj_set_style_local_text_font(obj, LV_DROPDOWN_PART_LIST, state, font);
+            lv_obj_set_style_local_text_font(obj, LV_DROPDOWN_PART_SELECTED, state, font);
+        };
+        my_obj_set_font(obj, part, state, LV_STYLE_TEXT_FONT, font);
 
-            case LV_HASP_SPINNER:
-                val = strtol(payload, nullptr, DEC);
-                ret = hasp_process_spinner_attribute(obj, attr_hash, val, update);
-                break;
+    } else {
+        LOG_WARNING(TAG_ATTR, F("Unknown Font ID %s"), payload);
+    }
+    return HASP_ATTR_TYPE_METHOD_OK;
+}
 
-            case LV_HASP_GAUGE:
-                val = strtol(payload, nullptr, DEC);
-                ret = hasp_process_gauge_attribute(obj, attr_hash, val, update);
-                break;
+static hasp_attribute_type_t attribute_handle_value_font(lv_obj_t* obj, uint16_t attr_hash, const char* attribute,
+                                                         const char* payload, uint8_t part, uint8_t state, char** text,
+                                                         int32_t& val, lv_color_t& color, bool update)
+{
+    lv_font_t* font = haspPayloadToFont(payload);
+    if(font) {
+        lv_obj_set_style_local_value_font(obj, part, state, font);
+        my_obj_set_font(obj, part, state, LV_STYLE_VALUE_FONT, font);
+    } else {
+        LOG_WARNING(TAG_ATTR, F("Unknown Font ID %s"), attribute);
+    }
+    return HASP_ATTR_TYPE_METHOD_OK;
+}
 
-            case LV_HASP_LINEMETER:
-                val = strtol(payload, nullptr, DEC);
-                ret = hasp_process_lmeter_attribute(obj, attr_hash, val, update);
-                break;
+static hasp_attribute_type_t attribute_handle_value_str(lv_obj_t* obj, uint16_t attr_hash, const char* attribute,
+                                                        const char* payload, uint8_t part, uint8_t state, char** text,
+                                                        int32_t& val, lv_color_t& color, bool update)
+{
+    if(update) {
+        my_obj_set_value_str_text(obj, part, state, payload);
+    } else {
+        attr_out_str(obj, attribute, my_obj_get_value_str_text(obj, part, state));
+    }
+    return HASP_ATTR_TYPE_METHOD_OK;
+}
 
-            case LV_HASP_LINE:
-                if(attr_hash == ATTR_POINTS)
-                    ret = my_line_set_points(obj, payload) ? HASP_ATTR_TYPE_METHOD_OK : HASP_ATTR_TYPE_RANGE_ERROR;
-                break;
+// Known attribute without a setter in this build
+static hasp_attribute_type_t attribute_handle_none(lv_obj_t* obj, uint16_t attr_hash, const char* attribute,
+                                                   const char* payload, uint8_t part, uint8_t state, char** text,
+                                                   int32_t& val, lv_color_t& color, bool update)
+{
+    return HASP_ATTR_TYPE_NOT_FOUND;
+}
 
-            case LV_HASP_CPICKER:
-                if(attr_hash == ATTR_COLOR) {
-                    if(update) {
-                        lv_color32_t c;
-                        if(Parser::haspPayloadToColor(payload, c))
-                            lv_cpicker_set_color(obj, lv_color_make(c.ch.red, c.ch.green, c.ch.blue));
-                    } else {
-                        color = lv_cpicker_get_color(obj);
-                    }
-                    ret = HASP_ATTR_TYPE_COLOR;
-                }
-                break;
+#if !LV_USE_BLEND_MODES
+#define attribute_handle_bg_blend_mode attribute_handle_none
+#endif
+#if LVGL_VERSION_MAJOR != 7
+#define attribute_handle_pad_inner attribute_handle_none
+#endif
+#if !LV_USE_SHADOW
+#define attribute_handle_shadow_width attribute_handle_none
+#define attribute_handle_shadow_ofs_x attribute_handle_none
+#define attribute_handle_shadow_ofs_y attribute_handle_none
+#define attribute_handle_shadow_spread attribute_handle_none
+#define attribute_handle_shadow_opa attribute_handle_none
+#define attribute_handle_shadow_color attribute_handle_none
+#endif
 
-            default:
-                break; // not found
+/* Attributes of a specific object type, the payload of these names is parsed here */
+static hasp_attribute_type_t attribute_handle_type(lv_obj_t* obj, uint16_t attr_hash, const char* attribute,
+                                                   const char* payload, uint8_t part, uint8_t state, char** text,
+                                                   int32_t& val, lv_color_t& color, bool update)
+{
+    val = strtol(payload, nullptr, DEC);
+    switch(obj_get_type(obj)) {
+        case LV_HASP_ARC:
+            return hasp_process_arc_attribute(obj, attr_hash, val, update);
+        case LV_HASP_SLIDER:
+            return hasp_process_slider_attribute(obj, attr_hash, val, update);
+        case LV_HASP_SPINNER:
+            return hasp_process_spinner_attribute(obj, attr_hash, val, update);
+        case LV_HASP_LINEMETER:
+            return hasp_process_lmeter_attribute(obj, attr_hash, val, update);
+        default:
+            return HASP_ATTR_TYPE_NOT_FOUND;
+    }
+}
+
+// Gauge and linemeter scale
+static hasp_attribute_type_t attribute_handle_scale(lv_obj_t* obj, uint16_t attr_hash, const char* attribute,
+                                                    const char* payload, uint8_t part, uint8_t state, char** text,
+                                                    int32_t& val, lv_color_t& color, bool update)
+{
+    val = strtol(payload, nullptr, DEC);
+    switch(obj_get_type(obj)) {
+        case LV_HASP_GAUGE:
+            return hasp_process_gauge_attribute(obj, attr_hash, val, update);
+        case LV_HASP_LINEMETER:
+            return hasp_process_lmeter_attribute(obj, attr_hash, val, update);
+        default:
+            return HASP_ATTR_TYPE_NOT_FOUND;
+    }
+}
+
+static hasp_attribute_type_t attribute_handle_angle(lv_obj_t* obj, uint16_t attr_hash, const char* attribute,
+                                                    const char* payload, uint8_t part, uint8_t state, char** text,
+                                                    int32_t& val, lv_color_t& color, bool update)
+{
+    switch(obj_get_type(obj)) {
+        case LV_HASP_GAUGE:
+            return hasp_process_gauge_attribute(obj, attr_hash, val, update);
+        case LV_HASP_LINEMETER:
+            return hasp_process_lmeter_attribute(obj, attr_hash, val, update);
+        default:
+            return specific_int_attribute(obj, attr_hash, val, update);
+    }
+}
+
+static hasp_attribute_type_t attribute_handle_points(lv_obj_t* obj, uint16_t attr_hash, const char* attribute,
+                                                     const char* payload, uint8_t part, uint8_t state, char** text,
+                                                     int32_t& val, lv_color_t& color, bool update)
+{
+    if(!obj_check_type(obj, LV_HASP_LINE)) return HASP_ATTR_TYPE_NOT_FOUND;
+    return my_line_set_points(obj, payload) ? HASP_ATTR_TYPE_METHOD_OK : HASP_ATTR_TYPE_RANGE_ERROR;
+}
+
+static hasp_attribute_type_t attribute_handle_color(lv_obj_t* obj, uint16_t attr_hash, const char* attribute,
+                                                    const char* payload, uint8_t part, uint8_t state, char** text,
+                                                    int32_t& val, lv_color_t& color, bool update)
+{
+    if(!obj_check_type(obj, LV_HASP_CPICKER)) return HASP_ATTR_TYPE_NOT_FOUND;
+    if(update) {
+        lv_color32_t c;
+        if(Parser::haspPayloadToColor(payload, c))
+            lv_cpicker_set_color(obj, lv_color_make(c.ch.red, c.ch.green, c.ch.blue));
+    } else {
+        color = lv_cpicker_get_color(obj);
+    }
+    return HASP_ATTR_TYPE_COLOR;
+}
+
+/* Attribute lookup table, sorted by hash. Each entry carries the handler of the attribute */
+struct hasp_attr_entry_t
+{
+    uint16_t hash;
+    const char* name;
+    hasp_attr_handler_t handler;
+    uint8_t payload; // HASP_ATTR_PAYLOAD_...
+    bool style;      // the name can have a part/state suffix
+};
+
+#define HASP_ATTR_TEXT(x, handler) {ATTR_##x, #x, handler, HASP_ATTR_PAYLOAD_TEXT, false}
+#define HASP_ATTR_INT(x, handler) {ATTR_##x, #x, handler, HASP_ATTR_PAYLOAD_INT, false}
+#define HASP_ATTR_BOOL(x, handler) {ATTR_##x, #x, handler, HASP_ATTR_PAYLOAD_BOOL, false}
+#define HASP_ATTR_STYLE(x, handler) {ATTR_##x, #x, handler, HASP_ATTR_PAYLOAD_TEXT, true}
+static constexpr hasp_attr_entry_t hasp_attr_table[] = {
+    HASP_ATTR_INT(H, attribute_handle_int),
+    HASP_ATTR_INT(W, attribute_handle_int),
+    HASP_ATTR_INT(X, attribute_handle_int),
+    HASP_ATTR_INT(Y, attribute_handle_int),
+    HASP_ATTR_INT(ANIM_SPEED, attribute_handle_specific_int),
+    HASP_ATTR_TEXT(CLEAR, attribute_handle_method),
+    HASP_ATTR_STYLE(VALUE_STR, attribute_handle_value_str),
+    HASP_ATTR_TEXT(TYPE, attribute_handle_type),
+    HASP_ATTR_STYLE(TEXT_DECOR, attribute_handle_text_decor),
+    HASP_ATTR_STYLE(BORDER_OPA, attribute_handle_border_opa),
+    HASP_ATTR_STYLE(MARGIN_RIGHT, attribute_handle_margin_right),
+    HASP_ATTR_INT(ANGLE, attribute_handle_angle),
+    HASP_ATTR_STYLE(SCALE_BORDER_WIDTH, attribute_handle_scale_border_width),
+    HASP_ATTR_STYLE(PAD_BOTTOM, attribute_handle_pad_bottom),
+    HASP_ATTR_STYLE(BG_GRAD_STOP, attribute_handle_bg_grad_stop),
+    HASP_ATTR_TEXT(VALUE_BLEND_MODE, attribute_handle_none),
+    HASP_ATTR_TEXT(SRC, attribute_handle_src),
+    HASP_ATTR_STYLE(OUTLINE_COLOR, attribute_handle_outline_color),
+    HASP_ATTR_INT(ID, attribute_handle_int),
+    HASP_ATTR_TEXT(MODAL, attribute_handle_none),
+    HASP_ATTR_STYLE(PATTERN_RECOLOR, attribute_handle_pattern_recolor),
+    HASP_ATTR_STYLE(MARGIN_TOP, attribute_handle_margin_top),
+    HASP_ATTR_TEXT(TAG, attribute_handle_tag),
+    HASP_ATTR_INT(AUTO_CLOSE, attribute_handle_specific_int),
+    HASP_ATTR_TEXT(POINTS, attribute_handle_points),
+    HASP_ATTR_STYLE(CLIP_CORNER, attribute_handle_clip_corner),
+    HASP_ATTR_STYLE(VALUE_FONT, attribute_handle_value_font),
+    HASP_ATTR_STYLE(OUTLINE_WIDTH, attribute_handle_outline_width),
+    HASP_ATTR_STYLE(PAD_INNER, attribute_handle_pad_inner),
+    HASP_ATTR_STYLE(SHADOW_COLOR, attribute_handle_shadow_color),
+    HASP_ATTR_INT(OPACITY, attribute_handle_int),
+    HASP_ATTR_TEXT(TRANSITION, attribute_handle_none),
+    HASP_ATTR_BOOL(HIDDEN, attribute_handle_bool),
+    HASP_ATTR_TEXT(IMAGE_BLEND_MODE, attribute_handle_none),
+    HASP_ATTR_TEXT(SWIPE, attribute_handle_tag),
+    HASP_ATTR_INT(START_VALUE, attribute_handle_specific_int),
+    HASP_ATTR_STYLE(SHADOW_WIDTH, attribute_handle_shadow_width),
+    HASP_ATTR_INT(SPEED, attribute_handle_specific_int),
+    HASP_ATTR_STYLE(LINE_ROUNDED, attribute_handle_line_rounded),
+    HASP_ATTR_INT(VAL, attribute_handle_val),
+    HASP_ATTR_BOOL(VIS, attribute_handle_bool),
+    HASP_ATTR_INT(SIZE, attribute_handle_int),
+    HASP_ATTR_BOOL(CLICK, attribute_handle_bool),
+    HASP_ATTR_BOOL(ADJUSTABLE, attribute_handle_specific_bool),
+    HASP_ATTR_TEXT(LABEL_COUNT, attribute_handle_scale),
+    HASP_ATTR_INT(ZOOM, attribute_handle_specific_int),
+    HASP_ATTR_STYLE(RADIUS, attribute_handle_radius),
+    HASP_ATTR_STYLE(SHADOW_SPREAD, attribute_handle_shadow_spread),
+    HASP_ATTR_STYLE(BORDER_COLOR, attribute_handle_border_color),
+    HASP_ATTR_STYLE(VALUE_OFS_X, attribute_handle_value_ofs_x),
+    HASP_ATTR_STYLE(VALUE_OFS_Y, attribute_handle_value_ofs_y),
+    HASP_ATTR_INT(PREV, attribute_handle_page),
+    HASP_ATTR_STYLE(LINE_COLOR, attribute_handle_line_color),
+    HASP_ATTR_STYLE(TEXT_FONT, attribute_handle_text_font),
+    HASP_ATTR_STYLE(OUTLINE_OPA, attribute_handle_outline_opa),
+    HASP_ATTR_STYLE(TEXT_COLOR, attribute_handle_text_color),
+    HASP_ATTR_TEXT(BORDER_BLEND_MODE, attribute_handle_none),
+    HASP_ATTR_TEXT(THICKNESS, attribute_handle_none),
+    HASP_ATTR_STYLE(MARGIN_LEFT, attribute_handle_margin_left),
+    HASP_ATTR_STYLE(LINE_OPA, attribute_handle_line_opa),
+    HASP_ATTR_STYLE(BORDER_WIDTH, attribute_handle_border_width),
+    HASP_ATTR_TEXT(TO_BACK, attribute_handle_method),
+    HASP_ATTR_TEXT(OUTLINE_BLEND_MODE, attribute_handle_none),
+    HASP_ATTR_STYLE(LINE_WIDTH, attribute_handle_line_width),
+    HASP_ATTR_TEXT(OPEN, attribute_handle_method),
+    HASP_ATTR_STYLE(OUTLINE_PAD, attribute_handle_outline_pad),
+    HASP_ATTR_TEXT(TRANSITION_TIME, attribute_handle_none),
+    HASP_ATTR_STYLE(VALUE_LINE_SPACE, attribute_handle_value_line_space),
+    HASP_ATTR_STYLE(VALUE_ALIGN, attribute_handle_value_align),
+    HASP_ATTR_BOOL(ENABLED, attribute_handle_bool),
+    HASP_ATTR_INT(COUNT, attribute_handle_specific_int),
+    HASP_ATTR_TEXT(OPTIONS, attribute_handle_options),
+    HASP_ATTR_STYLE(SCALE_END_LINE_WIDTH, attribute_handle_scale_end_line_width),
+    HASP_ATTR_INT(MAX_HEIGHT, attribute_handle_specific_coord),
+    HASP_ATTR_STYLE(BG_BLEND_MODE, attribute_handle_bg_blend_mode),
+    HASP_ATTR_STYLE(PATTERN_REPEAT, attribute_handle_pattern_repeat),
+    HASP_ATTR_STYLE(TEXT_SEL_COLOR, attribute_handle_text_sel_color),
+    HASP_ATTR_TEXT(TEXT_BLEND_MODE, attribute_handle_none),
+    HASP_ATTR_INT(DIRECTION, attribute_handle_direction),
+    HASP_ATTR_STYLE(LINE_DASH_WIDTH, attribute_handle_line_dash_width),
+    HASP_ATTR_TEXT(SYMBOL, attribute_handle_none),
+    HASP_ATTR_INT(END_ANGLE1, attribute_handle_specific_int),
+    HASP_ATTR_TEXT(ALIGN, attribute_handle_align),
+    HASP_ATTR_STYLE(SCALE_END_BORDER_WIDTH, attribute_handle_scale_end_border_width),
+    HASP_ATTR_STYLE(PATTERN_RECOLOR_OPA, attribute_handle_pattern_recolor_opa),
+    HASP_ATTR_INT(BTN_POS, attribute_handle_specific_int),
+    HASP_ATTR_BOOL(MODE_FIXED, attribute_handle_specific_bool),
+    HASP_ATTR_STYLE(SCALE_WIDTH, attribute_handle_scale_width),
+    HASP_ATTR_INT(COLS, attribute_handle_specific_int),
+    HASP_ATTR_STYLE(TEXT_OPA, attribute_handle_text_opa),
+    HASP_ATTR_STYLE(MARGIN_BOTTOM, attribute_handle_margin_bottom),
+    HASP_ATTR_STYLE(SHADOW_OPA, attribute_handle_shadow_opa),
+    HASP_ATTR_BOOL(TOGGLE, attribute_handle_bool),
+    HASP_ATTR_TEXT(FORMAT, attribute_handle_scale),
+    HASP_ATTR_INT(START_ANGLE1, attribute_handle_specific_int),
+    HASP_ATTR_TEXT(CRITICAL_VALUE, attribute_handle_scale),
+    HASP_ATTR_INT(OBJID, attribute_handle_int),
+    HASP_ATTR_INT(END_ANGLE, attribute_handle_specific_int),
+    HASP_ATTR_STYLE(BG_GRAD_DIR, attribute_handle_bg_grad_dir),
+    HASP_ATTR_TEXT(CLOSE, attribute_handle_method),
+    HASP_ATTR_TEXT(ACTION, attribute_handle_tag),
+    HASP_ATTR_INT(PIVOT_X, attribute_handle_specific_coord),
+    HASP_ATTR_INT(PIVOT_Y, attribute_handle_specific_coord),
+    HASP_ATTR_STYLE(PAD_LEFT, attribute_handle_pad_left),
+    HASP_ATTR_TEXT(TEMPLATE, attribute_handle_text),
+    HASP_ATTR_TEXT(TRANSITION_PATH, attribute_handle_none),
+    HASP_ATTR_TEXT(PATTERN_BLEND_MODE, attribute_handle_none),
+    HASP_ATTR_STYLE(PATTERN_OPA, attribute_handle_pattern_opa),
+    HASP_ATTR_STYLE(IMAGE_RECOLOR_OPA, attribute_handle_image_recolor_opa),
+    HASP_ATTR_STYLE(SCALE_END_COLOR, attribute_handle_scale_end_color),
+    HASP_ATTR_STYLE(BG_GRAD_COLOR, attribute_handle_bg_grad_color),
+    HASP_ATTR_BOOL(Y_INVERT, attribute_handle_specific_bool),
+    HASP_ATTR_STYLE(SHADOW_OFS_X, attribute_handle_shadow_ofs_x),
+    HASP_ATTR_STYLE(SHADOW_OFS_Y, attribute_handle_shadow_ofs_y),
+    HASP_ATTR_INT(START_ANGLE, attribute_handle_specific_int),
+    HASP_ATTR_TEXT(NAME, attribute_handle_name),
+    HASP_ATTR_TEXT(TO_FRONT, attribute_handle_method),
+    HASP_ATTR_INT(ROTATION, attribute_handle_specific_int),
+    HASP_ATTR_INT(MAX, attribute_handle_max),
+    HASP_ATTR_TEXT(MODE, attribute_handle_mode),
+    HASP_ATTR_BOOL(ONE_CHECK, attribute_handle_specific_bool),
+    HASP_ATTR_INT(MIN, attribute_handle_min),
+    HASP_ATTR_INT(EXT_CLICK_H, attribute_handle_int),
+    HASP_ATTR_INT(EXT_CLICK_V, attribute_handle_int),
+    HASP_ATTR_STYLE(SCALE_GRAD_COLOR, attribute_handle_scale_grad_color),
+    HASP_ATTR_STYLE(TRANSFORM_WIDTH, attribute_handle_transform_width),
+    HASP_ATTR_STYLE(BG_OPA, attribute_handle_bg_opa),
+    HASP_ATTR_INT(GROUPID, attribute_handle_int),
+    HASP_ATTR_STYLE(LINE_DASH_GAP, attribute_handle_line_dash_gap),
+    HASP_ATTR_TEXT(TRANSITION_PROP_1, attribute_handle_none),
+    HASP_ATTR_TEXT(TRANSITION_PROP_2, attribute_handle_none),
+    HASP_ATTR_TEXT(TRANSITION_PROP_3, attribute_handle_none),
+    HASP_ATTR_TEXT(TRANSITION_PROP_4, attribute_handle_none),
+    HASP_ATTR_TEXT(TRANSITION_PROP_5, attribute_handle_none),
+    HASP_ATTR_TEXT(TRANSITION_PROP_6, attribute_handle_none),
+    HASP_ATTR_STYLE(BORDER_POST, attribute_handle_border_post),
+    HASP_ATTR_TEXT(DELETE, attribute_handle_method),
+    HASP_ATTR_STYLE(VALUE_OPA, attribute_handle_value_opa),
+    HASP_ATTR_STYLE(VALUE_LETTER_SPACE, attribute_handle_value_letter_space),
+    HASP_ATTR_INT(ROWS, attribute_handle_specific_int),
+    HASP_ATTR_STYLE(IMAGE_RECOLOR, attribute_handle_image_recolor),
+    HASP_ATTR_STYLE(VALUE_COLOR, attribute_handle_value_color),
+    HASP_ATTR_TEXT(OBJ, attribute_handle_obj),
+    HASP_ATTR_TEXT(TEXT, attribute_handle_text),
+    HASP_ATTR_STYLE(BORDER_SIDE, attribute_handle_border_side),
+    HASP_ATTR_STYLE(TEXT_LINE_SPACE, attribute_handle_text_line_space),
+    HASP_ATTR_BOOL(ANTIALIAS, attribute_handle_specific_bool),
+    HASP_ATTR_STYLE(TRANSFORM_HEIGHT, attribute_handle_transform_height),
+    HASP_ATTR_BOOL(SHOW_SELECTED, attribute_handle_specific_bool),
+    HASP_ATTR_INT(BACK, attribute_handle_page),
+    HASP_ATTR_TEXT(LINE_COUNT, attribute_handle_scale),
+    HASP_ATTR_STYLE(IMAGE_OPA, attribute_handle_image_opa),
+    HASP_ATTR_TEXT(COLOR, attribute_handle_color),
+    HASP_ATTR_STYLE(PAD_TOP, attribute_handle_pad_top),
+    HASP_ATTR_INT(ANIM_TIME, attribute_handle_specific_int),
+    HASP_ATTR_TEXT(LINE_BLEND_MODE, attribute_handle_none),
+    HASP_ATTR_INT(NEXT, attribute_handle_page),
+    HASP_ATTR_TEXT(PATTERN_IMAGE, attribute_handle_none),
+    HASP_ATTR_TEXT(JSONL, attribute_handle_json),
+    HASP_ATTR_STYLE(TEXT_LETTER_SPACE, attribute_handle_text_letter_space),
+    HASP_ATTR_TEXT(COMMENT, attribute_handle_comment),
+    HASP_ATTR_STYLE(BG_MAIN_STOP, attribute_handle_bg_main_stop),
+    HASP_ATTR_BOOL(AUTO_SIZE, attribute_handle_specific_bool),
+    HASP_ATTR_TEXT(SHADOW_BLEND_MODE, attribute_handle_none),
+    HASP_ATTR_TEXT(TRANSITION_DELAY, attribute_handle_none),
+    HASP_ATTR_STYLE(OPA_SCALE, attribute_handle_opa_scale),
+    HASP_ATTR_STYLE(BG_COLOR, attribute_handle_bg_color),
+    HASP_ATTR_STYLE(PAD_RIGHT, attribute_handle_pad_right),
+    HASP_ATTR_INT(OFFSET_X, attribute_handle_specific_coord),
+    HASP_ATTR_INT(OFFSET_Y, attribute_handle_specific_coord),
+};
+#undef HASP_ATTR_TEXT
+#undef HASP_ATTR_INT
+#undef HASP_ATTR_BOOL
+#undef HASP_ATTR_STYLE
+
+static constexpr size_t HASP_ATTR_TABLE_COUNT = sizeof(hasp_attr_table) / sizeof(hasp_attr_table[0]);
+
+static constexpr bool hasp_attr_table_hashed(size_t i = 0)
+{
+    return i >= HASP_ATTR_TABLE_COUNT ||
+           (Parser::get_sdbm_const(hasp_attr_table[i].name, true) == hasp_attr_table[i].hash &&
+            hasp_attr_table_hashed(i + 1));
+}
+
+static constexpr bool hasp_attr_table_sorted(size_t i = 1)
+{
+    return i >= HASP_ATTR_TABLE_COUNT ||
+           (hasp_attr_table[i - 1].hash < hasp_attr_table[i].hash && hasp_attr_table_sorted(i + 1));
+}
+
+static_assert(hasp_attr_table_hashed(), "ATTR_ constant does not match the hash of its name");
+static_assert(hasp_attr_table_sorted(), "ATTR_ hash collision or attribute table not sorted by hash");
+
+/* Changes when an attribute is added, removed or parsed differently */
+static constexpr uint32_t hasp_attr_table_fnv(size_t i = 0, uint32_t hash = 2166136261u)
+{
+    return i >= HASP_ATTR_TABLE_COUNT
+               ? hash
+               : hasp_attr_table_fnv(
+                     i + 1, (hash ^ ((uint32_t)hasp_attr_table[i].hash << 2 | hasp_attr_table[i].payload)) * 16777619u);
+}
+
+// Find the table entry of a hash, or NULL
+static const hasp_attr_entry_t* hasp_attribute_find_hash(uint16_t hash)
+{
+    size_t first = 0;
+    size_t last  = HASP_ATTR_TABLE_COUNT;
+
+    while(first < last) {
+        size_t mid = (first + last) / 2;
+        if(hasp_attr_table[mid].hash < hash)
+            first = mid + 1;
+        else
+            last = mid;
+    }
+
+    if(first < HASP_ATTR_TABLE_COUNT && hasp_attr_table[first].hash == hash) return &hasp_attr_table[first];
+    return NULL;
+}
+
+// Find the table entry of an attribute name, the name itself is verified so an unknown name can't alias a known one
+static const hasp_attr_entry_t* hasp_attribute_find(const char* attr)
+{
+    const hasp_attr_entry_t* entry = hasp_attribute_find_hash(Parser::get_sdbm(attr, true));
+    if(entry && !strcasecmp(entry->name, attr)) return entry;
+    return NULL;
+}
+
+/**
+ * Get the hash of a known attribute name
+ * @param attr char*: the attribute name
+ * @return uint16_t: the ATTR_ hash of the attribute, or 0 if the name is unknown or has a part/state suffix
+ * @note the name itself is verified, so an unknown attribute can never alias a known one
+ */
+uint16_t hasp_attribute_get_hash(const char* attr)
+{
+    const hasp_attr_entry_t* entry = hasp_attribute_find(attr);
+    return entry ? entry->hash : 0;
+}
+
+// How the payload of a known attribute is parsed, HASP_ATTR_PAYLOAD_TEXT if the hash is unknown
+uint8_t hasp_attribute_get_payload(uint16_t attr_hash)
+{
+    const hasp_attr_entry_t* entry = attr_hash ? hasp_attribute_find_hash(attr_hash) : NULL;
+    return entry ? entry->payload : HASP_ATTR_PAYLOAD_TEXT;
+}
+
+// Identifies the attribute table of this firmware, for data that stores attribute hashes or parsed payloads
+uint32_t hasp_attribute_table_hash()
+{
+    return hasp_attr_table_fnv();
+}
+
+/**
+ * Change or Retrieve the value of the attribute of an object through the handler of its table entry
+ * @param obj lv_obj_t*: the object to get/set the attribute
+ * @param attribute char*: the attribute name (with or without leading ".")
+ * @param entry the table entry of the attribute, NULL if the name is unknown or has a part/state suffix
+ * @param payload char*: the new value of the attribute, NULL if it is already parsed into val
+ * @param val int32_t: the parsed value of a numeric or boolean attribute when payload is NULL
+ * @param update  bool: change/set the value if true, dispatch/get value if false
+ */
+static void hasp_process_obj_attribute_entry(lv_obj_t* obj, const char* attribute, const hasp_attr_entry_t* entry,
+                                             const char* payload, int32_t val, bool update)
+{
+    lv_color_t color;
+    char temp_buffer[128] = "";              // buffer to hold return strings
+    char* text            = &temp_buffer[0]; // pointer to temp_buffer
+    uint8_t part          = LV_OBJ_PART_MAIN;
+    uint8_t state         = LV_STATE_DEFAULT;
+    hasp_attribute_type_t ret;
+
+    if(!entry || entry->style) {
+        char name[32];
+        hasp_attribute_get_part_state(obj, attribute, name, part, state);
+        if(!entry) { // a style attribute with a part/state suffix
+            entry = hasp_attribute_find(name);
+            if(entry && !entry->style) entry = NULL;
         }
     }
 
+    if(entry) {
+        if(payload) {
+            if(entry->payload == HASP_ATTR_PAYLOAD_INT)
+                val = strtol(payload, nullptr, DEC);
+            else if(entry->payload == HASP_ATTR_PAYLOAD_BOOL)
+                val = Parser::is_true(payload);
+        }
+        ret = entry->handler(obj, entry->hash, attribute, payload, part, state, &text, val, color, update);
+    } else {
+        ret = HASP_ATTR_TYPE_NOT_FOUND;
+    }
+
     // Positive return codes have returned a value, negative are warnings
     if(update && ret > 0) return; // done
 
     // Output the returned value or warning
     switch(ret) {
         case HASP_ATTR_TYPE_NOT_FOUND:
-            LOG_WARNING(TAG_ATTR, F(D_ATTRIBUTE_UNKNOWN " (%d)"), attribute, attr_hash);
+            LOG_WARNING(TAG_ATTR, F(D_ATTRIBUTE_UNKNOWN " (%d)"), attribute, Parser::get_sdbm(attribute, true));
             break;
 
         case HASP_ATTR_TYPE_INT_READONLY:
@@ -2949,3 +3090,47 @@ void hasp_process_obj_attribute(lv_obj_t* obj, const char* attribute, const char
             LOG_ERROR(TAG_ATTR, F(D_ERROR_UNKNOWN " (%d)"), ret);
     }
 }
+
+/**
+ * Change or Retrieve the value of the attribute of an object
+ * @param obj lv_obj_t*: the object to get/set the attribute
+ * @param attribute char*: the attribute name (with or without leading ".")
+ * @param payload char*: the new value of the attribute
+ * @param update  bool: change/set the value if true, dispatch/get value if false
+ * @note setting a value won't return anything, getting will dispatch the value
+ */
+void hasp_process_obj_attribute(lv_obj_t* obj, const char* attribute, const char* payload, bool update)
+{
+    if(!obj) return;
+    hasp_process_obj_attribute_entry(obj, attribute, hasp_attribute_find(attribute), payload, 0, update);
+}
+
+/**
+ * Change or Retrieve the value of the attribute of an object using a previously resolved hash
+ * @param obj lv_obj_t*: the object to get/set the attribute
+ * @param attribute char*: the attribute name (with or without leading ".")
+ * @param attr_hash uint16_t: the hash returned by hasp_attribute_get_hash for this attribute name
+ * @param payload char*: the new value of the attribute
+ * @param update  bool: change/set the value if true, dispatch/get value if false
+ */
+void hasp_process_obj_attribute_hash(lv_obj_t* obj, const char* attribute, uint16_t attr_hash, const char* payload,
+                                     bool update)
+{
+    if(!obj) return;
+    hasp_process_obj_attribute_entry(obj, attribute, attr_hash ? hasp_attribute_find_hash(attr_hash) : NULL, payload, 0,
+                                     update);
+}
+
+/**
+ * Change a numeric or boolean attribute of an object to a value that is already parsed
+ * @param obj lv_obj_t*: the object to set the attribute
+ * @param attribute char*: the attribute name, used in the log messages
+ * @param attr_hash uint16_t: the hash of an attribute with a HASP_ATTR_PAYLOAD_INT or _BOOL payload
+ * @param val int32_t: the new value of the attribute
+ */
+void hasp_process_obj_attribute_int(lv_obj_t* obj, const char* attribute, uint16_t attr_hash, int32_t val)
+{
+    const hasp_attr_entry_t* entry = attr_hash ? hasp_attribute_find_hash(attr_hash) : NULL;
+    if(!obj || !entry || entry->payload == HASP_ATTR_PAYLOAD_TEXT) return;
+    hasp_process_obj_attribute_entry(obj, attribute, entry, NULL, val, true);
+}
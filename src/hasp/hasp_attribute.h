@@ -21,15 +21,24 @@ void my_obj_set_swipe(lv_obj_t* obj, const char* tag);
 const char* my_obj_get_tag(lv_obj_t* obj);
 const char* my_obj_get_action(lv_obj_t* obj);
 const char* my_obj_get_swipe(lv_obj_t* obj);
+void my_obj_set_font(lv_obj_t* obj, uint8_t part, lv_state_t state, lv_style_property_t prop, lv_font_t* font);
+void my_obj_release_fonts(lv_obj_t* obj);
 void my_btnmatrix_map_clear(lv_obj_t* obj);
 void my_msgbox_map_clear(lv_obj_t* obj);
 void my_line_clear_points(lv_obj_t* obj);
 void my_image_release_resources(lv_obj_t* obj);
-void my_obj_del_task(const lv_obj_t* obj);
 
 void hasp_process_obj_attribute(lv_obj_t* obj, const char* attr_p, const char* payload, bool update);
+void hasp_process_obj_attribute_hash(lv_obj_t* obj, const char* attr_p, uint16_t attr_hash, const char* payload,
+                                     bool update);
+uint16_t hasp_attribute_get_hash(const char* attr);
+uint8_t hasp_attribute_get_payload(uint16_t attr_hash);
+uint32_t hasp_attribute_table_hash();
+void hasp_process_obj_attribute_int(lv_obj_t* obj, const char* attr_p, uint16_t attr_hash, int32_t val);
 
 bool attribute_set_normalized_value(lv_obj_t* obj, hasp_update_value_t& value);
+bool attribute_get_value(lv_obj_t* obj, int32_t& val);
+bool attribute_get_text(lv_obj_t* obj, const char*& text);
 
 void attr_out_str(lv_obj_t* obj, const char* attribute, const char* data);
 void attr_out_json(lv_obj_t* obj, const char* attribute, const char* data);
@@ -63,6 +72,13 @@ typedef enum {
     HASP_ATTR_TYPE_METHOD_OK,
 } hasp_attribute_type_t;
 
+/* How the payload of an attribute is parsed before its handler is called */
+enum {
+    HASP_ATTR_PAYLOAD_TEXT = 0, // the handler parses the text itself
+    HASP_ATTR_PAYLOAD_INT,      // decimal number
+    HASP_ATTR_PAYLOAD_BOOL,     // true/false, on/off, 1/0
+};
+
 struct hasp_attr_local_opa_t
 {
     uint16_t hash;
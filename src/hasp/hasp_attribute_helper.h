@@ -3,85 +3,14 @@
 
 #include "hasplib.h"
 
-lv_task_t* my_obj_get_task(const lv_obj_t* obj)
-{
-    lv_task_t* task = lv_task_get_next(NULL);
-    while(task) {
-        if(task->user_data) {
-            hasp_task_user_data_t* data = (hasp_task_user_data_t*)task->user_data;
-            if(data->obj == obj) return task;
-        }
-        task = lv_task_get_next(task);
-    }
-    return NULL;
-}
-
-lv_task_t* my_obj_new_task(lv_obj_t* obj)
-{
-    if(!obj) return NULL;
-
-    lv_task_t* task                  = NULL;
-    hasp_task_user_data_t* user_data = (hasp_task_user_data_t*)lv_mem_alloc(sizeof(hasp_task_user_data_t));
-    if(user_data) {
-        user_data->obj      = obj;
-        user_data->templ    = (char*)D_TIMESTAMP;
-        user_data->interval = 1000;
-        task = lv_task_create(event_timer_clock, user_data->interval, LV_TASK_PRIO_LOWEST, (void*)user_data);
-        if(task) {
-            lv_task_set_repeat_count(task, -1); // Infinite
-        } else {
-            lv_mem_free(user_data);
-        }
-
-        // lv_task_ready(task);                // trigger it
-        // (void)task; // unused
-    }
-    return task;
-}
-
-void my_obj_del_task(const lv_obj_t* obj)
-{
-    lv_task_t* task = my_obj_get_task(obj);
-    if(!task) return;
-
-    hasp_task_user_data_t* data = (hasp_task_user_data_t*)task->user_data;
-    if(data) {
-        if(data->templ != D_TIMESTAMP) hasp_free(data->templ);
-        lv_mem_free(data);
-    }
-    lv_task_del(task);
-}
-
 const char* my_obj_get_template(const lv_obj_t* obj)
 {
-    lv_task_t* task = my_obj_get_task(obj);
-    if(!task || !task->user_data) return NULL;
-
-    hasp_task_user_data_t* data = (hasp_task_user_data_t*)task->user_data;
-    return data->templ;
+    return clock_get_template(obj);
 }
 
 void my_obj_set_template(lv_obj_t* obj, const char* text)
 {
-    lv_task_t* task = my_obj_get_task(obj);
-    if(!task || !task->user_data) {
-        task = my_obj_new_task(obj);
-    }
-
-    hasp_task_user_data_t* data = (hasp_task_user_data_t*)task->user_data;
-    if(data->templ != D_TIMESTAMP) hasp_free(data->templ);
-    data->templ = NULL;
-    if(!text) return;
-
-    size_t size = strlen(text);
-    if(size == 0) return;
-
-    size++; // terminating \0 character
-    data->templ = (char*)hasp_calloc(sizeof(char), size);
-    if(data->templ)
-        strncpy(data->templ, text, size);
-    else
-        LOG_WARNING(TAG_ATTR, "Failed to allocate memory!");
+    clock_set_template(obj, text);
 }
 
 // free the extended user_data when all properties are NULL
@@ -90,7 +19,7 @@ static void my_prune_ext_tags(lv_obj_t* obj)
     if(!obj || !obj->user_data.ext) return;
 
     hasp_ext_user_data_t* ext = (hasp_ext_user_data_t*)obj->user_data.ext;
-    if(!ext->action && !ext->swipe && !ext->tag) {
+    if(!ext->action && !ext->swipe && !ext->tag && !ext->fonts) {
         hasp_free(ext);
         obj->user_data.ext = NULL;
     }
@@ -302,6 +231,77 @@ const char* my_obj_get_swipe(lv_obj_t* obj)
     return ext ? ext->swipe : NULL;
 }
 
+/**
+ * Keep a loaded font in memory for as long as the object uses it in a style
+ * @param prop LV_STYLE_TEXT_FONT or LV_STYLE_VALUE_FONT, the font that was in this part and state is released
+ */
+void my_obj_set_font(lv_obj_t* obj, uint8_t part, lv_state_t state, lv_style_property_t prop, lv_font_t* font)
+{
+    hasp_ext_user_data_t* ext = (hasp_ext_user_data_t*)obj->user_data.ext;
+    prop |= state << LV_STYLE_STATE_POS;
+
+    // replace the font in the same style slot
+    if(ext) {
+        for(uint8_t i = 0; i < ext->font_count; i++) {
+            hasp_font_slot_t* slot = &ext->fonts[i];
+            if(slot->part != part || slot->prop != prop) continue;
+            if(slot->font == font) return; // font is already counted for this slot
+
+            font_remove_user(slot->font);
+            if(font_add_user(font)) {
+                slot->font = font;
+                return;
+            }
+
+            // built-in fonts are never released, drop the slot
+            *slot = ext->fonts[--ext->font_count];
+            if(ext->font_count == 0) {
+                hasp_free(ext->fonts);
+                ext->fonts = NULL;
+                my_prune_ext_tags(obj);
+            }
+            return;
+        }
+        if(ext->font_count == UINT8_MAX) return;
+    }
+
+    // built-in fonts are never released
+    if(!font_add_user(font)) return;
+
+    // create new extended tags
+    if(!ext) ext = my_create_ext_tags(obj);
+
+    if(ext) {
+        hasp_font_slot_t* fonts =
+            (hasp_font_slot_t*)hasp_realloc(ext->fonts, (ext->font_count + 1) * sizeof(hasp_font_slot_t));
+        if(fonts) {
+            fonts[ext->font_count].font   = font;
+            fonts[ext->font_count].prop   = prop;
+            fonts[ext->font_count++].part = part;
+            ext->fonts                    = fonts;
+            return; // no error & no prune
+        }
+    }
+
+    LOG_WARNING(TAG_ATTR, D_ERROR_OUT_OF_MEMORY); // ext or fonts was NULL
+    font_remove_user(font);
+    my_prune_ext_tags(obj);
+}
+
+// the object no longer uses its loaded fonts
+void my_obj_release_fonts(lv_obj_t* obj)
+{
+    hasp_ext_user_data_t* ext = (hasp_ext_user_data_t*)obj->user_data.ext;
+    if(!ext || !ext->fonts) return;
+
+    for(uint8_t i = 0; i < ext->font_count; i++) font_remove_user(ext->fonts[i].font);
+    hasp_free(ext->fonts);
+    ext->fonts      = NULL;
+    ext->font_count = 0;
+
+    my_prune_ext_tags(obj); // delete extended data if all extended properties are NULL
+}
+
 lv_label_align_t my_textarea_get_text_align(lv_obj_t* ta)
 {
     lv_textarea_ext_t* ext = (lv_textarea_ext_t*)lv_obj_get_ext_attr(ta);
@@ -0,0 +1,156 @@
+/* MIT License - Copyright (c) 2019-2024 Francis Van Roie
+   For full license information read the LICENSE file in the project folder */
+
+/* ********************************************************************************************
+ *
+ *  HASP Clock
+ *     - One task updates all labels with a template attribute every second
+ *     - The labels are sorted by template, so each distinct template is formatted once per tick
+ *     - Only the labels on the visible screen and the layers are updated, unless HASP_CLOCK_ALL_PAGES is set
+ *
+ ******************************************************************************************** */
+
+#include <time.h>
+#include <sys/time.h>
+
+#include "hasplib.h"
+#include "hasp_clock.h"
+
+typedef struct
+{
+    lv_obj_t* obj;
+    char* templ;
+} clock_label_t;
+
+static clock_label_t* clock_labels;
+static uint16_t clock_count;
+static uint16_t clock_size;
+static lv_task_t* clock_task;
+
+// Position of the first label with this template, or where it would be inserted
+static uint16_t clock_find(const char* templ)
+{
+    uint16_t low  = 0;
+    uint16_t high = clock_count;
+    while(low < high) {
+        uint16_t mid = (low + high) / 2;
+        if(strcmp(clock_labels[mid].templ, templ) < 0)
+            low = mid + 1;
+        else
+            high = mid;
+    }
+    return low;
+}
+
+static int32_t clock_index(const lv_obj_t* obj)
+{
+    for(uint16_t i = 0; i < clock_count; i++) {
+        if(clock_labels[i].obj == obj) return i;
+    }
+    return -1;
+}
+
+static bool clock_is_visible(const lv_obj_t* obj, const lv_obj_t* screen)
+{
+#if HASP_CLOCK_ALL_PAGES > 0
+    return true;
+#else
+    lv_obj_t* label_screen = lv_obj_get_screen(obj);
+    if(screen) return label_screen == screen;
+    return label_screen == lv_scr_act() || label_screen == lv_layer_top() || label_screen == lv_layer_sys();
+#endif
+}
+
+/* Format the templates for the labels on screen, or on the visible screens if NULL */
+static void clock_update(const lv_obj_t* screen)
+{
+    timeval now;
+    gettimeofday(&now, NULL);
+    time_t seconds = now.tv_sec;
+    tm* timeinfo   = localtime(&seconds);
+
+    if(clock_task) lv_task_set_period(clock_task, 1000 - now.tv_usec / 1000); // next tick on the second
+
+    char buffer[128]      = "";
+    const char* formatted = NULL; // template of the text in the buffer
+
+    for(uint16_t i = 0; i < clock_count; i++) {
+        clock_label_t* label = &clock_labels[i];
+        if(!clock_is_visible(label->obj, screen)) continue;
+
+        if(!formatted || strcmp(formatted, label->templ)) {
+            strftime(buffer, sizeof(buffer), label->templ, timeinfo);
+            formatted = label->templ;
+        }
+
+        char* cur_text = lv_label_get_text(label->obj);
+        if(cur_text && strcmp(buffer, cur_text)) lv_label_set_text(label->obj, buffer);
+    }
+}
+
+static void clock_task_cb(lv_task_t* task)
+{
+    clock_update(NULL);
+}
+
+void clock_refresh(const lv_obj_t* screen)
+{
+    if(clock_count && screen) clock_update(screen);
+}
+
+void clock_remove(const lv_obj_t* obj)
+{
+    int32_t i = clock_index(obj);
+    if(i < 0) return;
+
+    hasp_free(clock_labels[i].templ);
+    clock_count--;
+    memmove(&clock_labels[i], &clock_labels[i + 1], (clock_count - i) * sizeof(*clock_labels));
+
+    if(clock_count == 0 && clock_task) {
+        lv_task_del(clock_task);
+        clock_task = NULL;
+    }
+}
+
+void clock_set_template(lv_obj_t* obj, const char* templ)
+{
+    clock_remove(obj);
+    if(!obj || !templ || !*templ) return;
+
+    if(clock_count == clock_size) {
+        uint16_t size         = clock_size ? clock_size * 2 : 8;
+        clock_label_t* labels = (clock_label_t*)hasp_realloc(clock_labels, size * sizeof(*labels));
+        if(!labels) {
+            LOG_WARNING(TAG_ATTR, "Failed to allocate memory!");
+            return;
+        }
+        clock_labels = labels;
+        clock_size   = size;
+    }
+
+    size_t size = strlen(templ) + 1;
+    char* copy  = (char*)hasp_malloc(size);
+    if(!copy) {
+        LOG_WARNING(TAG_ATTR, "Failed to allocate memory!");
+        return;
+    }
+    memcpy(copy, templ, size);
+
+    uint16_t pos = clock_find(copy);
+    memmove(&clock_labels[pos + 1], &clock_labels[pos], (clock_count - pos) * sizeof(*clock_labels));
+    clock_labels[pos].obj   = obj;
+    clock_labels[pos].templ = copy;
+    clock_count++;
+
+    if(!clock_task) {
+        clock_task = lv_task_create(clock_task_cb, 1000, LV_TASK_PRIO_LOWEST, NULL);
+        if(clock_task) lv_task_ready(clock_task); // show the time right away
+    }
+}
+
+const char* clock_get_template(const lv_obj_t* obj)
+{
+    int32_t i = clock_index(obj);
+    return i < 0 ? NULL : clock_labels[i].templ;
+}
@@ -0,0 +1,19 @@
+/* MIT License - Copyright (c) 2019-2024 Francis Van Roie
+   For full license information read the LICENSE file in the project folder */
+
+#ifndef HASP_CLOCK_H
+#define HASP_CLOCK_H
+
+#include "hasplib.h"
+
+/* Set the strftime template of a label, NULL or an empty template stops the updates */
+void clock_set_template(lv_obj_t* obj, const char* templ);
+const char* clock_get_template(const lv_obj_t* obj);
+
+/* Stop updating a label, called when it is deleted */
+void clock_remove(const lv_obj_t* obj);
+
+/* Update the labels on a screen now, called when the screen is about to be shown */
+void clock_refresh(const lv_obj_t* screen);
+
+#endif
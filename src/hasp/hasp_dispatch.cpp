@@ -32,26 +32,43 @@
 
 #include "sys/svc/hasp_ota.h"
 #include "mqtt/hasp_mqtt.h"
+#include "mqtt/hasp_mqtt_trace.h"
+#include "log/hasp_log_ring.h"
 #include "sys/net/hasp_network.h" // for network_get_status()
 #include "sys/net/hasp_time.h"
 #endif
 #endif
 
-dispatch_conf_t dispatch_setings = {.teleperiod = 300};
+dispatch_conf_t dispatch_setings = {.teleperiod = 300, .batch = HASP_STATE_BATCH};
 
 uint16_t dispatchSecondsToNextTeleperiod = 0;
 uint16_t dispatchSecondsToNextSensordata = 0;
 uint16_t dispatchSecondsToNextDiscovery  = 0;
 uint8_t nCommands                        = 0;
-haspCommand_t commands[29];
+haspCommand_t commands[31];
 
 moodlight_t moodlight    = {.brightness = 255};
 uint8_t saved_jsonl_page = 0;
 
+extern char haspPagesPath[32];
+
+/* Object states waiting to be sent together on the batch subtopic */
+static struct
+{
+    char* buffer;
+    size_t len;       /* 0 when the batch is empty */
+    uint32_t started; /* time of the first state in the batch */
+} state_batch;
+
+static void dispatch_state_batch_flush();
+
 /* Sends the payload out on the state/subtopic
  */
 void dispatch_state_subtopic(const char* subtopic, const char* payload)
 {
+    if(!payload) return; // out of memory
+    if(state_batch.len) dispatch_state_batch_flush(); // keep the order of the messages
+
 #if HASP_USE_MQTT == 0 && defined(HASP_USE_TASMOTA_CLIENT) && HASP_USE_TASMOTA_CLIENT > 0
     LOG_TRACE(TAG_MSGR, F("%s => %s"), subtopic, payload);
 #else
@@ -85,18 +102,76 @@ void dispatch_state_subtopic(const char* subtopic, const char* payload)
 #endif
 }
 
+static void dispatch_state_batch_flush()
+{
+    state_batch.buffer[state_batch.len++] = '}';
+    state_batch.buffer[state_batch.len]   = '\0';
+    state_batch.len                       = 0;
+    dispatch_state_subtopic("batch", state_batch.buffer);
+}
+
+// Is there a state of this object in the batch already
+static bool dispatch_state_batch_has(const char* topic, size_t topic_len)
+{
+    const char* p = state_batch.buffer;
+    while((p = strstr(p + 1, topic))) {
+        if(p[-1] == '"' && p[topic_len] == '"' && p[topic_len + 1] == ':') return true;
+    }
+    return false;
+}
+
+/**
+ * Send the state of an object on its own subtopic, or add it to the batch when batching is enabled
+ * @param topic the object, like p1b5
+ * @param payload the serialized JSON object with the state
+ * @note the batch is a JSON object with the states by object: {"p1b5":{"val":3},"p1b6":{"text":"On"}}
+ */
+void dispatch_state_object(const char* topic, const char* payload)
+{
+    if(!payload) return; // out of memory
+    if(dispatch_setings.batch == 0) return dispatch_state_subtopic(topic, payload);
+
+    size_t topic_len   = strlen(topic);
+    size_t payload_len = strlen(payload);
+    size_t need        = topic_len + payload_len + 4; // separator, quoted topic and colon
+
+    if(!state_batch.buffer) state_batch.buffer = (char*)hasp_malloc(HASP_STATE_BATCH_SIZE);
+    if(!state_batch.buffer || need + 2 > HASP_STATE_BATCH_SIZE) return dispatch_state_subtopic(topic, payload);
+
+    // A second state of the same object starts a new batch, so the keys stay unique
+    if(state_batch.len > 0 &&
+       (state_batch.len + need + 2 > HASP_STATE_BATCH_SIZE || dispatch_state_batch_has(topic, topic_len)))
+        dispatch_state_batch_flush();
+
+    char* p = state_batch.buffer + state_batch.len;
+    if(state_batch.len == 0) {
+        *p++                = '{';
+        state_batch.started = millis();
+    } else {
+        *p++ = ',';
+    }
+    *p++ = '"';
+    memcpy(p, topic, topic_len);
+    p += topic_len;
+    *p++ = '"';
+    *p++ = ':';
+    memcpy(p, payload, payload_len + 1);
+    state_batch.len += need;
+}
+
 void dispatch_state_eventid(const char* topic, hasp_event_t eventid)
 {
     char payload[32];
     char eventname[8];
 
     Parser::get_event_name(eventid, eventname, sizeof(eventname));
+    JsonWriter json(payload, sizeof(payload));
     if(eventid == HASP_EVENT_ON || eventid == HASP_EVENT_OFF) {
-        snprintf_P(payload, sizeof(payload), PSTR("{\"state\":\"%s\"}"), eventname);
+        json.add_str("state", eventname);
     } else {
-        snprintf_P(payload, sizeof(payload), PSTR("{\"event\":\"%s\"}"), eventname);
+        json.add_str("event", eventname);
     }
-    dispatch_state_subtopic(topic, payload);
+    dispatch_state_subtopic(topic, json.end());
 }
 
 void dispatch_state_brightness(const char* topic, hasp_event_t eventid, int32_t val)
@@ -105,20 +180,21 @@ void dispatch_state_brightness(const char* topic, hasp_event_t eventid, int32_t
     char eventname[8];
 
     Parser::get_event_name(eventid, eventname, sizeof(eventname));
-    snprintf_P(payload, sizeof(payload), PSTR("{\"state\":\"%s\",\"brightness\":%d}"), eventname, val);
-    dispatch_state_subtopic(topic, payload);
+    JsonWriter json(payload, sizeof(payload));
+    json.add_str("state", eventname);
+    json.add_int("brightness", val);
+    dispatch_state_subtopic(topic, json.end());
 }
 
 void dispatch_state_antiburn(hasp_event_t eventid)
 {
-    char topic[9];
     char payload[64];
     char eventname[8];
 
     Parser::get_event_name(eventid, eventname, sizeof(eventname));
-    snprintf_P(topic, sizeof(topic), PSTR("antiburn"));
-    snprintf_P(payload, sizeof(payload), PSTR("{\"state\":\"%s\"}"), eventname);
-    dispatch_state_subtopic(topic, payload);
+    JsonWriter json(payload, sizeof(payload));
+    json.add_str("state", eventname);
+    dispatch_state_subtopic("antiburn", json.end());
 }
 
 void dispatch_state_val(const char* topic, hasp_event_t eventid, int32_t val)
@@ -127,8 +203,10 @@ void dispatch_state_val(const char* topic, hasp_event_t eventid, int32_t val)
     char eventname[8];
 
     Parser::get_event_name(eventid, eventname, sizeof(eventname));
-    snprintf_P(payload, sizeof(payload), PSTR("{\"state\":\"%s\",\"val\":%d}"), eventname, val);
-    dispatch_state_subtopic(topic, payload);
+    JsonWriter json(payload, sizeof(payload));
+    json.add_str("state", eventname);
+    json.add_int("val", val);
+    dispatch_state_subtopic(topic, json.end());
 }
 
 void dispatch_json_error(uint8_t tag, DeserializationError& jsonError)
@@ -634,9 +712,12 @@ void dispatch_screenshot(const char*, const char* filename, uint8_t source)
 {
 #if HASP_USE_SPIFFS > 0 || HASP_USE_LITTLEFS > 0
 
-    if(strlen(filename) == 0) { // no filename given
+    if(strlen(filename) == 0 || (filename[0] != '/' && !strchr(filename, '.'))) { // no filename, or only the format
         char tempfile[32];
-        memcpy_P(tempfile, PSTR("/screenshot.bmp"), sizeof(tempfile));
+        if(gui_screenshot_get_format(filename) == GUI_SCREENSHOT_QOI)
+            strcpy_P(tempfile, PSTR("/screenshot.qoi"));
+        else
+            strcpy_P(tempfile, PSTR("/screenshot.bmp"));
         guiTakeScreenshot(tempfile);
     } else if(strlen(filename) > 31 || filename[0] != '/') { // Invalid filename
         LOG_WARNING(TAG_MSGR, F("D_FILE_SAVE_FAILED"), filename);
@@ -741,38 +822,57 @@ void dispatch_parse_jsonl(std::istream& stream, uint8_t& saved_page_id)
     stream.setTimeout(25);
 #endif
 
-    // StaticJsonDocument<1024> jsonl;
-    DynamicJsonDocument jsonl(MQTT_MAX_PACKET_SIZE / 2 + 128);
-    DeserializationError jsonError; // = deserializeJson(jsonl, stream);
-    uint16_t line = 1;
+    char* buffer = (char*)hasp_malloc(HASP_JSONL_BUFFER_SIZE);
+    if(!buffer) {
+        LOG_ERROR(TAG_MSGR, F(D_ERROR_OUT_OF_MEMORY));
+        return;
+    }
 
-    // while(jsonError == DeserializationError::Ok) {
-    //     hasp_new_object(jsonl.as<JsonObject>(), saved_page_id);
-    //     jsonError = deserializeJson(jsonl, stream);
-    //     line++;
-    // }
+    JsonlReader reader(stream, buffer, HASP_JSONL_BUFFER_SIZE);
+    hasp_jsonl_pair_t pairs[HASP_JSONL_MAX_PAIRS];
+    hasp_jsonl_result_t result;
+    uint8_t count;
+    uint16_t line = 1;
+    unsigned long start = millis();
 
-    while(1) {
-        jsonError = deserializeJson(jsonl, stream);
-        if(jsonError == DeserializationError::Ok) {
-            hasp_new_object(jsonl.as<JsonObject>(), saved_page_id);
-            line++;
-        } else {
-            break;
-        }
-    };
+    while((result = reader.next(pairs, count)) == HASP_JSONL_OK) {
+        hasp_new_object(pairs, count, saved_page_id);
+        line++;
+    }
 
     /* For debugging purposes */
-    if(jsonError == DeserializationError::EmptyInput) {
-        LOG_DEBUG(TAG_MSGR, F(D_JSONL_SUCCEEDED));
+    if(result == HASP_JSONL_EMPTY) {
+        LOG_DEBUG(TAG_MSGR, F(D_JSONL_SUCCEEDED " (%u lines in %lu ms)"), line - 1, millis() - start);
 
     } else {
-        LOG_ERROR(TAG_MSGR, F(D_JSONL_FAILED ": %s"), line, jsonError.c_str());
+        LOG_ERROR(TAG_MSGR, F(D_JSONL_FAILED ": %s"), line, hasp_jsonl_result_name(result));
     }
 
+    hasp_free(buffer);
     saved_jsonl_page = saved_page_id;
 }
 
+#if HASP_USE_PAGE_CACHE > 0
+/**
+ * Create the objects of a pages file from its compiled copy
+ * @param pagesfile the jsonl file that was compiled
+ * @param saved_page_id the pageid to use when no pageid is specified
+ * @return false if there is no up-to-date compiled copy, the jsonl file needs to be parsed instead
+ */
+bool dispatch_parse_pagecache(const char* pagesfile, uint8_t& saved_page_id)
+{
+    if(!hasp_pagecache_load(pagesfile, saved_page_id)) return false;
+    saved_jsonl_page = saved_page_id;
+    return true;
+}
+#endif
+
+// Remember the page of the last object loaded, for jsonl lines without a page
+void dispatch_set_jsonl_page(uint8_t pageid)
+{
+    saved_jsonl_page = pageid;
+}
+
 void dispatch_parse_jsonl(const char*, const char* payload, uint8_t source)
 {
     if(source != TAG_MQTT) saved_jsonl_page = haspPages.get();
@@ -868,6 +968,22 @@ void dispatch_run_script(const char*, const char* payload, uint8_t source)
 #endif
 }
 
+#if HASP_USE_PAGE_CACHE > 0
+// Compile a jsonl pages file so it loads without being parsed, defaults to the configured pages file
+void dispatch_compile(const char*, const char* payload, uint8_t source)
+{
+    const char* filename = payload;
+    if(filename[0] == 'L' && filename[1] == ':') filename += 2; // strip littlefs drive letter
+    if(filename[0] == '\0') filename = haspPagesPath;
+
+    if(!HASP_FS.exists(filename)) {
+        LOG_WARNING(TAG_MSGR, F(D_FILE_NOT_FOUND ": %s"), filename);
+        return;
+    }
+    hasp_pagecache_compile(filename);
+}
+#endif
+
 /*
 void dispatch_fs(const char*, const char* payload, uint8_t source)
 {
@@ -1498,6 +1614,52 @@ void dispatch_sleep(const char*, const char*, uint8_t source)
     hasp_set_wakeup_touch(false);
 }
 
+// Set the time object states are collected for the batch subtopic, 0 sends each state on its own subtopic
+void dispatch_batch(const char*, const char* payload, uint8_t source)
+{
+    if(payload && strlen(payload)) {
+        if(!Parser::is_only_digits(payload)) {
+            LOG_WARNING(TAG_MSGR, F("Invalid batch value %s"), payload);
+            return;
+        }
+        unsigned long batch    = strtoul(payload, NULL, 10); // saturates instead of overflowing
+        dispatch_setings.batch = batch > UINT16_MAX ? UINT16_MAX : batch;
+        if(state_batch.len) dispatch_state_batch_flush();
+    }
+
+    LOG_INFO(TAG_MSGR, F("State batch %u ms"), dispatch_setings.batch);
+}
+
+#if HASP_USE_MQTT > 0 && HASP_USE_MQTT_TRACE > 0
+// Start recording the received messages to a file, or stop with off
+static void dispatch_mqtt_trace(const char*, const char* payload, uint8_t source)
+{
+    if(payload && strlen(payload)) {
+        if(payload[0] == '/' || (payload[0] == 'L' && payload[1] == ':'))
+            mqtt_trace_start(payload);
+        else if(Parser::is_true(payload))
+            mqtt_trace_start(MQTT_TRACE_FILE);
+        else
+            mqtt_trace_stop();
+    }
+
+    LOG_INFO(TAG_MSGR, F("MQTT trace %s"), mqtt_trace_is_active() ? "on" : "off");
+}
+#endif
+
+#if HASP_TARGET_ARDUINO && HASP_LOG_RING_SIZE > 0
+// Save the binary log ring to a file for tools/hasp_log_decode.py, or empty it with clear
+static void dispatch_log_ring(const char*, const char* payload, uint8_t source)
+{
+    if(payload && !strcasecmp_P(payload, PSTR("clear"))) {
+        log_ring_clear();
+        LOG_INFO(TAG_MSGR, F("Log ring cleared"));
+    } else {
+        log_ring_save(payload && strlen(payload) ? payload : LOG_RING_FILE);
+    }
+}
+#endif
+
 void dispatch_idle_state(uint8_t state)
 {
     char topic[8];
@@ -1632,11 +1794,21 @@ void dispatchSetup()
     dispatch_add_command(PSTR("idle"), dispatch_idle);
     dispatch_add_command(PSTR("sleep"), dispatch_sleep);
     dispatch_add_command(PSTR("statusupdate"), dispatch_statusupdate);
+    dispatch_add_command(PSTR("batch"), dispatch_batch);
+#if HASP_USE_MQTT > 0 && HASP_USE_MQTT_TRACE > 0
+    dispatch_add_command(PSTR("mqtttrace"), dispatch_mqtt_trace);
+#endif
+#if HASP_TARGET_ARDUINO && HASP_LOG_RING_SIZE > 0
+    dispatch_add_command(PSTR("logring"), dispatch_log_ring);
+#endif
     dispatch_add_command(PSTR("clearpage"), dispatch_clear_page);
     dispatch_add_command(PSTR("clearfont"), dispatch_clear_font);
     dispatch_add_command(PSTR("sensors"), dispatch_send_sensordata);
     dispatch_add_command(PSTR("theme"), dispatch_theme);
     dispatch_add_command(PSTR("run"), dispatch_run_script);
+#if HASP_USE_PAGE_CACHE > 0
+    dispatch_add_command(PSTR("compile"), dispatch_compile);
+#endif
     // dispatch_add_command(PSTR("fs"), dispatch_fs);
 #if HASP_TARGET_PC
     dispatch_add_command(PSTR("shell"), dispatch_shell_execute);
@@ -1672,6 +1844,8 @@ void dispatchSetup()
 
 IRAM_ATTR void dispatchLoop()
 {
+    if(state_batch.len && millis() - state_batch.started >= dispatch_setings.batch) dispatch_state_batch_flush();
+
     // UBaseType_t msg_count = uxQueueMessagesWaiting(message_queue));
     // if(msg_count == 0) return;
 
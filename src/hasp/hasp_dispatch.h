@@ -18,6 +18,7 @@
 struct dispatch_conf_t
 {
     uint16_t teleperiod;
+    uint16_t batch; // milliseconds to collect object states, 0 = disabled
 };
 
 struct moodlight_t
@@ -63,6 +64,10 @@ void dispatch_parse_jsonl(Stream& stream, uint8_t& saved_page_id);
 #else
 void dispatch_parse_jsonl(std::istream& stream, uint8_t& saved_page_id);
 #endif
+void dispatch_set_jsonl_page(uint8_t pageid);
+#if HASP_USE_PAGE_CACHE > 0
+bool dispatch_parse_pagecache(const char* pagesfile, uint8_t& saved_page_id);
+#endif
 bool dispatch_json_variant(JsonVariant& json, uint8_t& savedPage, uint8_t source);
 
 void dispatch_clear_page(const char* page);
@@ -89,11 +94,16 @@ void dispatch_calibrate(const char*, const char*, uint8_t source);
 void dispatch_antiburn(const char*, const char* payload, uint8_t source);
 void dispatch_wakeup(uint8_t source);
 void dispatch_run_script(const char*, const char* payload, uint8_t source);
+#if HASP_USE_PAGE_CACHE > 0
+void dispatch_compile(const char*, const char* payload, uint8_t source);
+#endif
+void dispatch_batch(const char*, const char* payload, uint8_t source);
 void dispatch_config(const char* topic, const char* payload, uint8_t source);
 
 void dispatch_normalized_group_values(hasp_update_value_t& value);
 
 void dispatch_state_subtopic(const char* subtopic, const char* payload);
+void dispatch_state_object(const char* topic, const char* payload);
 void dispatch_state_eventid(const char* topic, hasp_event_t eventid);
 void dispatch_state_brightness(const char* topic, hasp_event_t eventid, int32_t val);
 void dispatch_state_val(const char* topic, hasp_event_t eventid, int32_t val);
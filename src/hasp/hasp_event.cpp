@@ -84,6 +84,9 @@ void delete_event_handler(lv_obj_t* obj, lv_event_t event)
 
         case LV_HASP_IMAGE:
             my_image_release_resources(obj);
+#if HASP_USE_IMAGE_FETCH > 0 && defined(ARDUINO_ARCH_ESP32) && (HASP_USE_WIFI > 0 || HASP_USE_ETHERNET > 0)
+            image_fetch_cancel(obj);
+#endif
             break;
 
 #if HASP_USE_QRCODE > 0
@@ -96,7 +99,7 @@ void delete_event_handler(lv_obj_t* obj, lv_event_t event)
             break;
 
         case LV_HASP_LABEL:
-            my_obj_del_task(obj);
+            clock_remove(obj);
             break;
 
         case LV_HASP_DROPDOWN:
@@ -117,9 +120,12 @@ void delete_event_handler(lv_obj_t* obj, lv_event_t event)
         my_obj_set_value_str_text(obj, part, LV_STATE_DISABLED + LV_STATE_DEFAULT, NULL);
         my_obj_set_value_str_text(obj, part, LV_STATE_DISABLED + LV_STATE_CHECKED, NULL);
     }
+    my_obj_release_fonts(obj);
     my_obj_set_tag(obj, (char*)NULL);
     my_obj_set_action(obj, (char*)NULL);
     my_obj_set_swipe(obj, (char*)NULL);
+    object_index_remove(obj);
+    object_group_remove(obj);
 }
 
 /* ============================== Timer Event  ============================ */
@@ -166,45 +172,6 @@ void event_timer_calendar(lv_task_t* task)
 }
 #endif
 
-void event_timer_clock(lv_task_t* task)
-{
-    hasp_task_user_data_t* data = (hasp_task_user_data_t*)task->user_data;
-
-    if(!data || !data->obj || !lv_debug_check_obj_valid(data->obj)) {
-        if(data) {
-            if(data->templ != D_TIMESTAMP) hasp_free(data->templ);
-            lv_mem_free(data); // the object that the user_data points to is gone}
-        }
-        lv_task_del(task); // the calendar object for this task was deleted
-        LOG_WARNING(TAG_EVENT, "event_timer_clock could not find the linked object");
-        return;
-
-    } else if(!data->templ) {
-        return; // nothing to do
-    }
-
-    timeval curTime;
-    int rslt = gettimeofday(&curTime, NULL);
-    (void)rslt; // unused
-    time_t seconds = curTime.tv_sec;
-    auto tv_msec   = curTime.tv_usec / 1000;
-    tm* timeinfo   = localtime(&seconds);
-    lv_task_set_period(task, data->interval - tv_msec);
-
-    char buffer[128] = {0};
-    /* if(timeinfo->tm_year < 120) {
-         snprintf_P(buffer, sizeof(buffer), PSTR("%ld"), seconds);
-     } else */
-    strftime(buffer, sizeof(buffer), data->templ, timeinfo);
-
-    // LOG_VERBOSE(TAG_EVENT, "event_timer_clock called with user %d:%d:%d", timeinfo->tm_hour, timeinfo->tm_min,
-    //             timeinfo->tm_sec);
-
-    char* cur_text = lv_label_get_text(data->obj);
-    if(!cur_text || !strcmp(buffer, cur_text)) return; // No change
-    lv_label_set_text(data->obj, buffer);
-}
-
 /* ============================== Timer Event  ============================ */
 void event_timer_refresh(lv_task_t* task)
 {
@@ -271,48 +238,49 @@ static void event_send_object_data(lv_obj_t* obj, const char* data)
 
     if(hasp_find_id_from_obj(obj, &pageid, &objid)) {
         if(!data) return;
+#if HASP_USE_LAZY_PAGES > 0
+        haspPages.changed(pageid); // the object may have a new value
+#endif
         object_dispatch_state(pageid, objid, data);
     } else {
         LOG_ERROR(TAG_EVENT, F(D_OBJECT_UNKNOWN));
     }
 }
 
+// Start an event message with the event name
+static void event_add_name(JsonWriter& json, uint8_t eventid)
+{
+    char eventname[8];
+    Parser::get_event_name(eventid, eventname, sizeof(eventname));
+    json.add_str("event", eventname);
+}
+
+// Finish the event message with the tag of the object and send it out
+static void event_send_object_json(lv_obj_t* obj, JsonWriter& json)
+{
+    if(const char* tag = my_obj_get_tag(obj)) json.add_json("tag", tag);
+    event_send_object_data(obj, json.end());
+}
+
 // Send out events with a val attribute
 static void event_object_val_event(lv_obj_t* obj, uint8_t eventid, int16_t val)
 {
-    char data[512];
-    {
-        char eventname[8];
-        Parser::get_event_name(eventid, eventname, sizeof(eventname));
-        if(const char* tag = my_obj_get_tag(obj))
-            snprintf_P(data, sizeof(data), PSTR("{\"event\":\"%s\",\"val\":%d,\"tag\":%s}"), eventname, val, tag);
-        else
-            snprintf_P(data, sizeof(data), PSTR("{\"event\":\"%s\",\"val\":%d}"), eventname, val);
-    }
-    event_send_object_data(obj, data);
+    char data[HASP_JSON_STATE_SIZE];
+    JsonWriter json(data, sizeof(data));
+    event_add_name(json, eventid);
+    json.add_int("val", val);
+    event_send_object_json(obj, json);
 }
 
 // Send out events with a val and text attribute
 static void event_object_selection_changed(lv_obj_t* obj, uint8_t eventid, int16_t val, const char* text)
 {
-    char data[512];
-    {
-        StaticJsonDocument<256> doc;
-        size_t len = text ? strlen(text) : 0;
-        doc.set(text); // use text as-is
-        char serialized_text[256];
-        len = serializeJson(doc, serialized_text, sizeof(serialized_text));
-
-        char eventname[8];
-        Parser::get_event_name(eventid, eventname, sizeof(eventname));
-        if(const char* tag = my_obj_get_tag(obj))
-            snprintf_P(data, sizeof(data), PSTR("{\"event\":\"%s\",\"val\":%d,\"text\":%s,\"tag\":%s}"), eventname, val,
-                       serialized_text, tag);
-        else
-            snprintf_P(data, sizeof(data), PSTR("{\"event\":\"%s\",\"val\":%d,\"text\":%s}"), eventname, val,
-                       serialized_text);
-    }
-    event_send_object_data(obj, data);
+    char data[HASP_JSON_STATE_SIZE];
+    JsonWriter json(data, sizeof(data));
+    event_add_name(json, eventid);
+    json.add_int("val", val);
+    json.add_str("text", text);
+    event_send_object_json(obj, json);
 }
 
 // ##################### Event Handlers ########################################################
@@ -441,25 +409,19 @@ void textarea_event_handler(lv_obj_t* obj, lv_event_t event)
 {
     log_event("textarea", event);
 
-    if(event == LV_EVENT_VALUE_CHANGED) {
+    if(event == LV_EVENT_DELETE) {
+        delete_event_handler(obj, event);
+    } else if(event == LV_EVENT_VALUE_CHANGED) {
         LOG_TRACE(TAG_EVENT, "Changed to: %s", lv_textarea_get_text(obj));
 
         uint8_t hasp_event_id;
         if(!translate_event(obj, event, hasp_event_id)) return;
 
-        char data[1024];
-        {
-            char eventname[8];
-            Parser::get_event_name(hasp_event_id, eventname, sizeof(eventname));
-            if(const char* tag = my_obj_get_tag(obj))
-                snprintf_P(data, sizeof(data), PSTR("{\"event\":\"%s\",\"text\":\"%s\",\"tag\":%s}"), eventname,
-                           lv_textarea_get_text(obj), tag);
-            else
-                snprintf_P(data, sizeof(data), PSTR("{\"event\":\"%s\",\"text\":\"%s\"}"), eventname,
-                           lv_textarea_get_text(obj));
-        }
-
-        event_send_object_data(obj, data);
+        char data[HASP_JSON_STATE_SIZE];
+        JsonWriter json(data, sizeof(data));
+        event_add_name(json, hasp_event_id);
+        json.add_str("text", lv_textarea_get_text(obj));
+        event_send_object_json(obj, json);
     } else if(event == LV_EVENT_FOCUSED) {
         lv_textarea_set_cursor_hidden(obj, false);
     } else if(event == LV_EVENT_DEFOCUSED) {
@@ -538,16 +500,10 @@ void generic_event_handler(lv_obj_t* obj, lv_event_t event)
         Parser::get_event_name(last_value_sent, eventname, sizeof(eventname));
         script_event_handler(eventname, action);
     } else {
-        char data[512];
-        {
-            char eventname[8];
-            Parser::get_event_name(last_value_sent, eventname, sizeof(eventname));
-            if(const char* tag = my_obj_get_tag(obj))
-                snprintf_P(data, sizeof(data), PSTR("{\"event\":\"%s\",\"tag\":%s}"), eventname, tag);
-            else
-                snprintf_P(data, sizeof(data), PSTR("{\"event\":\"%s\"}"), eventname);
-        }
-        event_send_object_data(obj, data);
+        char data[HASP_JSON_STATE_SIZE];
+        JsonWriter json(data, sizeof(data));
+        event_add_name(json, last_value_sent);
+        event_send_object_json(obj, json);
     }
 
     // Update group objects and gpios on release
@@ -616,9 +572,6 @@ void selector_event_handler(lv_obj_t* obj, lv_event_t event)
 
     /* Get the new value */
     char buffer[128];
-#if LV_USE_TABLE > 0
-    char property[36];
-#endif
     uint16_t val = 0;
     uint16_t max = 0;
 
@@ -651,11 +604,12 @@ void selector_event_handler(lv_obj_t* obj, lv_event_t event)
             uint16_t col;
             if(lv_table_get_pressed_cell(obj, &row, &col) != LV_RES_OK) return; // outside any cell
 
-            const char* txt = lv_table_get_cell_value(obj, row, col);
-            strncpy(buffer, txt, sizeof(buffer));
-
-            snprintf_P(property, sizeof(property), PSTR("row\":%d,\"col\":%d,\"text"), row, col);
-            attr_out_str(obj, property, buffer);
+            char data[HASP_JSON_STATE_SIZE];
+            JsonWriter json(data, sizeof(data));
+            json.add_int("row", row);
+            json.add_int("col", col);
+            json.add_str("text", lv_table_get_cell_value(obj, row, col));
+            event_send_object_data(obj, json.end());
             return; // done sending
         }
 #endif
@@ -854,31 +808,20 @@ void cpicker_event_handler(lv_obj_t* obj, lv_event_t event)
 
     if(hasp_event_id == HASP_EVENT_CHANGED && last_color_sent.full == color.full) return; // same value as before
 
-    char data[512];
-    {
-        char eventname[8];
-        Parser::get_event_name(hasp_event_id, eventname, sizeof(eventname));
-
-        lv_color32_t c32;
-        lv_color_hsv_t hsv;
-        c32.full        = lv_color_to32(color);
-        hsv             = lv_color_rgb_to_hsv(c32.ch.red, c32.ch.green, c32.ch.blue);
-        last_color_sent = color;
-
-        if(const char* tag = my_obj_get_tag(obj))
-            snprintf_P(data, sizeof(data),
-                       PSTR("{\"event\":\"%s\",\"color\":\"#%02x%02x%02x\",\"r\":%d,\"g\":%d,\"b\":%d,\"h\":%d,\"s\":%"
-                            "d,\"v\":%d,\"tag\":%s}"),
-                       eventname, c32.ch.red, c32.ch.green, c32.ch.blue, c32.ch.red, c32.ch.green, c32.ch.blue, hsv.h,
-                       hsv.s, hsv.v, tag);
-        else
-            snprintf_P(data, sizeof(data),
-                       PSTR("{\"event\":\"%s\",\"color\":\"#%02x%02x%02x\",\"r\":%d,\"g\":%d,\"b\":%d,\"h\":%d,\"s\":%"
-                            "d,\"v\":%d}"),
-                       eventname, c32.ch.red, c32.ch.green, c32.ch.blue, c32.ch.red, c32.ch.green, c32.ch.blue, hsv.h,
-                       hsv.s, hsv.v);
-    }
-    event_send_object_data(obj, data);
+    lv_color32_t c32;
+    lv_color_hsv_t hsv;
+    c32.full        = lv_color_to32(color);
+    hsv             = lv_color_rgb_to_hsv(c32.ch.red, c32.ch.green, c32.ch.blue);
+    last_color_sent = color;
+
+    char data[HASP_JSON_STATE_SIZE];
+    JsonWriter json(data, sizeof(data));
+    event_add_name(json, hasp_event_id);
+    json.add_color("color", c32);
+    json.add_int("h", hsv.h);
+    json.add_int("s", hsv.s);
+    json.add_int("v", hsv.v);
+    event_send_object_json(obj, json);
 
     // event_update_group(obj->user_data.groupid, obj, val, min, max);
 }
@@ -889,6 +832,7 @@ void calendar_event_handler(lv_obj_t* obj, lv_event_t event)
     log_event("calendar", event);
 
     uint8_t hasp_event_id;
+    if(event == LV_EVENT_DELETE) return delete_event_handler(obj, event);
     if(event != LV_EVENT_PRESSED && event != LV_EVENT_RELEASED && event != LV_EVENT_VALUE_CHANGED) return;
     if(!translate_event(obj, event, hasp_event_id)) return; // Use LV_EVENT_VALUE_CHANGED
 
@@ -904,24 +848,20 @@ void calendar_event_handler(lv_obj_t* obj, lv_event_t event)
     if(hasp_event_id == HASP_EVENT_CHANGED && last_value_sent == val && last_obj_sent == obj)
         return; // same object and value as before
 
-    char data[512];
-    {
-        char eventname[8];
-        Parser::get_event_name(hasp_event_id, eventname, sizeof(eventname));
-
-        last_value_sent = val;
-        last_obj_sent   = obj;
+    last_value_sent = val;
+    last_obj_sent   = obj;
 
-        if(const char* tag = my_obj_get_tag(obj))
-            snprintf_P(data, sizeof(data),
-                       PSTR("{\"event\":\"%s\",\"val\":\"%d\",\"text\":\"%04d-%02d-%02dT00:00:00Z\",\"tag\":%s}"),
-                       eventname, date->day, date->year, date->month, date->day, tag);
-        else
-            snprintf_P(data, sizeof(data),
-                       PSTR("{\"event\":\"%s\",\"val\":\"%d\",\"text\":\"%04d-%02d-%02dT00:00:00Z\"}"), eventname,
-                       date->day, date->year, date->month, date->day);
-    }
-    event_send_object_data(obj, data);
+    char day[8];
+    char text[24];
+    itoa(date->day, day, DEC);
+    snprintf_P(text, sizeof(text), PSTR("%04d-%02d-%02dT00:00:00Z"), date->year, date->month, date->day);
+
+    char data[HASP_JSON_STATE_SIZE];
+    JsonWriter json(data, sizeof(data));
+    event_add_name(json, hasp_event_id);
+    json.add_str("val", day);
+    json.add_str("text", text);
+    event_send_object_json(obj, json);
 
     // event_update_group(obj->user_data.groupid, obj, val, min, max);
 }
@@ -24,6 +24,7 @@ typedef struct
 #endif // HASP_USE_FREETYPE
 
 #include "hasp_mem.h"
+#include "dev/device.h"
 #include "font/hasp_font_loader.h"
 
 #if defined(ARDUINO_ARCH_ESP32) && (HASP_USE_FREETYPE > 0) // && defined(ESP32S3)
@@ -36,15 +37,27 @@ extern const uint8_t OPENHASP_TTF_END[] asm("_binary_data_openhasp_ttf_end");
 // #endif
 #endif
 
-static lv_ll_t hasp_fonts_ll;
+#define FONT_REGISTRY_BUCKETS 16
+#define FONT_MISSING_MAX 16 // codepoints remembered per font
 
-typedef struct
+/* A loaded font, found by the hash of its payload */
+typedef struct hasp_font_info
 {
-    char* payload;   /* The payload with name and size */
-    lv_font_t* font; /* point to lvgl font */
+    struct hasp_font_info* next;        /* next font in the same bucket */
+    char* payload;                      /* The payload with name and size */
+    lv_font_t* font;                    /* point to lvgl font */
+    uint32_t hash;                      /* hash of the payload */
+    uint32_t bytes;                     /* memory allocated for a .bin font */
+    uint32_t last_used;                 /* time when the last user was removed */
+    uint16_t users;                     /* objects that have the font in a style */
     uint8_t type;
+    uint8_t missing_count;              /* codepoints in missing */
+    uint32_t missing[FONT_MISSING_MAX]; /* codepoints shown with this font that are not in it */
+    bool (*get_glyph_dsc)(const struct _lv_font_struct*, lv_font_glyph_dsc_t*, uint32_t, uint32_t);
 } hasp_font_info_t;
 
+static hasp_font_info_t* hasp_fonts[FONT_REGISTRY_BUCKETS];
+
 bool font_dummy_glyph_dsc(const struct _lv_font_struct*, lv_font_glyph_dsc_t*, uint32_t letter, uint32_t letter_next)
 {
     return false;
@@ -75,8 +88,6 @@ void font_setup()
 #else
     LOG_VERBOSE(TAG_FONT, F("FreeType " D_SERVICE_DISABLED));
 #endif // HASP_USE_FREETYPE
-
-    _lv_ll_init(&hasp_fonts_ll, sizeof(hasp_font_info_t));
 }
 
 size_t font_split_payload(const char* payload)
@@ -89,82 +100,144 @@ size_t font_split_payload(const char* payload)
     return 0;
 }
 
-static void font_release(void* node)
+/* FNV-1a hash of the payload */
+static uint32_t font_hash(const char* payload)
+{
+    uint32_t hash = 2166136261U;
+    while(*payload) {
+        hash ^= (uint8_t)*payload++;
+        hash *= 16777619U;
+    }
+    return hash;
+}
+
+static void font_release(hasp_font_info_t* font_p)
 {
-    hasp_font_info_t* font_p = (hasp_font_info_t*)node;
     if(font_p->font) {
-        if(font_p->type = 1) { // It's a FreeType font
+        if(font_p->type == 0) { // It's a binary font
+            hasp_font_free(font_p->font);
+        } else { // It's a FreeType font
 #if(HASP_USE_FREETYPE > 0)
             lv_ft_font_destroy(font_p->font);
 #endif
-        } else if(font_p->type = 0) { // It's a binary font
-            hasp_font_free(font_p->font);
         }
     }
 
-    /* Free the allocated font_name last */
-    if(font_p->payload) {
-        LOG_DEBUG(TAG_FONT, F("Released font %s"), font_p->payload);
-        hasp_free(font_p->payload);
+    LOG_DEBUG(TAG_FONT, F("Released font %s"), font_p->payload);
+    hasp_free(font_p); // the payload is stored after the font info
+}
+
+/* Release the fonts without users that have not been used for idle_ms */
+static size_t font_prune(uint32_t idle_ms)
+{
+    size_t released = 0;
+
+    for(uint8_t i = 0; i < FONT_REGISTRY_BUCKETS; i++) {
+        hasp_font_info_t** link = &hasp_fonts[i];
+        while(hasp_font_info_t* font_p = *link) {
+            if(font_p->users == 0 && millis() - font_p->last_used >= idle_ms) {
+                *link = font_p->next;
+                font_release(font_p);
+                released++;
+            } else {
+                link = &font_p->next;
+            }
+        }
     }
+
+    return released;
 }
 
+/**
+ * Release the fonts that are no longer used by any object when the memory is low
+ * @param idle_ms only release fonts that have been unused for this long
+ */
+void font_release_unused(uint32_t idle_ms)
+{
+    if(haspDevice.get_free_heap() >= HASP_FONT_LOW_MEMORY) return;
+
+    size_t released = font_prune(idle_ms);
+    if(released) LOG_VERBOSE(TAG_FONT, F("Released %u unused fonts"), (unsigned)released);
+}
+
+// Releases the fonts that are not used anymore, fonts still in a style are kept
 void font_clear_list(const char* payload)
 {
-    if(_lv_ll_is_empty(&hasp_fonts_ll)) return;
+    font_prune(0);
+
+    for(uint8_t i = 0; i < FONT_REGISTRY_BUCKETS; i++) {
+        for(hasp_font_info_t* font_p = hasp_fonts[i]; font_p; font_p = font_p->next) {
+            LOG_WARNING(TAG_FONT, F("Font %s is still used by %u objects"), font_p->payload, font_p->users);
+        }
+    }
+}
+
+/**
+ * Count an object that uses a loaded font
+ * @param font the font that was set in a style of the object
+ * @return false for built-in fonts, they are not counted
+ */
+bool font_add_user(lv_font_t* font)
+{
+    hasp_font_info_t* font_p = (hasp_font_info_t*)font->user_data;
+    if(!font_p) return false;
+
+    font_p->users++;
+    return true;
+}
+
+// The object using the font was deleted
+void font_remove_user(lv_font_t* font)
+{
+    hasp_font_info_t* font_p = (hasp_font_info_t*)font->user_data;
+    if(!font_p || font_p->users == 0) return;
 
-    while(void* node = _lv_ll_get_head(&hasp_fonts_ll)) {
-        font_release(node);
-        _lv_ll_remove(&hasp_fonts_ll, node);
-        lv_mem_free(node);
+    font_p->users--;
+    font_p->last_used = millis();
+}
+
+/* Remember the codepoints that are not in a .bin font, so they can be added to the next subset of the font */
+static bool font_get_glyph_dsc_checked(const struct _lv_font_struct* font, lv_font_glyph_dsc_t* dsc_out,
+                                       uint32_t letter, uint32_t letter_next)
+{
+    hasp_font_info_t* font_p = (hasp_font_info_t*)font->user_data;
+    if(font_p->get_glyph_dsc(font, dsc_out, letter, letter_next)) return true;
+    if(letter < 0x20 || font_p->missing_count >= FONT_MISSING_MAX) return false;
+
+    for(uint8_t i = 0; i < font_p->missing_count; i++) {
+        if(font_p->missing[i] == letter) return false;
     }
+    font_p->missing[font_p->missing_count++] = letter;
+    LOG_WARNING(TAG_FONT, F("Font %s has no glyph for 0x%X"), font_p->payload, letter);
+    return false;
 }
 
-// void font_clear_list2(const char* payload)
-// {
-//     hasp_font_info_t* font_p = (hasp_font_info_t*)_lv_ll_get_head(&hasp_fonts_ll);
-//     while(font_p) {
-//         if(font_p->type == 1) {
-//             lv_font_fmt_ft_dsc_t* dsc = (lv_font_fmt_ft_dsc_t*)font_p->font->dsc;
-//             if(strcmp(dsc->name, payload) == 0) { // name and size
-//                 lv_ft_font_destroy(font_p->font);
-//                 *font_p->font = HASP_FONT_1;
-//                 font_p->type  = 255;
-//             }
-//         }
-//         // if(strcmp(font_p->payload, payload) == 0) { // name and size
-//         //     LOG_DEBUG(TAG_FONT, F("Payload %s found => line height = %d - base_line = %d"), payload,
-//         //               font_p->font->line_height, font_p->font->base_line);
-//         //     return font_p->font;
-//         // }
-
-//         font_p = (hasp_font_info_t*)_lv_ll_get_next(&hasp_fonts_ll, font_p);
-//     }
-// }
-
-static lv_font_t* font_find_in_list(const char* payload)
+static lv_font_t* font_find_in_list(const char* payload, uint32_t hash)
 {
-    hasp_font_info_t* font_p = (hasp_font_info_t*)_lv_ll_get_head(&hasp_fonts_ll);
+    hasp_font_info_t* font_p = hasp_fonts[hash % FONT_REGISTRY_BUCKETS];
     while(font_p) {
-        if(strcmp(font_p->payload, payload) == 0) { // name and size
+        if(font_p->hash == hash && strcmp(font_p->payload, payload) == 0) { // name and size
             LOG_DEBUG(TAG_FONT, F("Payload %s found => line height = %d - base_line = %d"), payload,
                       font_p->font->line_height, font_p->font->base_line);
             return font_p->font;
         }
-        font_p = (hasp_font_info_t*)_lv_ll_get_next(&hasp_fonts_ll, font_p);
+        font_p = font_p->next;
     }
 
     return NULL;
 }
 
-static lv_font_t* font_add_to_list(const char* payload)
+static lv_font_t* font_add_to_list(const char* payload, uint32_t hash)
 {
     char filename[256];
 
+    // Make room first if the memory is low
+    font_release_unused(0);
+
     // Try .bin file
     snprintf_P(filename, sizeof(filename), PSTR("L:\\%s.bin"), payload);
-    lv_font_t* font   = hasp_font_load(filename);
-    char* name_p      = NULL;
+    size_t bytes      = 0;
+    lv_font_t* font   = hasp_font_load(filename, &bytes);
     uint8_t font_type = 0;
 
 #if defined(ARDUINO_ARCH_ESP32) && (HASP_USE_FREETYPE > 0)
@@ -234,19 +307,36 @@ static lv_font_t* font_add_to_list(const char* payload)
     if(!font) return NULL;
     LOG_VERBOSE(TAG_FONT, F("Loaded font %s line_height %d"), filename, font->line_height);
 
-    /* alloc payload str */
-    size_t len = strlen(payload);
-    name_p     = (char*)hasp_calloc(sizeof(char), len + 1);
-    if(!name_p) return NULL;
-    strncpy(name_p, payload, len);
+    /* alloc font info with the payload str */
+    size_t len                      = strlen(payload);
+    hasp_font_info_t* new_font_item = (hasp_font_info_t*)hasp_calloc(1, sizeof(hasp_font_info_t) + len + 1);
+    if(!new_font_item) {
+        LOG_ERROR(TAG_FONT, F(D_ERROR_OUT_OF_MEMORY));
+        if(font_type == 0) hasp_font_free(font);
+#if(HASP_USE_FREETYPE > 0)
+        else
+            lv_ft_font_destroy(font);
+#endif
+        return NULL;
+    }
 
-    hasp_font_info_t* new_font_item;
-    new_font_item = (hasp_font_info_t*)_lv_ll_ins_tail(&hasp_fonts_ll);
-    if(!new_font_item) return NULL;
+    new_font_item->payload   = (char*)(new_font_item + 1);
+    new_font_item->font      = font;
+    new_font_item->hash      = hash;
+    new_font_item->bytes     = bytes;
+    new_font_item->last_used = millis();
+    new_font_item->type      = font_type;
+    memcpy(new_font_item->payload, payload, len + 1);
+    font->user_data = new_font_item;
+
+    if(font_type == 0) { // FreeType draws its own placeholder for missing glyphs
+        new_font_item->get_glyph_dsc = font->get_glyph_dsc;
+        font->get_glyph_dsc          = font_get_glyph_dsc_checked;
+    }
 
-    new_font_item->payload = name_p;
-    new_font_item->font    = font;
-    new_font_item->type    = font_type;
+    hasp_font_info_t** bucket = &hasp_fonts[hash % FONT_REGISTRY_BUCKETS];
+    new_font_item->next       = *bucket;
+    *bucket                   = new_font_item;
     return font;
 }
 
@@ -257,8 +347,34 @@ lv_font_t* get_font(const char* payload)
     LOG_DEBUG(TAG_FONT, F("FreeType High Watermark %u"), lv_ft_freetype_high_watermark());
 #endif
 
-    lv_font_t* font = font_find_in_list(payload);
+    uint32_t hash   = font_hash(payload);
+    lv_font_t* font = font_find_in_list(payload, hash);
     if(font) return font;
 
-    return font_add_to_list(payload);
+    return font_add_to_list(payload, hash);
+}
+
+// Add the loaded fonts to the info json
+void font_get_info(JsonDocument& doc)
+{
+    JsonObject info = doc.createNestedObject(F("Fonts"));
+    char size_buf[32];
+
+    for(uint8_t i = 0; i < FONT_REGISTRY_BUCKETS; i++) {
+        for(hasp_font_info_t* font_p = hasp_fonts[i]; font_p; font_p = font_p->next) {
+            std::string buffer = std::to_string(font_p->users) + (font_p->users == 1 ? " user" : " users");
+            if(font_p->type == 0) {
+                Parser::format_bytes(font_p->bytes, size_buf, sizeof(size_buf));
+                buffer += ", ";
+                buffer += size_buf;
+            } else {
+                buffer += ", FreeType";
+            }
+            for(uint8_t j = 0; j < font_p->missing_count; j++) { // in the --add format of hasp_font_subset.py
+                snprintf_P(size_buf, sizeof(size_buf), PSTR("%s0x%X"), j ? "," : ", missing ", font_p->missing[j]);
+                buffer += size_buf;
+            }
+            info[font_p->payload] = buffer;
+        }
+    }
 }
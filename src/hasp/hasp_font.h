@@ -7,5 +7,9 @@
 void font_setup();
 lv_font_t* get_font(const char* payload);
 void font_clear_list(const char* payload);
+bool font_add_user(lv_font_t* font);
+void font_remove_user(lv_font_t* font);
+void font_release_unused(uint32_t idle_ms);
+void font_get_info(JsonDocument& doc);
 
 #endif
\ No newline at end of file
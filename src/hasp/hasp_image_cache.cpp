@@ -0,0 +1,288 @@
+/* MIT License - Copyright (c) 2019-2024 Francis Van Roie
+   For full license information read the LICENSE file in the project folder */
+
+/* ********************************************************************************************
+ *
+ *  HASP Image Cache
+ *     - An lvgl image decoder in front of the others, it lets them decode an image file once
+ *     - Their open session is kept with the decoded pixels until the byte budget needs the room
+ *     - The images on the current, prev and next page are pinned and never dropped
+ *     - Files that are read line by line, like LVGL .bin images, are left to their decoder
+ *
+ ******************************************************************************************** */
+
+#include "hasplib.h"
+#include "hasp_image_cache.h"
+
+#if HASP_IMAGE_DECODE_CACHE > 0 && LV_USE_FILESYSTEM > 0
+
+#define IMAGE_CACHE_HEAP_SHARE 8 // without PSRAM at most 1/8 of the free heap at boot is used
+
+typedef struct image_cache_entry_s
+{
+    struct image_cache_entry_s* next;
+    lv_img_decoder_dsc_t dec; // open session of the decoder that decoded the pixels
+    uint32_t size;            // bytes of the decoded pixels
+    uint32_t last_used;
+    uint16_t opened;          // lvgl sessions showing the pixels
+    bool pinned;              // on the current or an adjacent page
+    bool cached;              // false for an image that did not fit, it is freed when it is closed
+} image_cache_entry_t;
+
+static image_cache_entry_t* image_cache_list;
+static image_cache_stats_t image_cache_stats;
+static uint32_t image_cache_tick;
+static bool image_cache_busy;         // skip this decoder while it opens an image with the other decoders
+static uint8_t image_cache_pages[4];  // the top layer and the current, prev and next page
+static uint8_t image_cache_pin_count; // number of pages in image_cache_pages
+
+// Path of an image file without the lvgl drive letter and the leading slash
+static const char* image_cache_path(const char* src)
+{
+    if(src[0] && src[1] == ':') src += 2;
+    if(src[0] == '/') src++;
+    return src;
+}
+
+static image_cache_entry_t* image_cache_find(const char* src)
+{
+    for(image_cache_entry_t* entry = image_cache_list; entry; entry = entry->next) {
+        if(!strcmp((const char*)entry->dec.src, src)) return entry;
+    }
+    return NULL;
+}
+
+static void image_cache_free(image_cache_entry_t* entry)
+{
+    lv_img_decoder_close(&entry->dec); // frees the pixels
+    hasp_free(entry);
+}
+
+// Remove an entry from the list, it is freed when lvgl no longer shows it
+static void image_cache_drop(image_cache_entry_t* entry)
+{
+    for(image_cache_entry_t** link = &image_cache_list; *link; link = &(*link)->next) {
+        if(*link == entry) {
+            *link = entry->next;
+            break;
+        }
+    }
+    image_cache_stats.used -= entry->size;
+    entry->cached = false;
+
+    entry->opened++;                             // keep the entry while the lvgl image cache closes it
+    lv_img_cache_invalidate_src(entry->dec.src); // calls image_cache_close
+    if(--entry->opened == 0) image_cache_free(entry);
+}
+
+// Drop the least recently used images that are not pinned until size bytes fit the budget
+static bool image_cache_make_room(uint32_t size)
+{
+    if(size > image_cache_stats.size) return false;
+
+    while(image_cache_stats.used + size > image_cache_stats.size) {
+        image_cache_entry_t* oldest = NULL;
+        for(image_cache_entry_t* entry = image_cache_list; entry; entry = entry->next) {
+            if(!entry->pinned && (!oldest || entry->last_used < oldest->last_used)) oldest = entry;
+        }
+        if(!oldest) return false; // the pinned images fill the cache
+
+        image_cache_stats.evictions++;
+        image_cache_drop(oldest);
+    }
+    return true;
+}
+
+// True if an image object on the screen shows the file
+static bool image_cache_shown(lv_obj_t* parent, const char* src)
+{
+    for(lv_obj_t* child = lv_obj_get_child(parent, NULL); child; child = lv_obj_get_child(parent, child)) {
+        if(obj_check_type(child, LV_HASP_IMAGE)) {
+            const void* img_src = lv_img_get_src(child);
+            if(img_src && lv_img_src_get_type(img_src) == LV_IMG_SRC_FILE && !strcmp((const char*)img_src, src))
+                return true;
+        }
+        if(image_cache_shown(child, src)) return true;
+    }
+    return false;
+}
+
+// True if the file is shown on one of the pinned pages
+static bool image_cache_on_pinned_page(const char* src)
+{
+    for(uint8_t i = 0; i < image_cache_pin_count; i++) {
+        lv_obj_t* screen = haspPages.get_obj(image_cache_pages[i]);
+        if(screen && image_cache_shown(screen, src)) return true;
+    }
+    return false;
+}
+
+// Let the other decoders open the image, only images they decode at once are kept
+static image_cache_entry_t* image_cache_decode(const char* src, lv_color_t color)
+{
+    image_cache_entry_t* entry = (image_cache_entry_t*)hasp_calloc(1, sizeof(image_cache_entry_t));
+    if(!entry) return NULL;
+
+    uint32_t start   = millis();
+    image_cache_busy = true;
+    lv_res_t res     = lv_img_decoder_open(&entry->dec, src, color);
+    image_cache_busy = false;
+
+    lv_img_cf_t cf = entry->dec.header.cf;
+    if(res != LV_RES_OK || !entry->dec.img_data ||
+       (cf != LV_IMG_CF_TRUE_COLOR && cf != LV_IMG_CF_TRUE_COLOR_ALPHA && cf != LV_IMG_CF_TRUE_COLOR_CHROMA_KEYED)) {
+        if(res == LV_RES_OK) lv_img_decoder_close(&entry->dec);
+        hasp_free(entry);
+        return NULL;
+    }
+
+    uint32_t elapsed = millis() - start;
+    image_cache_stats.misses++;
+    image_cache_stats.decode_ms += elapsed;
+    LOG_VERBOSE(TAG_LVGL, F("Decoded %s in %u ms"), src, elapsed);
+
+    entry->size      = lv_img_buf_get_img_size(entry->dec.header.w, entry->dec.header.h, cf);
+    entry->last_used = ++image_cache_tick;
+    entry->pinned    = image_cache_on_pinned_page(src); // the pages are pinned before their images are drawn
+    if(image_cache_make_room(entry->size)) {
+        entry->cached    = true;
+        entry->next      = image_cache_list;
+        image_cache_list = entry;
+        image_cache_stats.used += entry->size;
+    }
+    return entry;
+}
+
+static lv_res_t image_cache_info(lv_img_decoder_t* decoder, const void* src, lv_img_header_t* header)
+{
+    if(image_cache_busy || lv_img_src_get_type(src) != LV_IMG_SRC_FILE) return LV_RES_INV;
+    if(!strcmp(lv_fs_get_ext((const char*)src), "bin")) return LV_RES_INV; // drawn from the file line by line
+
+    image_cache_entry_t* entry = image_cache_find((const char*)src);
+    if(entry) {
+        *header = entry->dec.header;
+        return LV_RES_OK;
+    }
+
+    image_cache_busy = true;
+    lv_res_t res     = lv_img_decoder_get_info(src, header);
+    image_cache_busy = false;
+    return res;
+}
+
+static lv_res_t image_cache_open(lv_img_decoder_t* decoder, lv_img_decoder_dsc_t* dsc)
+{
+    image_cache_entry_t* entry = image_cache_find((const char*)dsc->src);
+    if(entry)
+        image_cache_stats.hits++;
+    else
+        entry = image_cache_decode((const char*)dsc->src, dsc->color);
+    if(!entry) return LV_RES_INV; // the next decoder will try
+
+    entry->last_used = ++image_cache_tick;
+    entry->opened++;
+    dsc->header    = entry->dec.header;
+    dsc->img_data  = entry->dec.img_data;
+    dsc->user_data = entry;
+    return LV_RES_OK;
+}
+
+static void image_cache_close(lv_img_decoder_t* decoder, lv_img_decoder_dsc_t* dsc)
+{
+    image_cache_entry_t* entry = (image_cache_entry_t*)dsc->user_data;
+    if(!entry) return;
+
+    dsc->user_data = NULL;
+    if(entry->opened > 0) entry->opened--;
+    if(!entry->cached && entry->opened == 0) image_cache_free(entry);
+}
+
+// Call cb with the file source of each image object on the screen
+static void image_cache_walk(lv_obj_t* parent, void (*cb)(const char* src))
+{
+    lv_obj_t* child = lv_obj_get_child(parent, NULL);
+    while(child) {
+        if(obj_check_type(child, LV_HASP_IMAGE)) {
+            const void* src = lv_img_get_src(child);
+            if(src && lv_img_src_get_type(src) == LV_IMG_SRC_FILE) cb((const char*)src);
+        }
+        image_cache_walk(child, cb);
+        child = lv_obj_get_child(parent, child);
+    }
+}
+
+static void image_cache_pin(const char* src)
+{
+    image_cache_entry_t* entry = image_cache_find(src);
+    if(entry) entry->pinned = true;
+}
+
+static void image_cache_load(const char* src)
+{
+    if(image_cache_find(src) || !strcmp(lv_fs_get_ext(src), "bin")) return;
+
+    image_cache_entry_t* entry = image_cache_decode(src, LV_COLOR_BLACK);
+    if(entry && !entry->cached) image_cache_free(entry); // too large to keep
+}
+
+void image_cache_setup()
+{
+#if defined(ARDUINO_ARCH_ESP32)
+    if(hasp_use_psram()) {
+        image_cache_stats.size = HASP_IMAGE_DECODE_CACHE_PSRAM;
+    } else {
+        /* The internal heap is shared with the network stack and lvgl, only take a small part of it */
+        uint32_t share         = haspDevice.get_free_heap() / IMAGE_CACHE_HEAP_SHARE;
+        image_cache_stats.size = LV_MATH_MIN(HASP_IMAGE_DECODE_CACHE, share);
+    }
+    LOG_VERBOSE(TAG_LVGL, F("Image decode cache of %u bytes"), image_cache_stats.size);
+#else
+    image_cache_stats.size = HASP_IMAGE_DECODE_CACHE;
+#endif
+
+    /* Created last, so lvgl asks this decoder first */
+    lv_img_decoder_t* decoder = lv_img_decoder_create();
+    lv_img_decoder_set_info_cb(decoder, image_cache_info);
+    lv_img_decoder_set_open_cb(decoder, image_cache_open);
+    lv_img_decoder_set_close_cb(decoder, image_cache_close);
+}
+
+void image_cache_pin_page(uint8_t pageid)
+{
+    for(image_cache_entry_t* entry = image_cache_list; entry; entry = entry->next) entry->pinned = false;
+
+    /* The top layer is shown on every page. Images decoded later are pinned by image_cache_decode */
+    image_cache_pages[0]  = 0;
+    image_cache_pages[1]  = pageid;
+    image_cache_pages[2]  = haspPages.get_prev(pageid);
+    image_cache_pages[3]  = haspPages.get_next(pageid);
+    image_cache_pin_count = sizeof(image_cache_pages);
+
+    for(uint8_t i = 0; i < image_cache_pin_count; i++) {
+        lv_obj_t* screen = haspPages.get_obj(image_cache_pages[i]);
+        if(screen) image_cache_walk(screen, image_cache_pin);
+    }
+}
+
+void image_cache_prefetch(const lv_obj_t* screen)
+{
+    if(screen) image_cache_walk((lv_obj_t*)screen, image_cache_load);
+}
+
+void image_cache_invalidate(const char* path)
+{
+    path                       = image_cache_path(path);
+    image_cache_entry_t* entry = image_cache_list;
+    while(entry) {
+        image_cache_entry_t* next = entry->next;
+        if(!strcmp(image_cache_path((const char*)entry->dec.src), path)) image_cache_drop(entry);
+        entry = next;
+    }
+}
+
+void image_cache_get_stats(image_cache_stats_t* stats)
+{
+    *stats = image_cache_stats;
+}
+
+#endif
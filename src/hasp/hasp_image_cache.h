@@ -0,0 +1,42 @@
+/* MIT License - Copyright (c) 2019-2024 Francis Van Roie
+   For full license information read the LICENSE file in the project folder */
+
+#ifndef HASP_IMAGE_CACHE_H
+#define HASP_IMAGE_CACHE_H
+
+#include "hasplib.h"
+
+#if HASP_IMAGE_DECODE_CACHE > 0 && LV_USE_FILESYSTEM > 0
+
+typedef struct
+{
+    uint32_t hits;      // images opened from the cache
+    uint32_t misses;    // images decoded
+    uint32_t evictions; // images dropped to stay within the budget
+    uint32_t decode_ms; // total time spent decoding the misses
+    uint32_t used;      // bytes of decoded pixels
+    uint32_t size;      // byte budget
+} image_cache_stats_t;
+
+/* Cache of fully decoded image files, in front of the PNG, BMP and JPG decoders
+ *
+ * LVGL only caches a number of open images, so switching pages decodes their images again. The decoded
+ * pixels of image files are kept here within a byte budget. The least recently used images are dropped
+ * first, except those on the current and adjacent pages.
+ */
+void image_cache_setup();
+
+/* Pin the images of a page and its prev and next page, called when the page is shown, also those decoded later */
+void image_cache_pin_page(uint8_t pageid);
+
+/* Decode the images of a screen now, before its transition animation starts */
+void image_cache_prefetch(const lv_obj_t* screen);
+
+/* Drop a file from the cache after it has been written, path may have an lvgl drive letter */
+void image_cache_invalidate(const char* path);
+
+void image_cache_get_stats(image_cache_stats_t* stats);
+
+#endif
+
+#endif
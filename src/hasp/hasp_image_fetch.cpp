@@ -0,0 +1,672 @@
+/* MIT License - Copyright (c) 2019-2024 Francis Van Roie
+   For full license information read the LICENSE file in the project folder */
+
+/* ********************************************************************************************
+ *
+ *  HASP Image Fetch
+ *     - The src of an image object is downloaded by the imgFetch task, the GUI keeps running
+ *     - JPEG images are decoded stripe by stripe while they are received
+ *     - PNG images are decoded by the task after the download, LVGL .bin images are used as is
+ *     - The finished image is swapped in by an lv_task, an older download of the same object is dropped
+ *     - Images stay cached with their ETag and Last-Modified until the cache budget is full
+ *     - The size of one image is limited by the free memory, not by the cache budget
+ *
+ ******************************************************************************************** */
+
+#include "hasplib.h"
+#include "hasp_image_fetch.h"
+
+#if HASP_USE_IMAGE_FETCH > 0 && defined(ARDUINO_ARCH_ESP32) && (HASP_USE_WIFI > 0 || HASP_USE_ETHERNET > 0)
+
+#include <HTTPClient.h>
+#include "esp_heap_caps.h"
+
+#if HASP_USE_PNGDECODE > 0
+#include "lodepng.h"
+#endif
+
+#if __has_include("esp32/rom/tjpgd.h")
+#include "esp32/rom/tjpgd.h"
+#define IMAGE_FETCH_JPEG 1
+#elif __has_include("esp32s3/rom/tjpgd.h")
+#include "esp32s3/rom/tjpgd.h"
+#define IMAGE_FETCH_JPEG 1
+#elif __has_include("rom/tjpgd.h")
+#include "rom/tjpgd.h"
+#define IMAGE_FETCH_JPEG 1
+#else
+#define IMAGE_FETCH_JPEG 0
+#endif
+
+#ifndef HASP_IMAGE_FETCH_QUEUE
+#define HASP_IMAGE_FETCH_QUEUE 4 // downloads waiting for or handled by the task
+#endif
+
+#define IMAGE_CACHE_ENTRIES 8
+#define IMAGE_FETCH_JPEG_POOL 3100 // work area of tjpgd
+#define IMAGE_FETCH_TIMEOUT 5000
+#define IMAGE_FETCH_MAX_PX 2047 // w and h are 11 bits in lv_img_header_t
+#define IMAGE_FETCH_HEADROOM (32 * 1024U) // heap left for the GUI and network when an image is allocated
+#define IMAGE_FETCH_STACK (8 * 1024U)     // HTTPClient with a TLS handshake for https, and the JPEG decoder
+
+/* Negative results besides the HTTPClient errors */
+enum image_fetch_error_t {
+    IMAGE_FETCH_ERROR_READ   = -100,
+    IMAGE_FETCH_ERROR_MEMORY = -101,
+    IMAGE_FETCH_ERROR_FORMAT = -102,
+    IMAGE_FETCH_ERROR_SIZE   = -103,
+};
+
+typedef struct
+{
+    lv_obj_t* obj;
+    uint8_t page;
+    uint8_t id;
+    uint16_t max_w;    // larger JPEG images are scaled down to fit the display
+    uint16_t max_h;
+    uint32_t seq;      // only the newest download of an object is shown
+    char* url;
+    char etag[48];     // validators sent with the request, and received with the response
+    char modified[32];
+    int status;        // HTTP result code or image_fetch_error_t
+    lv_img_dsc_t* dsc; // the downloaded image with the url behind it
+    size_t size;       // bytes of the image data
+    uint32_t time_ms;  // to download and decode
+    bool retried;      // downloaded again after the unused cached images were freed
+} image_fetch_job_t;
+
+typedef struct
+{
+    lv_img_dsc_t* dsc;
+    size_t size;
+    uint32_t last_used;
+    uint16_t users; // image objects showing dsc
+    bool stale;     // replaced by a newer download, freed when it is no longer shown
+    char etag[48];
+    char modified[32];
+} image_cache_entry_t;
+
+typedef struct
+{
+    const lv_obj_t* obj;
+    uint32_t seq;
+} image_pending_t;
+
+static image_cache_entry_t image_cache[IMAGE_CACHE_ENTRIES];
+static size_t image_cache_used;
+
+static image_pending_t image_pending[HASP_IMAGE_FETCH_QUEUE];
+static uint32_t image_fetch_seq;
+
+static QueueHandle_t image_fetch_requests;
+static QueueHandle_t image_fetch_results;
+static TaskHandle_t image_fetch_task;
+
+/* ===== Image buffers ===== */
+
+static inline const char* image_url(const lv_img_dsc_t* dsc)
+{
+    return (const char*)dsc + sizeof(lv_img_dsc_t);
+}
+
+// Descriptor with the url stored behind it, like special_attribute_src expects
+static lv_img_dsc_t* image_alloc_dsc(const char* url)
+{
+    size_t len        = sizeof(lv_img_dsc_t) + strlen(url) + 1;
+    lv_img_dsc_t* dsc = (lv_img_dsc_t*)hasp_malloc(len);
+    if(!dsc) return NULL;
+
+    memset(dsc, 0, len);
+    strcpy((char*)image_url(dsc), url);
+    return dsc;
+}
+
+static void image_free(lv_img_dsc_t* dsc)
+{
+    if(!dsc) return;
+    hasp_free((void*)dsc->data);
+    hasp_free(dsc);
+}
+
+/* ===== Download task ===== */
+
+// Largest image buffer the task may allocate now, the cached images are freed by the GUI when it fails
+static size_t image_fetch_max_size()
+{
+    uint32_t caps = hasp_use_psram() ? MALLOC_CAP_SPIRAM : MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT;
+    size_t block  = heap_caps_get_largest_free_block(caps);
+    return block > IMAGE_FETCH_HEADROOM ? block - IMAGE_FETCH_HEADROOM : 0;
+}
+
+typedef struct
+{
+    Stream* stream;
+    const uint8_t* prefix; // bytes already read to detect the format
+    size_t prefix_len;
+    size_t remaining;      // bytes left in the body, SIZE_MAX when the length is unknown
+} image_fetch_io_t;
+
+// Read up to len bytes of the body, buf is NULL to skip them
+static size_t image_fetch_read(image_fetch_io_t* io, uint8_t* buf, size_t len)
+{
+    size_t done = 0;
+    while(done < len && io->prefix_len > 0) {
+        if(buf) buf[done] = *io->prefix;
+        io->prefix++;
+        io->prefix_len--;
+        done++;
+    }
+
+    uint8_t skip[64];
+    while(done < len && io->remaining > 0) {
+        size_t want  = LV_MATH_MIN(len - done, io->remaining);
+        uint8_t* dst = buf ? buf + done : skip;
+        if(!buf) want = LV_MATH_MIN(want, sizeof(skip));
+
+        size_t count = io->stream->readBytes(dst, want);
+        if(count == 0) break; // closed or timed out
+        done += count;
+        if(io->remaining != SIZE_MAX) io->remaining -= count;
+    }
+    return done;
+}
+
+#if IMAGE_FETCH_JPEG > 0
+typedef struct
+{
+    image_fetch_io_t io;
+    lv_color_t* pixels;
+    uint16_t width;
+    uint16_t height;
+} image_fetch_jpeg_t;
+
+static UINT image_fetch_jpeg_input(JDEC* jd, BYTE* buf, UINT len)
+{
+    return image_fetch_read(&((image_fetch_jpeg_t*)jd->device)->io, buf, len);
+}
+
+// Convert one decoded block of RGB888 pixels into the image
+static UINT image_fetch_jpeg_output(JDEC* jd, void* bitmap, JRECT* rect)
+{
+    image_fetch_jpeg_t* jpeg = (image_fetch_jpeg_t*)jd->device;
+    const uint8_t* rgb       = (const uint8_t*)bitmap;
+    uint16_t w               = rect->right - rect->left + 1;
+
+    for(uint16_t y = rect->top; y <= rect->bottom && y < jpeg->height; y++, rgb += w * 3) {
+        lv_color_t* dst = jpeg->pixels + (size_t)y * jpeg->width + rect->left;
+        for(uint16_t x = 0; x < w && rect->left + x < jpeg->width; x++) {
+            dst[x] = lv_color_make(rgb[x * 3], rgb[x * 3 + 1], rgb[x * 3 + 2]);
+        }
+    }
+    return 1;
+}
+
+static int image_fetch_jpeg(image_fetch_job_t* job, image_fetch_io_t* io)
+{
+    image_fetch_jpeg_t jpeg = {};
+    jpeg.io                 = *io;
+
+    void* pool = hasp_malloc(IMAGE_FETCH_JPEG_POOL);
+    if(!pool) return IMAGE_FETCH_ERROR_MEMORY;
+
+    JDEC jdec;
+    if(jd_prepare(&jdec, image_fetch_jpeg_input, pool, IMAGE_FETCH_JPEG_POOL, &jpeg) != JDR_OK) {
+        hasp_free(pool);
+        return IMAGE_FETCH_ERROR_FORMAT;
+    }
+
+    /* Scale down to fit the display, and the 11 bits of the image header */
+    uint16_t max_w = LV_MATH_MIN(job->max_w, IMAGE_FETCH_MAX_PX);
+    uint16_t max_h = LV_MATH_MIN(job->max_h, IMAGE_FETCH_MAX_PX);
+    uint8_t scale  = 0; // 1/1, 1/2, 1/4 or 1/8
+    while(scale < 3 && ((jdec.width >> scale) > max_w || (jdec.height >> scale) > max_h)) scale++;
+    jpeg.width  = jdec.width >> scale;
+    jpeg.height = jdec.height >> scale;
+    if(jpeg.width > IMAGE_FETCH_MAX_PX || jpeg.height > IMAGE_FETCH_MAX_PX) {
+        hasp_free(pool);
+        return IMAGE_FETCH_ERROR_SIZE;
+    }
+
+    size_t size = (size_t)jpeg.width * jpeg.height * sizeof(lv_color_t);
+    if(size == 0) {
+        hasp_free(pool);
+        return IMAGE_FETCH_ERROR_SIZE;
+    }
+    if(size > image_fetch_max_size()) {
+        hasp_free(pool);
+        return IMAGE_FETCH_ERROR_MEMORY;
+    }
+
+    jpeg.pixels = (lv_color_t*)hasp_malloc(size);
+    job->dsc    = image_alloc_dsc(job->url);
+    if(!jpeg.pixels || !job->dsc) {
+        hasp_free(jpeg.pixels);
+        hasp_free(pool);
+        return IMAGE_FETCH_ERROR_MEMORY;
+    }
+    memset(jpeg.pixels, 0, size);
+    job->dsc->data = (const uint8_t*)jpeg.pixels; // freed with the descriptor from now on
+
+    JRESULT res = jd_decomp(&jdec, image_fetch_jpeg_output, scale);
+    hasp_free(pool);
+    if(res != JDR_OK) return IMAGE_FETCH_ERROR_READ;
+
+    job->dsc->header.always_zero = 0;
+    job->dsc->header.w           = jpeg.width;
+    job->dsc->header.h           = jpeg.height;
+    job->dsc->header.cf          = LV_IMG_CF_TRUE_COLOR;
+    job->dsc->data_size          = size;
+    job->size                    = size;
+    return HTTP_CODE_OK;
+}
+#endif
+
+#if HASP_USE_PNGDECODE > 0
+// Decode the PNG here instead of at every redraw, RGBA8888 is converted in place to true color with alpha
+static int image_fetch_png(image_fetch_job_t* job, const uint8_t* data, size_t len)
+{
+    /* lodepng allocates 4 bytes per pixel, check the size in the IHDR chunk before decoding */
+    if(len < 24) return IMAGE_FETCH_ERROR_FORMAT;
+    uint32_t png_w = ((uint32_t)data[16] << 24) | (data[17] << 16) | (data[18] << 8) | data[19];
+    uint32_t png_h = ((uint32_t)data[20] << 24) | (data[21] << 16) | (data[22] << 8) | data[23];
+    if(png_w == 0 || png_h == 0 || png_w > IMAGE_FETCH_MAX_PX || png_h > IMAGE_FETCH_MAX_PX)
+        return IMAGE_FETCH_ERROR_SIZE;
+    if((size_t)png_w * png_h * 4 > image_fetch_max_size()) return IMAGE_FETCH_ERROR_MEMORY;
+
+    unsigned char* pixels = NULL;
+    unsigned w, h;
+    if(lodepng_decode32(&pixels, &w, &h, data, len) || !pixels) return IMAGE_FETCH_ERROR_FORMAT;
+
+    size_t size = (size_t)w * h * LV_IMG_PX_SIZE_ALPHA_BYTE;
+
+    uint8_t* dst = pixels;
+    for(const uint8_t* src = pixels; src < pixels + (size_t)w * h * 4; src += 4) {
+        lv_color_t color = lv_color_make(src[0], src[1], src[2]);
+#if LV_COLOR_DEPTH == 32
+        color.ch.alpha = src[3];
+        memcpy(dst, &color, sizeof(color));
+#else
+        uint8_t alpha = src[3];
+        memcpy(dst, &color, sizeof(color));
+        dst[sizeof(color)] = alpha;
+#endif
+        dst += LV_IMG_PX_SIZE_ALPHA_BYTE;
+    }
+
+    job->dsc = image_alloc_dsc(job->url);
+    if(!job->dsc) {
+        hasp_free(pixels);
+        return IMAGE_FETCH_ERROR_MEMORY;
+    }
+
+    void* shrunk                 = hasp_realloc(pixels, size);
+    job->dsc->data               = (const uint8_t*)(shrunk ? shrunk : pixels);
+    job->dsc->header.always_zero = 0;
+    job->dsc->header.w           = w;
+    job->dsc->header.h           = h;
+    job->dsc->header.cf          = LV_IMG_CF_TRUE_COLOR_ALPHA;
+    job->dsc->data_size          = size;
+    job->size                    = size;
+    return HTTP_CODE_OK;
+}
+#endif
+
+// PNG and LVGL .bin images are read completely, their length must be known
+static int image_fetch_buffered(image_fetch_job_t* job, image_fetch_io_t* io)
+{
+    if(io->remaining == SIZE_MAX) return IMAGE_FETCH_ERROR_SIZE;
+    size_t total = io->prefix_len + io->remaining;
+    if(total > image_fetch_max_size()) return IMAGE_FETCH_ERROR_MEMORY;
+
+    uint8_t* data = (uint8_t*)hasp_malloc(total);
+    if(!data) return IMAGE_FETCH_ERROR_MEMORY;
+    if(image_fetch_read(io, data, total) != total) {
+        hasp_free(data);
+        return IMAGE_FETCH_ERROR_READ;
+    }
+
+    const uint8_t png_magic[] = {0x89, 0x50, 0x4e, 0x47, 0x0d, 0x0a, 0x1a, 0x0a};
+    if(!memcmp(png_magic, data, sizeof(png_magic))) {
+#if HASP_USE_PNGDECODE > 0
+        int res = image_fetch_png(job, data, total);
+        hasp_free(data);
+        return res;
+#else
+        if(total <= 24) {
+            hasp_free(data);
+            return IMAGE_FETCH_ERROR_FORMAT;
+        }
+        job->dsc = image_alloc_dsc(job->url);
+        if(!job->dsc) {
+            hasp_free(data);
+            return IMAGE_FETCH_ERROR_MEMORY;
+        }
+        job->dsc->header.w  = data[19] + (data[18] << 8);
+        job->dsc->header.h  = data[23] + (data[22] << 8);
+        job->dsc->header.cf = LV_IMG_CF_RAW_ALPHA;
+        job->dsc->data_size = total;
+        job->dsc->data      = data;
+        job->size           = total;
+        return HTTP_CODE_OK;
+#endif
+    }
+
+    /* BIN format, move the pixels behind the header to the start of the buffer */
+    lv_img_header_t header;
+    memcpy(&header, data, sizeof(header));
+    if(header.cf == LV_IMG_CF_UNKNOWN || header.w == 0 || header.h == 0) {
+        hasp_free(data);
+        return IMAGE_FETCH_ERROR_FORMAT;
+    }
+    /* LVGL reads the pixels by the header, a short file would be read past its end */
+    uint32_t img_size = lv_img_buf_get_img_size(header.w, header.h, header.cf);
+    if(total < sizeof(header) || img_size == 0 || img_size > total - sizeof(header)) {
+        hasp_free(data);
+        return IMAGE_FETCH_ERROR_SIZE;
+    }
+    job->dsc = image_alloc_dsc(job->url);
+    if(!job->dsc) {
+        hasp_free(data);
+        return IMAGE_FETCH_ERROR_MEMORY;
+    }
+    memmove(data, data + sizeof(header), total - sizeof(header));
+    job->dsc->header    = header;
+    job->dsc->data_size = total - sizeof(header);
+    job->dsc->data      = data;
+    job->size           = total;
+    return HTTP_CODE_OK;
+}
+
+static void image_fetch_download(image_fetch_job_t* job)
+{
+    uint32_t start        = millis();
+    const char* headers[] = {"ETag", "Last-Modified"};
+
+    HTTPClient http;
+    http.begin(job->url);
+    http.useHTTP10(true); // no chunked encoding, the body is decoded straight from the stream
+    http.setTimeout(IMAGE_FETCH_TIMEOUT);
+    http.setConnectTimeout(IMAGE_FETCH_TIMEOUT);
+    http.collectHeaders(headers, sizeof(headers) / sizeof(headers[0]));
+    if(*job->etag) http.addHeader("If-None-Match", job->etag);
+    if(*job->modified) http.addHeader("If-Modified-Since", job->modified);
+
+    job->status = http.GET();
+    if(job->status == HTTP_CODE_OK) {
+        snprintf(job->etag, sizeof(job->etag), "%s", http.header("ETag").c_str());
+        snprintf(job->modified, sizeof(job->modified), "%s", http.header("Last-Modified").c_str());
+
+        int total           = http.getSize();
+        image_fetch_io_t io = {};
+        io.stream           = http.getStreamPtr();
+        io.remaining        = total < 0 ? SIZE_MAX : total;
+
+        uint8_t magic[8];
+        if(!io.stream || image_fetch_read(&io, magic, sizeof(magic)) != sizeof(magic)) {
+            job->status = IMAGE_FETCH_ERROR_READ;
+        } else {
+            io.prefix     = magic;
+            io.prefix_len = sizeof(magic);
+#if IMAGE_FETCH_JPEG > 0
+            if(magic[0] == 0xFF && magic[1] == 0xD8)
+                job->status = image_fetch_jpeg(job, &io);
+            else
+#endif
+                job->status = image_fetch_buffered(job, &io);
+        }
+    }
+    http.end();
+
+    if(job->status != HTTP_CODE_OK) {
+        image_free(job->dsc);
+        job->dsc = NULL;
+    }
+    job->time_ms = millis() - start;
+}
+
+static void image_fetch_task_cb(void* param)
+{
+    image_fetch_job_t* job;
+    while(true) {
+        if(xQueueReceive(image_fetch_requests, &job, portMAX_DELAY) != pdTRUE) continue;
+        image_fetch_download(job);
+        LOG_DEBUG(TAG_ATTR, F("Image download task: %u bytes of stack never used"), uxTaskGetStackHighWaterMark(NULL));
+        xQueueSend(image_fetch_results, &job, portMAX_DELAY);
+    }
+}
+
+/* ===== Cache, only used in the GUI context ===== */
+
+static image_cache_entry_t* image_cache_find(const char* url)
+{
+    for(image_cache_entry_t& entry : image_cache) {
+        if(entry.dsc && !entry.stale && !strcmp(image_url(entry.dsc), url)) return &entry;
+    }
+    return NULL;
+}
+
+static void image_cache_free(image_cache_entry_t* entry)
+{
+    lv_img_cache_invalidate_src(entry->dsc); // a PNG may still be decoded in the lvgl image cache
+    image_cache_used -= entry->size;
+    image_free(entry->dsc);
+    memset(entry, 0, sizeof(image_cache_entry_t));
+}
+
+// Least recently used image that is not shown, NULL if all of them are
+static image_cache_entry_t* image_cache_oldest()
+{
+    image_cache_entry_t* oldest = NULL;
+    for(image_cache_entry_t& entry : image_cache) {
+        if(!entry.dsc || entry.users > 0) continue;
+        if(!oldest || (int32_t)(entry.last_used - oldest->last_used) < 0) oldest = &entry;
+    }
+    return oldest;
+}
+
+static void image_cache_trim()
+{
+    size_t budget = hasp_use_psram() ? HASP_IMAGE_CACHE_SIZE_PSRAM : HASP_IMAGE_CACHE_SIZE;
+    while(image_cache_used > budget) {
+        image_cache_entry_t* oldest = image_cache_oldest();
+        if(!oldest) break; // everything is on screen
+        image_cache_free(oldest);
+    }
+}
+
+// Free the images that are not shown, returns false if there were none
+static bool image_cache_evict_unused()
+{
+    bool freed = false;
+    while(image_cache_entry_t* oldest = image_cache_oldest()) {
+        image_cache_free(oldest);
+        freed = true;
+    }
+    return freed;
+}
+
+// Take over the image of a finished download, returns NULL if there is no room for it
+static image_cache_entry_t* image_cache_insert(image_fetch_job_t* job)
+{
+    image_cache_entry_t* entry = image_cache_find(job->url);
+    if(entry) { // the objects still showing the previous copy keep it until they are updated
+        entry->stale = true;
+        if(entry->users == 0) image_cache_free(entry);
+    }
+
+    entry = NULL;
+    for(image_cache_entry_t& free_entry : image_cache) {
+        if(!free_entry.dsc) {
+            entry = &free_entry;
+            break;
+        }
+    }
+    if(!entry && (entry = image_cache_oldest())) image_cache_free(entry);
+    if(!entry) return NULL;
+
+    entry->dsc       = job->dsc;
+    entry->size      = job->size;
+    entry->last_used = millis();
+    memcpy(entry->etag, job->etag, sizeof(entry->etag));
+    memcpy(entry->modified, job->modified, sizeof(entry->modified));
+    image_cache_used += entry->size;
+    job->dsc = NULL;
+    return entry;
+}
+
+static void image_cache_show(lv_obj_t* obj, image_cache_entry_t* entry)
+{
+    entry->last_used = millis();
+    if(lv_img_get_src(obj) == entry->dsc) return;
+
+    my_image_release_resources(obj);
+    lv_img_set_src(obj, entry->dsc);
+    entry->users++;
+}
+
+// Returns true if the job was queued again
+static bool image_fetch_complete(image_fetch_job_t* job)
+{
+    /* The task could not allocate the image, try once more without the unused cached images */
+    if(job->status == IMAGE_FETCH_ERROR_MEMORY && !job->retried && image_cache_evict_unused()) {
+        job->retried     = true;
+        job->etag[0]     = 0; // the cached copy may be gone, a 304 would leave nothing to show
+        job->modified[0] = 0;
+        if(xQueueSend(image_fetch_requests, &job, 0) == pdTRUE) return true;
+    }
+
+    lv_obj_t* obj = NULL;
+    for(image_pending_t& pending : image_pending) {
+        if(pending.obj == job->obj && pending.seq == job->seq) {
+            pending.obj = NULL;
+            /* The object may have been deleted while downloading */
+            if(hasp_find_obj_from_page_id(job->page, job->id) == job->obj) obj = job->obj;
+            break;
+        }
+    }
+
+    image_cache_entry_t* entry = NULL;
+    if(job->status == HTTP_CODE_NOT_MODIFIED) {
+        entry = image_cache_find(job->url);
+        LOG_VERBOSE(TAG_ATTR, F("Image not modified %s"), job->url);
+
+    } else if(job->status == HTTP_CODE_OK) {
+        LOG_VERBOSE(TAG_ATTR, F("Image %s: w=%d h=%d cf=%d in %u ms"), job->url, job->dsc->header.w,
+                    job->dsc->header.h, job->dsc->header.cf, job->time_ms);
+        entry = image_cache_insert(job);
+
+    } else {
+        LOG_WARNING(TAG_ATTR, F("Image %s failed: %d"), job->url, job->status);
+    }
+
+    if(obj && entry) image_cache_show(obj, entry);
+    image_cache_trim();
+    return false;
+}
+
+static void image_fetch_free_job(image_fetch_job_t* job)
+{
+    image_free(job->dsc);
+    hasp_free(job->url);
+    hasp_free(job);
+}
+
+static void image_fetch_poll_cb(lv_task_t* task)
+{
+    image_fetch_job_t* job;
+    while(xQueueReceive(image_fetch_results, &job, 0) == pdTRUE) {
+        if(!image_fetch_complete(job)) image_fetch_free_job(job);
+    }
+}
+
+// The task is only started when the first http image is used
+static bool image_fetch_start()
+{
+    if(image_fetch_task) return true;
+
+    if(!image_fetch_requests) image_fetch_requests = xQueueCreate(HASP_IMAGE_FETCH_QUEUE, sizeof(image_fetch_job_t*));
+    if(!image_fetch_results) image_fetch_results = xQueueCreate(HASP_IMAGE_FETCH_QUEUE, sizeof(image_fetch_job_t*));
+    if(!image_fetch_requests || !image_fetch_results) return false;
+
+    if(xTaskCreatePinnedToCore(image_fetch_task_cb, "imgFetch", IMAGE_FETCH_STACK, NULL, 1, &image_fetch_task, 0) !=
+       pdPASS) {
+        image_fetch_task = NULL;
+        LOG_ERROR(TAG_ATTR, F("Failed to start the image download task"));
+        return false;
+    }
+    lv_task_create(image_fetch_poll_cb, 50, LV_TASK_PRIO_LOW, NULL);
+    return true;
+}
+
+bool image_fetch_src(lv_obj_t* obj, const char* url)
+{
+    uint8_t page, id;
+    if(!hasp_find_id_from_obj(obj, &page, &id) || !image_fetch_start()) return false;
+
+    image_pending_t* slot = NULL;
+    for(image_pending_t& pending : image_pending) {
+        if(pending.obj == obj) {
+            slot = &pending; // replaces the previous download of obj
+            break;
+        }
+        if(!pending.obj && !slot) slot = &pending;
+    }
+    if(!slot) {
+        LOG_WARNING(TAG_ATTR, F("Too many images are downloading, %s skipped"), url);
+        return false;
+    }
+
+    image_fetch_job_t* job = (image_fetch_job_t*)hasp_calloc(1, sizeof(image_fetch_job_t));
+    if(job) job->url = (char*)hasp_malloc(strlen(url) + 1);
+    if(!job || !job->url) {
+        hasp_free(job);
+        LOG_ERROR(TAG_ATTR, F(D_ERROR_OUT_OF_MEMORY));
+        return false;
+    }
+    strcpy(job->url, url);
+    job->obj   = obj;
+    job->page  = page;
+    job->id    = id;
+    job->max_w = LV_HOR_RES;
+    job->max_h = LV_VER_RES;
+    job->seq   = ++image_fetch_seq;
+
+    /* Show the cached copy right away, the server is only asked if it changed */
+    if(image_cache_entry_t* entry = image_cache_find(url)) {
+        image_cache_show(obj, entry);
+        memcpy(job->etag, entry->etag, sizeof(job->etag));
+        memcpy(job->modified, entry->modified, sizeof(job->modified));
+    }
+
+    if(xQueueSend(image_fetch_requests, &job, 0) != pdTRUE) {
+        LOG_WARNING(TAG_ATTR, F("Too many images are downloading, %s skipped"), url);
+        image_fetch_free_job(job);
+        return false;
+    }
+
+    slot->obj = obj;
+    slot->seq = job->seq;
+    return true;
+}
+
+void image_fetch_cancel(const lv_obj_t* obj)
+{
+    for(image_pending_t& pending : image_pending) {
+        if(pending.obj == obj) pending.obj = NULL; // the result is still cached when it arrives
+    }
+}
+
+bool image_fetch_release(const void* src)
+{
+    for(image_cache_entry_t& entry : image_cache) {
+        if(entry.dsc != src) continue;
+
+        if(entry.users > 0) entry.users--;
+        entry.last_used = millis();
+        if(entry.stale && entry.users == 0) image_cache_free(&entry);
+        return true;
+    }
+    return false;
+}
+
+#endif
@@ -0,0 +1,30 @@
+/* MIT License - Copyright (c) 2019-2024 Francis Van Roie
+   For full license information read the LICENSE file in the project folder */
+
+#ifndef HASP_IMAGE_FETCH_H
+#define HASP_IMAGE_FETCH_H
+
+#include "hasplib.h"
+
+#if HASP_USE_IMAGE_FETCH > 0 && defined(ARDUINO_ARCH_ESP32) && (HASP_USE_WIFI > 0 || HASP_USE_ETHERNET > 0)
+
+/* Download of http images by a background task, the image is swapped in when it is complete
+ *
+ * JPEG images are decoded while they are received and kept as true color pixels, other formats are kept as
+ * downloaded. The images stay in a cache of HASP_IMAGE_CACHE_SIZE bytes, or HASP_IMAGE_CACHE_SIZE_PSRAM with
+ * PSRAM, with their ETag and Last-Modified. Setting the same url again shows the cached copy right away and
+ * only asks the server if it changed. A single image may be larger than the cache, up to the free memory.
+ */
+
+/* Show the image of url on obj, returns false if the download could not be queued */
+bool image_fetch_src(lv_obj_t* obj, const char* url);
+
+/* Forget a pending download, called when the src of obj is set to something else */
+void image_fetch_cancel(const lv_obj_t* obj);
+
+/* Release an image source shown by an object, returns false if it does not belong to the cache */
+bool image_fetch_release(const void* src);
+
+#endif
+
+#endif
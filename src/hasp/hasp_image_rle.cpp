@@ -0,0 +1,184 @@
+/* MIT License - Copyright (c) 2019-2024 Francis Van Roie
+   For full license information read the LICENSE file in the project folder */
+
+#include "hasplib.h"
+#include "hasp_image_rle.h"
+
+#if HASP_USE_RLEDECODE > 0 && LV_USE_FILESYSTEM > 0
+
+typedef struct
+{
+    lv_fs_file_t file;     // of a file source
+    bool file_open;
+    const uint8_t* data;   // of a variable source, the image without its header
+    uint32_t data_size;
+    uint32_t* offsets;     // h + 1 line offsets from the start of the file
+    uint8_t* packed;       // compressed line
+    uint8_t* line;         // decoded line
+    uint32_t packed_size;
+    int32_t line_y;        // line in the buffer, -1 if none
+    uint8_t px_size;       // bytes per pixel
+} image_rle_t;
+
+static inline bool image_rle_is_rle(uint8_t cf)
+{
+    return cf == LV_IMG_CF_RLE_TRUE_COLOR || cf == LV_IMG_CF_RLE_TRUE_COLOR_ALPHA;
+}
+
+// Read size bytes at pos of the image file
+static bool image_rle_read(image_rle_t* rle, uint32_t pos, void* buf, uint32_t size)
+{
+    if(rle->file_open) {
+        uint32_t br;
+        return lv_fs_seek(&rle->file, pos) == LV_FS_RES_OK && lv_fs_read(&rle->file, buf, size, &br) == LV_FS_RES_OK &&
+               br == size;
+    }
+
+    if(pos < sizeof(lv_img_header_t)) return false;
+    pos -= sizeof(lv_img_header_t);
+    if(pos > rle->data_size || size > rle->data_size - pos) return false; // without wrapping around
+    memcpy(buf, rle->data + pos, size);
+    return true;
+}
+
+static bool image_rle_decode_line(image_rle_t* rle, lv_coord_t w, lv_coord_t y)
+{
+    uint32_t start = rle->offsets[y];
+    uint32_t size  = rle->offsets[y + 1] - start;
+    if(rle->offsets[y + 1] < start || size > rle->packed_size) return false;
+    if(!image_rle_read(rle, start, rle->packed, size)) return false;
+
+    const uint8_t* src     = rle->packed;
+    const uint8_t* src_end = rle->packed + size;
+    uint8_t* dst           = rle->line;
+    uint8_t* dst_end       = rle->line + w * rle->px_size;
+
+    while(src < src_end) {
+        uint8_t n = *src++;
+        if(n < 128) { // literal pixels
+            uint32_t bytes = (n + 1) * rle->px_size;
+            if(src + bytes > src_end || dst + bytes > dst_end) return false;
+            memcpy(dst, src, bytes);
+            src += bytes;
+            dst += bytes;
+
+        } else { // one pixel repeated, copied in doubling blocks
+            uint32_t bytes = (n - 127) * rle->px_size;
+            if(src + rle->px_size > src_end || dst + bytes > dst_end) return false;
+            memcpy(dst, src, rle->px_size);
+            for(uint32_t done = rle->px_size; done < bytes; done *= 2) {
+                memcpy(dst + done, dst, LV_MATH_MIN(done, bytes - done));
+            }
+            src += rle->px_size;
+            dst += bytes;
+        }
+    }
+    if(dst != dst_end) return false;
+
+    rle->line_y = y;
+    return true;
+}
+
+static lv_res_t image_rle_info(lv_img_decoder_t* decoder, const void* src, lv_img_header_t* header)
+{
+    lv_img_src_t src_type = lv_img_src_get_type(src);
+
+    if(src_type == LV_IMG_SRC_VARIABLE) {
+        const lv_img_dsc_t* img_dsc = (const lv_img_dsc_t*)src;
+        if(!image_rle_is_rle(img_dsc->header.cf)) return LV_RES_INV;
+        *header = img_dsc->header;
+
+    } else if(src_type == LV_IMG_SRC_FILE) {
+        if(strcmp(lv_fs_get_ext((const char*)src), "bin")) return LV_RES_INV;
+
+        lv_fs_file_t file;
+        uint32_t br;
+        if(lv_fs_open(&file, (const char*)src, LV_FS_MODE_RD) != LV_FS_RES_OK) return LV_RES_INV;
+        lv_fs_res_t res = lv_fs_read(&file, header, sizeof(lv_img_header_t), &br);
+        lv_fs_close(&file);
+        if(res != LV_FS_RES_OK || br != sizeof(lv_img_header_t) || !image_rle_is_rle(header->cf)) return LV_RES_INV;
+
+    } else {
+        return LV_RES_INV;
+    }
+
+    /* lvgl draws the lines like an uncompressed image */
+    header->cf = header->cf == LV_IMG_CF_RLE_TRUE_COLOR ? LV_IMG_CF_TRUE_COLOR : LV_IMG_CF_TRUE_COLOR_ALPHA;
+    return LV_RES_OK;
+}
+
+static void image_rle_close(lv_img_decoder_t* decoder, lv_img_decoder_dsc_t* dsc)
+{
+    image_rle_t* rle = (image_rle_t*)dsc->user_data;
+    if(!rle) return;
+
+    if(rle->file_open) lv_fs_close(&rle->file);
+    hasp_free(rle->offsets);
+    hasp_free(rle->packed);
+    hasp_free(rle->line);
+    hasp_free(rle);
+    dsc->user_data = NULL;
+}
+
+static lv_res_t image_rle_open(lv_img_decoder_t* decoder, lv_img_decoder_dsc_t* dsc)
+{
+    image_rle_t* rle = (image_rle_t*)hasp_calloc(1, sizeof(image_rle_t));
+    if(!rle) return LV_RES_INV;
+    dsc->user_data = rle;
+
+    /* dsc->header is already converted by image_rle_info */
+    lv_coord_t w        = dsc->header.w;
+    lv_coord_t h        = dsc->header.h;
+    uint32_t table_size = (h + 1) * sizeof(uint32_t);
+    rle->line_y         = -1;
+    rle->px_size        = dsc->header.cf == LV_IMG_CF_TRUE_COLOR ? sizeof(lv_color_t) : LV_IMG_PX_SIZE_ALPHA_BYTE;
+    rle->packed_size    = w * rle->px_size + (w + 127) / 128; // a line of only literal packets
+    rle->offsets        = (uint32_t*)hasp_malloc(table_size);
+    rle->packed         = (uint8_t*)hasp_malloc(rle->packed_size);
+    rle->line           = (uint8_t*)hasp_malloc(w * rle->px_size);
+
+    bool ok = rle->offsets && rle->packed && rle->line;
+    if(ok && dsc->src_type == LV_IMG_SRC_FILE) {
+        rle->file_open = lv_fs_open(&rle->file, (const char*)dsc->src, LV_FS_MODE_RD) == LV_FS_RES_OK;
+        ok             = rle->file_open;
+    } else if(ok) {
+        rle->data      = ((const lv_img_dsc_t*)dsc->src)->data;
+        rle->data_size = ((const lv_img_dsc_t*)dsc->src)->data_size;
+    }
+    if(ok) ok = image_rle_read(rle, sizeof(lv_img_header_t), rle->offsets, table_size);
+
+    if(!ok) {
+        image_rle_close(decoder, dsc);
+        return LV_RES_INV;
+    }
+
+    dsc->img_data = NULL; // lvgl reads the image line by line
+    return LV_RES_OK;
+}
+
+static lv_res_t image_rle_read_line(lv_img_decoder_t* decoder, lv_img_decoder_dsc_t* dsc, lv_coord_t x, lv_coord_t y,
+                                    lv_coord_t len, uint8_t* buf)
+{
+    image_rle_t* rle = (image_rle_t*)dsc->user_data;
+    if(!rle || y >= (lv_coord_t)dsc->header.h) return LV_RES_INV;
+
+    /* lvgl asks for the same line again for each area that is drawn */
+    if(y != rle->line_y && !image_rle_decode_line(rle, dsc->header.w, y)) {
+        LOG_WARNING(TAG_LVGL, F("Corrupt line %d in RLE image"), y);
+        return LV_RES_INV;
+    }
+
+    memcpy(buf, rle->line + x * rle->px_size, len * rle->px_size);
+    return LV_RES_OK;
+}
+
+void image_rle_init()
+{
+    lv_img_decoder_t* decoder = lv_img_decoder_create();
+    lv_img_decoder_set_info_cb(decoder, image_rle_info);
+    lv_img_decoder_set_open_cb(decoder, image_rle_open);
+    lv_img_decoder_set_read_line_cb(decoder, image_rle_read_line);
+    lv_img_decoder_set_close_cb(decoder, image_rle_close);
+}
+
+#endif
@@ -0,0 +1,27 @@
+/* MIT License - Copyright (c) 2019-2024 Francis Van Roie
+   For full license information read the LICENSE file in the project folder */
+
+#ifndef HASP_IMAGE_RLE_H
+#define HASP_IMAGE_RLE_H
+
+#include "hasplib.h"
+
+#if HASP_USE_RLEDECODE > 0 && LV_USE_FILESYSTEM > 0
+
+#define LV_IMG_CF_RLE_TRUE_COLOR LV_IMG_CF_USER_ENCODED_0       // RLE compressed LV_IMG_CF_TRUE_COLOR
+#define LV_IMG_CF_RLE_TRUE_COLOR_ALPHA LV_IMG_CF_USER_ENCODED_1 // RLE compressed LV_IMG_CF_TRUE_COLOR_ALPHA
+
+/* Decoder of the RLE compressed .bin images made by tools/hasp_img_convert.py
+ *
+ * After the lvgl image header follow h + 1 uint32 offsets from the start of the file to each line, the
+ * last one is the end of the image. A line is a series of packets with the native pixels of the display:
+ *   n < 128:  n + 1 pixels follow
+ *   n >= 128: the next pixel repeats n - 127 times
+ * Lines are decoded when lvgl draws them, so the image is never held in RAM as a whole. Uncompressed .bin
+ * images are drawn from the file by the built-in lvgl decoder.
+ */
+void image_rle_init();
+
+#endif
+
+#endif
@@ -0,0 +1,177 @@
+/* MIT License - Copyright (c) 2019-2024 Francis Van Roie
+   For full license information read the LICENSE file in the project folder */
+
+#include "hasplib.h"
+#include "hasp_json_writer.h"
+
+static const char json_hex[] = "0123456789abcdef";
+
+JsonWriter::JsonWriter(char* buffer, size_t size)
+{
+    this->buffer = buffer;
+    this->size   = size;
+    this->pos    = 0;
+    this->heap   = false;
+    this->failed = false;
+    put('{');
+}
+
+JsonWriter::~JsonWriter()
+{
+    if(heap) hasp_free(buffer);
+}
+
+// Move to a larger heap buffer, with room for len more characters and the terminator
+bool JsonWriter::grow(size_t len)
+{
+    if(failed) return false;
+
+    size_t new_size = (pos + len + 1) * 2;
+    char* new_buffer;
+    if(heap) {
+        new_buffer = (char*)hasp_realloc(buffer, new_size);
+    } else {
+        new_buffer = (char*)hasp_malloc(new_size);
+        if(new_buffer) memcpy(new_buffer, buffer, pos);
+    }
+
+    if(!new_buffer) {
+        failed = true;
+        return false;
+    }
+
+    buffer = new_buffer;
+    size   = new_size;
+    heap   = true;
+    return true;
+}
+
+inline void JsonWriter::put(char c)
+{
+    if(pos + 1 < size || grow(1)) buffer[pos++] = c;
+}
+
+inline void JsonWriter::write(const char* text, size_t len)
+{
+    if(pos + len >= size && !grow(len)) return;
+    memcpy(buffer + pos, text, len);
+    pos += len;
+}
+
+void JsonWriter::write_int(int32_t val)
+{
+    char digits[12];
+    char* p       = digits + sizeof(digits);
+    uint32_t uval = val < 0 ? 0 - (uint32_t)val : val;
+
+    do {
+        *--p = '0' + uval % 10;
+        uval /= 10;
+    } while(uval);
+    if(val < 0) *--p = '-';
+
+    write(p, digits + sizeof(digits) - p);
+}
+
+void JsonWriter::write_escaped(const char* text)
+{
+    put('"');
+    while(*text) {
+        const char* start = text;
+        while(*text && *text != '"' && *text != '\\' && (uint8_t)*text >= 0x20) text++;
+        write(start, text - start); // copy the plain characters in one go
+
+        if(!*text) break;
+        char c = *text++;
+        switch(c) {
+            case '"':
+                write("\\\"", 2);
+                break;
+            case '\\':
+                write("\\\\", 2);
+                break;
+            case '\n':
+                write("\\n", 2);
+                break;
+            case '\r':
+                write("\\r", 2);
+                break;
+            case '\t':
+                write("\\t", 2);
+                break;
+            default: {
+                char code[6] = {'\\', 'u', '0', '0', json_hex[(uint8_t)c >> 4], json_hex[c & 0x0f]};
+                write(code, sizeof(code));
+            }
+        }
+    }
+    put('"');
+}
+
+void JsonWriter::write_key(const char* key)
+{
+    if(pos > 1) put(',');
+    write_escaped(key);
+    put(':');
+}
+
+void JsonWriter::add_int(const char* key, int32_t val)
+{
+    write_key(key);
+    write_int(val);
+}
+
+// Adds a string value, or null
+void JsonWriter::add_str(const char* key, const char* text)
+{
+    write_key(key);
+    if(text)
+        write_escaped(text);
+    else
+        write("null", 4);
+}
+
+// Adds a value that is already serialized, or null
+void JsonWriter::add_json(const char* key, const char* json)
+{
+    write_key(key);
+    if(json)
+        write(json, strlen(json));
+    else
+        write("null", 4);
+}
+
+// Adds the color as "#rrggbb" followed by its r, g and b components
+void JsonWriter::add_color(const char* key, lv_color32_t c32)
+{
+    uint8_t rgb[3] = {c32.ch.red, c32.ch.green, c32.ch.blue};
+    char color[9]  = {'"', '#'};
+
+    for(uint8_t i = 0; i < 3; i++) {
+        color[2 + i * 2] = json_hex[rgb[i] >> 4];
+        color[3 + i * 2] = json_hex[rgb[i] & 0x0f];
+    }
+    color[8] = '"';
+
+    write_key(key);
+    write(color, sizeof(color));
+    add_int("r", c32.ch.red);
+    add_int("g", c32.ch.green);
+    add_int("b", c32.ch.blue);
+}
+
+/**
+ * Close the object
+ * @return the zero terminated JSON, valid until the writer goes out of scope, or NULL when out of memory
+ */
+const char* JsonWriter::end()
+{
+    put('}');
+    if(failed) {
+        LOG_ERROR(TAG_MSGR, F(D_ERROR_OUT_OF_MEMORY));
+        return NULL;
+    }
+
+    buffer[pos] = '\0';
+    return buffer;
+}
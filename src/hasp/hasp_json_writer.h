@@ -0,0 +1,39 @@
+/* MIT License - Copyright (c) 2019-2024 Francis Van Roie
+   For full license information read the LICENSE file in the project folder */
+
+#ifndef HASP_JSON_WRITER_H
+#define HASP_JSON_WRITER_H
+
+#include "hasplib.h"
+
+#define HASP_JSON_STATE_SIZE 128 // stack buffer for a state message, longer messages move to the heap
+
+/* Writes a flat JSON object for the state messages, without a JsonDocument or a printf format
+ * The text is escaped while it is copied, the buffer is only replaced by a heap buffer when it is too small */
+class JsonWriter {
+  public:
+    JsonWriter(char* buffer, size_t size);
+    ~JsonWriter();
+
+    void add_int(const char* key, int32_t val);
+    void add_str(const char* key, const char* text);
+    void add_json(const char* key, const char* json);
+    void add_color(const char* key, lv_color32_t c32);
+    const char* end();
+
+  private:
+    char* buffer;
+    size_t size;
+    size_t pos;
+    bool heap;
+    bool failed;
+
+    bool grow(size_t len);
+    void put(char c);
+    void write(const char* text, size_t len);
+    void write_int(int32_t val);
+    void write_escaped(const char* text);
+    void write_key(const char* key);
+};
+
+#endif
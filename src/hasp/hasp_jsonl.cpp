@@ -0,0 +1,366 @@
+/* MIT License - Copyright (c) 2019-2024 Francis Van Roie
+   For full license information read the LICENSE file in the project folder */
+
+/* Streaming jsonl tokenizer
+ *
+ * Objects are tokenized in place: strings are unescaped inside the buffer and terminated,
+ * numbers, literals and nested arrays or objects are passed as their raw json text.
+ * This keeps the memory use bounded to the buffer and avoids a JsonDocument per line.
+ */
+
+#include "hasplib.h"
+#include "hasp_jsonl.h"
+
+static inline bool jsonl_is_space(char c)
+{
+    return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+}
+
+static inline bool jsonl_is_bare(char c)
+{
+    return isalnum((unsigned char)c) || c == '_' || c == '+' || c == '-' || c == '.';
+}
+
+/* Skip whitespace and comments */
+static char* jsonl_skip_space(char* p, char* end)
+{
+    while(p < end) {
+        if(jsonl_is_space(*p)) {
+            p++;
+        } else if(*p == '/' && p + 1 < end && p[1] == '/') {
+            while(p < end && *p != '\n') p++;
+        } else if(*p == '/' && p + 1 < end && p[1] == '*') {
+            for(p += 2; p + 1 < end && !(p[0] == '*' && p[1] == '/'); p++)
+                ;
+            if(p + 1 >= end) return end; // unterminated comment
+            p += 2;
+        } else {
+            break;
+        }
+    }
+    return p;
+}
+
+static bool jsonl_hex4(const char* p, const char* end, uint32_t& value)
+{
+    if(end - p < 4) return false;
+
+    value = 0;
+    for(uint8_t i = 0; i < 4; i++) {
+        char c = p[i];
+        value <<= 4;
+        if(c >= '0' && c <= '9')
+            value |= c - '0';
+        else if(c >= 'a' && c <= 'f')
+            value |= c - 'a' + 10;
+        else if(c >= 'A' && c <= 'F')
+            value |= c - 'A' + 10;
+        else
+            return false;
+    }
+    return true;
+}
+
+static char* jsonl_utf8(char* w, uint32_t cp)
+{
+    if(cp < 0x80) {
+        *w++ = (char)cp;
+    } else if(cp < 0x800) {
+        *w++ = (char)(0xC0 | (cp >> 6));
+        *w++ = (char)(0x80 | (cp & 0x3F));
+    } else if(cp < 0x10000) {
+        *w++ = (char)(0xE0 | (cp >> 12));
+        *w++ = (char)(0x80 | ((cp >> 6) & 0x3F));
+        *w++ = (char)(0x80 | (cp & 0x3F));
+    } else {
+        *w++ = (char)(0xF0 | (cp >> 18));
+        *w++ = (char)(0x80 | ((cp >> 12) & 0x3F));
+        *w++ = (char)(0x80 | ((cp >> 6) & 0x3F));
+        *w++ = (char)(0x80 | (cp & 0x3F));
+    }
+    return w;
+}
+
+/**
+ * Unescape a quoted string in place and terminate it
+ * @param p char*: the opening quote
+ * @param end char*: end of the buffer
+ * @return position after the closing quote, or NULL if the string is not terminated
+ * @note the unescaped text is never longer than the escaped text, so it can be written over it
+ */
+static char* jsonl_parse_string(char* p, char* end)
+{
+    char quote = *p++;
+    char* w    = p;
+
+    while(p < end) {
+        char c = *p++;
+
+        if(c == quote) {
+            *w = '\0';
+            return p;
+        }
+
+        if(c != '\\') {
+            *w++ = c;
+            continue;
+        }
+
+        if(p >= end) return NULL;
+        c = *p++;
+        switch(c) {
+            case 'b':
+                *w++ = '\b';
+                break;
+            case 'f':
+                *w++ = '\f';
+                break;
+            case 'n':
+                *w++ = '\n';
+                break;
+            case 'r':
+                *w++ = '\r';
+                break;
+            case 't':
+                *w++ = '\t';
+                break;
+            case 'u': {
+                uint32_t cp;
+                if(!jsonl_hex4(p, end, cp)) return NULL;
+                p += 4;
+
+                /* Combine a surrogate pair */
+                uint32_t low;
+                if(cp >= 0xD800 && cp <= 0xDBFF && end - p >= 6 && p[0] == '\\' && p[1] == 'u' &&
+                   jsonl_hex4(p + 2, end, low) && low >= 0xDC00 && low <= 0xDFFF) {
+                    cp = 0x10000 + ((cp - 0xD800) << 10) + (low - 0xDC00);
+                    p += 6;
+                }
+                w = jsonl_utf8(w, cp);
+                break;
+            }
+            default: // \" \' \\ \/
+                *w++ = c;
+        }
+    }
+
+    return NULL;
+}
+
+/* Find the end of a number, literal, array or object value */
+static char* jsonl_skip_value(char* p, char* end)
+{
+    if(*p != '{' && *p != '[') {
+        while(p < end && !jsonl_is_space(*p) && *p != ',' && *p != '}' && *p != ']' && *p != '/') p++;
+        return p;
+    }
+
+    uint8_t depth = 0;
+    while(p < end) {
+        char c = *p++;
+        if(c == '"' || c == '\'') {
+            while(p < end && *p != c) {
+                if(*p == '\\') p++;
+                p++;
+            }
+            if(p >= end) return NULL;
+            p++; // closing quote
+        } else if(c == '{' || c == '[') {
+            depth++;
+        } else if(c == '}' || c == ']') {
+            if(--depth == 0) return p;
+        }
+    }
+
+    return NULL;
+}
+
+/**
+ * Tokenize one json object in place
+ * @param json char*: buffer holding the object, it is modified
+ * @param len size_t: length of the object
+ * @param pairs hasp_jsonl_pair_t*: array of HASP_JSONL_MAX_PAIRS to receive the key/value pairs
+ * @param count uint8_t: number of pairs found
+ * @note the pairs point into the json buffer and are only valid as long as the buffer is unchanged
+ */
+hasp_jsonl_result_t hasp_jsonl_parse_object(char* json, size_t len, hasp_jsonl_pair_t* pairs, uint8_t& count)
+{
+    char* end = json + len;
+    char* p   = jsonl_skip_space(json, end);
+
+    count = 0;
+    if(p >= end) return HASP_JSONL_INCOMPLETE;
+    if(*p != '{') return HASP_JSONL_INVALID;
+
+    p = jsonl_skip_space(p + 1, end);
+    if(p < end && *p == '}') return HASP_JSONL_OK;
+
+    while(p < end) {
+        if(count >= HASP_JSONL_MAX_PAIRS) return HASP_JSONL_TOO_LONG;
+
+        /* Key */
+        char* key = p + 1;
+        char* key_end;
+        if(*p == '"' || *p == '\'') {
+            p = jsonl_parse_string(p, end);
+            if(!p) return HASP_JSONL_INCOMPLETE;
+            key_end = NULL; // already terminated
+        } else {
+            key = p;
+            while(p < end && jsonl_is_bare(*p)) p++;
+            if(p == key) return HASP_JSONL_INVALID;
+            key_end = p;
+        }
+
+        p = jsonl_skip_space(p, end);
+        if(p >= end) return HASP_JSONL_INCOMPLETE;
+        if(*p != ':') return HASP_JSONL_INVALID;
+        if(key_end) *key_end = '\0'; // the delimiter has been read
+
+        p = jsonl_skip_space(p + 1, end);
+        if(p >= end) return HASP_JSONL_INCOMPLETE;
+
+        /* Value */
+        char* value = p + 1;
+        char* value_end;
+        if(*p == '"' || *p == '\'') {
+            p = jsonl_parse_string(p, end);
+            if(!p) return HASP_JSONL_INCOMPLETE;
+            value_end = NULL; // already terminated
+        } else {
+            value = p;
+            p     = jsonl_skip_value(p, end);
+            if(!p) return HASP_JSONL_INCOMPLETE;
+            if(p == value) return HASP_JSONL_INVALID;
+            value_end = p;
+        }
+
+        p = jsonl_skip_space(p, end);
+        if(p >= end) return HASP_JSONL_INCOMPLETE;
+        char c = *p;
+        if(value_end) *value_end = '\0'; // the delimiter has been read
+
+        pairs[count].key   = key;
+        pairs[count].value = value;
+        count++;
+
+        if(c == '}') return HASP_JSONL_OK;
+        if(c != ',') return HASP_JSONL_INVALID;
+        p = jsonl_skip_space(p + 1, end);
+    }
+
+    return HASP_JSONL_INCOMPLETE;
+}
+
+const char* hasp_jsonl_result_name(hasp_jsonl_result_t result)
+{
+    switch(result) {
+        case HASP_JSONL_OK:
+            return "Ok";
+        case HASP_JSONL_EMPTY:
+            return "EmptyInput";
+        case HASP_JSONL_INCOMPLETE:
+            return "IncompleteInput";
+        case HASP_JSONL_TOO_LONG:
+            return "TooLong";
+        default:
+            return "InvalidInput";
+    }
+}
+
+size_t JsonlReader::fill()
+{
+    size_t room = size - 1 - len;
+#ifdef ARDUINO
+    size_t read = stream.readBytes(buffer + len, room);
+#else
+    stream.read(buffer + len, room);
+    size_t read = stream.gcount();
+#endif
+    len += read;
+    buffer[len] = '\0';
+    return read;
+}
+
+/**
+ * Read and tokenize the next object of the stream
+ * @param pairs hasp_jsonl_pair_t*: array of HASP_JSONL_MAX_PAIRS to receive the key/value pairs
+ * @param count uint8_t: number of pairs found
+ * @note the pairs are valid until the next call
+ */
+hasp_jsonl_result_t JsonlReader::next(hasp_jsonl_pair_t* pairs, uint8_t& count)
+{
+    /* Move the unparsed data to the start of the buffer */
+    if(pos > 0) {
+        memmove(buffer, buffer + pos, len - pos);
+        len -= pos;
+        offset += pos;
+        pos = 0;
+    }
+
+    size_t i        = 0;        // scan position
+    size_t start    = SIZE_MAX; // opening brace of the object
+    uint8_t depth   = 0;
+    uint8_t comment = 0; // 1 = line comment, 2 = block comment
+    char quote      = 0;
+    bool escape     = false;
+    bool star       = false;
+
+    while(true) {
+        for(; i < len; i++) {
+            char c = buffer[i];
+
+            if(comment == 1) {
+                if(c == '\n') comment = 0;
+            } else if(comment == 2) {
+                if(star && c == '/') comment = 0;
+                star = (c == '*');
+            } else if(quote) {
+                if(escape)
+                    escape = false;
+                else if(c == '\\')
+                    escape = true;
+                else if(c == quote)
+                    quote = 0;
+            } else if(c == '/') {
+                if(i + 1 >= len && !eof) break; // need the next character
+                if(i + 1 < len && buffer[i + 1] == '/') {
+                    comment = 1;
+                } else if(i + 1 < len && buffer[i + 1] == '*') {
+                    comment = 2;
+                    star    = false;
+                    i++;
+                } else {
+                    return HASP_JSONL_INVALID;
+                }
+            } else if(depth == 0) {
+                if(c == '{') {
+                    start = i;
+                    depth = 1;
+                } else if(c == '\0') {
+                    pos = len; // end of a zero terminated stream
+                    eof = true;
+                    return HASP_JSONL_EMPTY;
+                } else if(!jsonl_is_space(c)) {
+                    return HASP_JSONL_INVALID;
+                }
+            } else if(c == '"' || c == '\'') {
+                quote = c;
+            } else if(c == '{' || c == '[') {
+                depth++;
+            } else if(c == '}' || c == ']') {
+                if(--depth == 0) {
+                    pos = i + 1;
+                    return hasp_jsonl_parse_object(buffer + start, pos - start, pairs, count);
+                }
+            }
+        }
+
+        if(eof) {
+            pos = len;
+            return start == SIZE_MAX ? HASP_JSONL_EMPTY : HASP_JSONL_INCOMPLETE;
+        }
+        if(len >= size - 1) return HASP_JSONL_TOO_LONG;
+        if(fill() == 0) eof = true;
+    }
+}
@@ -0,0 +1,74 @@
+/* MIT License - Copyright (c) 2019-2024 Francis Van Roie
+   For full license information read the LICENSE file in the project folder */
+
+#ifndef HASP_JSONL_H
+#define HASP_JSONL_H
+
+#include "hasplib.h"
+
+#ifndef ARDUINO
+#include <istream>
+#endif
+
+#ifndef HASP_JSONL_BUFFER_SIZE
+#define HASP_JSONL_BUFFER_SIZE MQTT_MAX_PACKET_SIZE // longest object that can be read from a stream
+#endif
+
+#ifndef HASP_JSONL_MAX_PAIRS
+#define HASP_JSONL_MAX_PAIRS 64 // maximum number of keys in one object
+#endif
+
+/* A key/value pair pointing into the jsonl buffer */
+struct hasp_jsonl_pair_t
+{
+    const char* key;
+    const char* value; // unescaped string, or the raw text of a number, literal, array or object
+};
+
+enum hasp_jsonl_result_t {
+    HASP_JSONL_OK = 0,     // an object was parsed
+    HASP_JSONL_EMPTY,      // no more objects
+    HASP_JSONL_INVALID,    // syntax error
+    HASP_JSONL_INCOMPLETE, // the input ended inside an object
+    HASP_JSONL_TOO_LONG,   // the object does not fit in the buffer or has too many keys
+};
+
+/* Tokenize one json object in place, the pairs point into the json buffer */
+hasp_jsonl_result_t hasp_jsonl_parse_object(char* json, size_t len, hasp_jsonl_pair_t* pairs, uint8_t& count);
+const char* hasp_jsonl_result_name(hasp_jsonl_result_t result);
+
+/* Reads consecutive json objects from a stream using a single fixed buffer */
+class JsonlReader {
+  public:
+#ifdef ARDUINO
+    JsonlReader(Stream& stream, char* buffer, size_t size) : stream(stream), buffer(buffer), size(size)
+#else
+    JsonlReader(std::istream& stream, char* buffer, size_t size) : stream(stream), buffer(buffer), size(size)
+#endif
+    {}
+
+    hasp_jsonl_result_t next(hasp_jsonl_pair_t* pairs, uint8_t& count);
+
+    /* Number of bytes of the stream consumed by the objects returned so far */
+    size_t position() const
+    {
+        return offset + pos;
+    }
+
+  private:
+#ifdef ARDUINO
+    Stream& stream;
+#else
+    std::istream& stream;
+#endif
+    char* buffer;
+    size_t size;
+    size_t len    = 0; // valid bytes in the buffer
+    size_t pos    = 0; // start of the unparsed data
+    size_t offset = 0; // stream position of the start of the buffer
+    bool eof      = false;
+
+    size_t fill();
+};
+
+#endif
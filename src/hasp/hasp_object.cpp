@@ -16,6 +16,160 @@
 const char** btnmatrix_default_map;            // memory pointer to lvgl default btnmatrix map
 const char* msgbox_default_map[] = {"OK", ""}; // memory pointer to hasp default msgbox map
 
+// ##################### Object Index ##########################################################
+
+/* Direct lookup tables from (pageid, objid) to lv_obj_t*, one table of 256 pointers per page.
+ * Slot 0 is lv_layer_top, slots 1..HASP_NUM_PAGES are the pages and the last slot is lv_layer_sys.
+ * Tables are allocated on first use and entries are removed again by the delete_event_handler.
+ */
+#define HASP_OBJECT_INDEX_SLOTS (HASP_NUM_PAGES + 2)
+
+static lv_obj_t** object_index[HASP_OBJECT_INDEX_SLOTS];
+
+static inline bool object_index_slot(uint8_t pageid, uint8_t& slot)
+{
+    if(pageid == 255) {
+        slot = HASP_OBJECT_INDEX_SLOTS - 1;
+        return true;
+    }
+    slot = pageid;
+    return pageid <= HASP_NUM_PAGES;
+}
+
+static inline lv_obj_t* object_index_get(uint8_t pageid, uint8_t objid)
+{
+    uint8_t slot;
+    if(!object_index_slot(pageid, slot) || !object_index[slot]) return NULL;
+
+    lv_obj_t* obj = object_index[slot][objid];
+    if(obj && obj->user_data.id == objid) return obj;
+    return NULL;
+}
+
+static void object_index_set(uint8_t pageid, uint8_t objid, lv_obj_t* obj)
+{
+    uint8_t slot;
+    if(objid == 0 || !object_index_slot(pageid, slot)) return;
+
+    if(!object_index[slot]) {
+        object_index[slot] = (lv_obj_t**)hasp_calloc(256, sizeof(lv_obj_t*));
+        if(!object_index[slot]) return; // the tree walk will still find the object
+    }
+
+    /* Keep the first object with a duplicate id, like the tree walk does */
+    if(!object_index[slot][objid]) object_index[slot][objid] = obj;
+}
+
+// Register an object in the index of its page
+void object_index_add(uint8_t pageid, lv_obj_t* obj)
+{
+    if(obj) object_index_set(pageid, obj->user_data.id, obj);
+}
+
+// Remove an object from the index, called when it is deleted or its id changes
+void object_index_remove(const lv_obj_t* obj)
+{
+    uint8_t pageid;
+    uint8_t slot;
+    if(!obj || obj->user_data.id == 0) return;
+    if(!haspPages.get_id(obj, &pageid) || !object_index_slot(pageid, slot) || !object_index[slot]) return;
+
+    if(object_index[slot][obj->user_data.id] == obj) object_index[slot][obj->user_data.id] = NULL;
+}
+
+// Drop all entries of a page, called before the page objects are cleaned or replaced
+void object_index_clear(uint8_t pageid)
+{
+    uint8_t slot;
+    object_group_clear(pageid);
+    if(!object_index_slot(pageid, slot) || !object_index[slot]) return;
+
+    hasp_free(object_index[slot]);
+    object_index[slot] = NULL;
+}
+
+// ##################### Group Index ###########################################################
+
+/* The objects with a groupid, sorted by group so the members of a group are next to each other.
+ * Entries are added when the groupid is set and removed by the delete_event_handler or when the page is cleared.
+ */
+typedef struct
+{
+    lv_obj_t* obj;
+    uint8_t group;
+    uint8_t pageid;
+} object_group_member_t;
+
+static object_group_member_t* object_groups;
+static uint16_t object_group_count;
+static uint16_t object_group_size;
+
+// Position of the first member of the group, or where it would be inserted
+static uint16_t object_group_first(uint16_t group)
+{
+    uint16_t low  = 0;
+    uint16_t high = object_group_count;
+    while(low < high) {
+        uint16_t mid = (low + high) / 2;
+        if(object_groups[mid].group < group)
+            low = mid + 1;
+        else
+            high = mid;
+    }
+    return low;
+}
+
+// Add an object to the members of its group, called after the groupid is set
+void object_group_add(lv_obj_t* obj)
+{
+    uint8_t pageid;
+    if(!obj || obj->user_data.groupid == 0 || !haspPages.get_id(obj, &pageid)) return;
+
+    if(object_group_count == object_group_size) {
+        uint16_t size                 = object_group_size ? object_group_size * 2 : 16;
+        object_group_member_t* groups = (object_group_member_t*)hasp_realloc(object_groups, size * sizeof(*groups));
+        if(!groups) {
+            LOG_ERROR(TAG_HASP, F(D_ERROR_OUT_OF_MEMORY));
+            return;
+        }
+        object_groups     = groups;
+        object_group_size = size;
+    }
+
+    /* Insert after the existing members, so they are updated in the order they were added */
+    uint16_t pos = object_group_first(obj->user_data.groupid + 1);
+    memmove(&object_groups[pos + 1], &object_groups[pos], (object_group_count - pos) * sizeof(*object_groups));
+    object_groups[pos].obj    = obj;
+    object_groups[pos].group  = obj->user_data.groupid;
+    object_groups[pos].pageid = pageid;
+    object_group_count++;
+}
+
+// Remove an object from the members of its group, called when it is deleted or its groupid changes
+void object_group_remove(const lv_obj_t* obj)
+{
+    if(!obj || obj->user_data.groupid == 0) return;
+
+    for(uint16_t i = object_group_first(obj->user_data.groupid);
+        i < object_group_count && object_groups[i].group == obj->user_data.groupid; i++) {
+        if(object_groups[i].obj == obj) {
+            object_group_count--;
+            memmove(&object_groups[i], &object_groups[i + 1], (object_group_count - i) * sizeof(*object_groups));
+            return;
+        }
+    }
+}
+
+// Drop the members on a page, called before the page objects are cleaned or replaced
+void object_group_clear(uint8_t pageid)
+{
+    uint16_t kept = 0;
+    for(uint16_t i = 0; i < object_group_count; i++) {
+        if(object_groups[i].pageid != pageid) object_groups[kept++] = object_groups[i];
+    }
+    object_group_count = kept;
+}
+
 // ##################### Object Finders ########################################################
 
 // Return a child object from a parent with a specific objid
@@ -56,7 +210,16 @@ lv_obj_t* hasp_find_obj_from_parent_id(lv_obj_t* parent, uint8_t objid)
 // Return the object with a specific pageid and objid
 lv_obj_t* hasp_find_obj_from_page_id(uint8_t pageid, uint8_t objid)
 {
-    return hasp_find_obj_from_parent_id(haspPages.get_obj(pageid), objid);
+    lv_obj_t* page = haspPages.get_obj(pageid);
+    if(objid == 0 || page == nullptr) return page;
+
+    lv_obj_t* obj = object_index_get(pageid, objid);
+    if(obj) return obj;
+
+    /* Not indexed yet, walk the tree and remember the result */
+    obj = hasp_find_obj_from_parent_id(page, objid);
+    if(obj) object_index_set(pageid, objid, obj);
+    return obj;
 }
 
 // Return the pageid and objid of an object
@@ -115,56 +278,65 @@ void object_dispatch_state(uint8_t pageid, uint8_t btnid, const char* payload)
         snprintf_P(topic, sizeof(topic), PSTR("%s.b%u"), pagename, btnid);
     else
         snprintf_P(topic, sizeof(topic), PSTR(HASP_OBJECT_NOTATION), pageid, btnid);
-    dispatch_state_subtopic(topic, payload);
+    dispatch_state_object(topic, payload);
 }
 
 // ##################### State Changers ########################################################
 
-// Recursive function that goes over all objects only ONCE
-void object_set_group_values(lv_obj_t* parent, hasp_update_value_t& value)
+// SHOULD only by called from DISPATCH
+void object_set_normalized_group_values(hasp_update_value_t& value)
 {
-    if(parent == nullptr) return;
+    if(value.group == 0 || value.min == value.max) return;
 
-    // Update object if it's in the same group
-    if(value.group == parent->user_data.groupid && value.obj != parent) {
-        attribute_set_normalized_value(parent, value);
+    uint8_t page   = haspPages.get();
+    uint16_t first = object_group_first(value.group);
+    uint16_t last  = first;
+    while(last < object_group_count && object_groups[last].group == value.group) last++;
+
+    for(uint16_t i = first; i < last; i++) { // Update visible objects first
+        if(object_groups[i].pageid == page && object_groups[i].obj != value.obj)
+            attribute_set_normalized_value(object_groups[i].obj, value);
     }
 
-    /* check tabs */
-    if(obj_get_type(parent) == LV_HASP_TABVIEW) {
-        uint16_t tabcount = lv_tabview_get_tab_count(parent);
-        for(uint16_t i = 0; i < tabcount; i++) {
-            lv_obj_t* tab = lv_tabview_get_tab(parent, i);
-            object_set_group_values(tab, value);
-        }
-    } else {
-        lv_obj_t* child;
-        child = lv_obj_get_child(parent, NULL);
-        while(child) {
-            object_set_group_values(child, value);
-            child = lv_obj_get_child(parent, child);
+    for(uint16_t i = first; i < last; i++) {
+        if(object_groups[i].pageid != page && object_groups[i].obj != value.obj) {
+            attribute_set_normalized_value(object_groups[i].obj, value);
+#if HASP_USE_LAZY_PAGES > 0
+            haspPages.changed(object_groups[i].pageid);
+#endif
         }
     }
+
+#if HASP_USE_LAZY_PAGES > 0
+    /* Members on pages that are not built are not indexed, the value is set when the page is built */
+    for(uint8_t pageid = PAGE_START_INDEX; pageid <= HASP_NUM_PAGES; pageid++) {
+        if(!haspPages.is_resident(pageid) && haspPages.has_group(pageid, value.group))
+            haspPages.defer_group(pageid, value);
+    }
+#endif
 }
 
-// SHOULD only by called from DISPATCH
-void object_set_normalized_group_values(hasp_update_value_t& value)
+#if HASP_USE_LAZY_PAGES > 0
+// Set the members of the group on one page, after the page was built
+void object_set_page_group_values(uint8_t pageid, hasp_update_value_t& value)
 {
-    if(value.group == 0 || value.min == value.max) return;
-
-    uint8_t page = haspPages.get();
-    object_set_group_values(haspPages.get_obj(page), value); // Update visible objects first
-
-    for(uint8_t i = 0; i < HASP_NUM_PAGES; i++) {
-        if(i != page) object_set_group_values(haspPages.get_obj(i), value);
+    uint16_t first = object_group_first(value.group);
+    for(uint16_t i = first; i < object_group_count && object_groups[i].group == value.group; i++) {
+        if(object_groups[i].pageid == pageid) attribute_set_normalized_value(object_groups[i].obj, value);
     }
 }
+#endif
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 
 // Used in the dispatcher
 void hasp_process_attribute(uint8_t pageid, uint8_t objid, const char* attr, const char* payload, bool update)
 {
+#if HASP_USE_LAZY_PAGES > 0
+    if(update && haspPages.defer(pageid, objid, attr, payload)) return; // applied when the page is built
+    if(!update) haspPages.load(pageid);                                  // the value is read from the object
+#endif
+
     if(lv_obj_t* obj = hasp_find_obj_from_page_id(pageid, objid)) {
         hasp_process_obj_attribute(obj, attr, payload, update); // || strlen(payload) > 0);
     } else {
@@ -182,25 +354,23 @@ int hasp_parse_json_attributes(lv_obj_t* obj, const JsonObject& doc)
 #if HASP_TARGET_PC || defined(ESP32)
     std::string v;
     v.reserve(64);
-
-    for(JsonPair keyValue : doc) {
-        // LOG_VERBOSE(TAG_HASP, F(D_BULLET "%s=%s"), keyValue.key().c_str(),
-        // keyValue.value().as<std::string>().c_str());
-        v = keyValue.value().as<std::string>();
-        hasp_process_obj_attribute(obj, keyValue.key().c_str(), keyValue.value().as<std::string>().c_str(), true);
-        i++;
-    }
 #else
     String v((char*)0);
     v.reserve(64);
+#endif
 
     for(JsonPair keyValue : doc) {
-        // LOG_DEBUG(TAG_HASP, F(D_BULLET "%s=%s"), keyValue.key().c_str(), keyValue.value().as<String>().c_str());
-        v = keyValue.value().as<String>();
-        hasp_process_obj_attribute(obj, keyValue.key().c_str(), keyValue.value().as<String>().c_str(), true);
+        JsonVariant value = keyValue.value();
+        // LOG_VERBOSE(TAG_HASP, F(D_BULLET "%s=%s"), keyValue.key().c_str(), value.as<std::string>().c_str());
+        if(value.is<const char*>()) {
+            hasp_process_obj_attribute(obj, keyValue.key().c_str(), value.as<const char*>(), true);
+        } else {
+            v = ""; // reuse the reserved buffer
+            serializeJson(value, v);
+            hasp_process_obj_attribute(obj, keyValue.key().c_str(), v.c_str(), true);
+        }
         i++;
     }
-#endif
     // LOG_DEBUG(TAG_HASP, F("%d keys processed"), i);
     return i;
 }
@@ -220,62 +390,57 @@ static void object_add_task(lv_obj_t* obj, lv_task_cb_t task_xcb, uint16_t inter
 }
 
 /**
- * Create a new object according to the json config
- * @param config Json representation for this object
- * @param saved_page_id the pageid to use when no pageid is specified in the Json, updated when it is specified so
+ * Find the object of the header or create it if it does not exist
+ * @param header the page, parent, id and type of the object
+ * @param saved_page_id the pageid to use when no pageid is specified, updated when it is specified so
  * following objects in the file can share the pageid
+ * @param created set to true when a new object was created
+ * @return the object, or NULL if it was not found and could not be created
  */
-void hasp_new_object(const JsonObject& config, uint8_t& saved_page_id)
+lv_obj_t* hasp_find_or_create_obj(const hasp_object_header_t& header, uint8_t& saved_page_id, bool& created)
 {
-    /* Skip line detection */
-    if(!config[FPSTR(FP_SKIP)].isNull() && config[FPSTR(FP_SKIP)].as<bool>()) return;
-
     /* Page selection */
-    uint8_t pageid = saved_page_id;
-    if(!config[FPSTR(FP_PAGE)].isNull()) {
-        pageid = config[FPSTR(FP_PAGE)].as<uint8_t>();
-        config.remove(FPSTR(FP_PAGE));
-    }
+    uint8_t pageid = header.has_page ? header.pageid : saved_page_id;
 
     /* Page with pageid is the default parent_obj */
     lv_obj_t* parent_obj = haspPages.get_obj(pageid);
     if(!parent_obj) {
         LOG_WARNING(TAG_HASP, F(D_OBJECT_PAGE_UNKNOWN), pageid);
-        return;
+        return NULL;
     } else {
         saved_page_id = pageid; /* save the current pageid for next objects */
     }
 
     /* A custom parentid was set */
-    if(!config[FPSTR(FP_PARENTID)].isNull()) {
-        uint8_t parentid = config[FPSTR(FP_PARENTID)].as<uint8_t>();
-        parent_obj       = hasp_find_obj_from_parent_id(parent_obj, parentid);
+    bool custom_parent = header.has_parentid;
+    if(custom_parent) {
+        uint8_t parentid = header.parentid;
+        parent_obj       = hasp_find_obj_from_page_id(pageid, parentid);
         if(!parent_obj) {
             LOG_WARNING(TAG_HASP, F("Parent ID " HASP_OBJECT_NOTATION " not found, skipping..."), pageid, parentid);
-            return;
+            return NULL;
         } else {
             LOG_VERBOSE(TAG_HASP, F("Parent ID " HASP_OBJECT_NOTATION " found"), pageid, parentid);
         }
-        config.remove(FPSTR(FP_PARENTID));
     }
 
     uint16_t sdbm = 0;
-    uint8_t id    = config[FPSTR(FP_ID)].as<uint8_t>();
-    config.remove(FPSTR(FP_ID));
+    uint8_t id    = header.id;
 
     /* Create the object if it does not exist */
-    lv_obj_t* obj = hasp_find_obj_from_parent_id(parent_obj, id);
+    lv_obj_t* obj =
+        custom_parent ? hasp_find_obj_from_parent_id(parent_obj, id) : hasp_find_obj_from_page_id(pageid, id);
     if(!obj) {
 
         /* Create the object first */
 
         /* Validate type */
        // if(config[FPSTR(FP_OBJID)].isNull()) { // TODO: obsolete objid
-            if(config[FPSTR(FP_OBJ)].isNull()) {
-                return; // comments
+            if(!header.has_obj) {
+                return NULL; // comments
             } else {
-                sdbm = Parser::get_sdbm(config[FPSTR(FP_OBJ)].as<const char*>());
-                config.remove(FPSTR(FP_OBJ));
+                sdbm    = header.obj;
+                created = true;
             }
         // } else {
         //     LOG_WARNING(TAG_HASP, F(D_ATTRIBUTE_OBSOLETE D_ATTRIBUTE_INSTEAD), "objid",
@@ -501,7 +666,7 @@ void hasp_new_object(const JsonObject& config, uint8_t& saved_page_id)
                     }
                 } else {
                     LOG_WARNING(TAG_HASP, F("Parent of a tab must be a tabview object"));
-                    return;
+                    return NULL;
                 }
                 break;
 
@@ -700,7 +865,7 @@ void hasp_new_object(const JsonObject& config, uint8_t& saved_page_id)
         /* No object was actually created */
         if(!obj) {
             LOG_ERROR(TAG_HASP, F(D_OBJECT_CREATE_FAILED), id);
-            return;
+            return NULL;
         }
 
         // Prevent losing press when the press is slid out of the objects.
@@ -709,8 +874,12 @@ void hasp_new_object(const JsonObject& config, uint8_t& saved_page_id)
         lv_obj_set_gesture_parent(obj, false);
         lv_obj_set_click(obj, true);
 
+        /* Objects without an event handler still need their resources and index entry cleaned up */
+        if(!lv_obj_get_event_cb(obj)) lv_obj_set_event_cb(obj, delete_event_handler);
+
         /* id tag the object */
         obj->user_data.id = id;
+        object_index_add(pageid, obj);
 
 #ifdef HASP_DEBUG
         uint8_t temp; // needed for debug tests
@@ -718,7 +887,7 @@ void hasp_new_object(const JsonObject& config, uint8_t& saved_page_id)
         /** testing start **/
         if(!hasp_find_id_from_obj(obj, &pageid, &temp)) {
             LOG_ERROR(TAG_HASP, F(D_OBJECT_LOST));
-            return;
+            return NULL;
         }
 #endif
 
@@ -730,7 +899,7 @@ void hasp_new_object(const JsonObject& config, uint8_t& saved_page_id)
         lv_obj_t* test = hasp_find_obj_from_page_id(pageid, (uint8_t)temp);
         if(test != obj || temp != id) {
             LOG_ERROR(TAG_HASP, F(D_OBJECT_MISMATCH));
-            return;
+            return NULL;
         } else {
             // object created successfully
         }
@@ -740,5 +909,166 @@ void hasp_new_object(const JsonObject& config, uint8_t& saved_page_id)
         // object already exists
     }
 
+    return obj;
+}
+
+#if HASP_USE_LAZY_PAGES > 0
+/**
+ * Keep the changes to an object on a page that is built on demand
+ * @return true if the page is not built, the object is created when it is
+ */
+static bool object_defer(const hasp_object_header_t& header, const hasp_jsonl_pair_t* pairs, uint8_t count,
+                         uint8_t& saved_page_id)
+{
+    uint8_t pageid = header.has_page ? header.pageid : saved_page_id;
+    bool deferred  = false;
+
+    for(uint8_t i = 0; i < count; i++) {
+        const char* key = pairs[i].key;
+        if(!strcmp_P(key, FP_PAGE) || !strcmp_P(key, FP_ID) || !strcmp_P(key, FP_SKIP)) continue;
+        deferred = haspPages.defer(pageid, header.id, key, pairs[i].value);
+    }
+
+    if(deferred) saved_page_id = pageid;
+    return deferred;
+}
+
+static bool object_defer(const hasp_object_header_t& header, const JsonObject& config, uint8_t& saved_page_id)
+{
+    uint8_t pageid = header.has_page ? header.pageid : saved_page_id;
+    bool deferred  = false;
+
+#if HASP_TARGET_PC || defined(ESP32)
+    std::string v;
+#else
+    String v((char*)0);
+#endif
+
+    if(header.has_parentid) {
+        char key[sizeof(FP_PARENTID)];
+        char parentid[4];
+        strcpy_P(key, FP_PARENTID);
+        snprintf_P(parentid, sizeof(parentid), PSTR("%u"), header.parentid);
+        deferred = haspPages.defer(pageid, header.id, key, parentid);
+    }
+
+    for(JsonPair keyValue : config) {
+        JsonVariant value = keyValue.value();
+        if(!strcmp_P(keyValue.key().c_str(), FP_SKIP)) continue;
+        if(value.is<const char*>()) {
+            deferred = haspPages.defer(pageid, header.id, keyValue.key().c_str(), value.as<const char*>());
+        } else {
+            v = "";
+            serializeJson(value, v);
+            deferred = haspPages.defer(pageid, header.id, keyValue.key().c_str(), v.c_str());
+        }
+    }
+
+    if(deferred) saved_page_id = pageid;
+    return deferred;
+}
+#endif
+
+/**
+ * Create a new object according to the json config
+ * @param config Json representation for this object
+ * @param saved_page_id the pageid to use when no pageid is specified in the Json, updated when it is specified so
+ * following objects in the file can share the pageid
+ */
+void hasp_new_object(const JsonObject& config, uint8_t& saved_page_id)
+{
+    /* Skip line detection */
+    if(!config[FPSTR(FP_SKIP)].isNull() && config[FPSTR(FP_SKIP)].as<bool>()) return;
+
+    hasp_object_header_t header = {};
+    if(!config[FPSTR(FP_PAGE)].isNull()) {
+        header.has_page = true;
+        header.pageid   = config[FPSTR(FP_PAGE)].as<uint8_t>();
+        config.remove(FPSTR(FP_PAGE));
+    }
+    if(!config[FPSTR(FP_PARENTID)].isNull()) {
+        header.has_parentid = true;
+        header.parentid     = config[FPSTR(FP_PARENTID)].as<uint8_t>();
+        config.remove(FPSTR(FP_PARENTID));
+    }
+    header.id = config[FPSTR(FP_ID)].as<uint8_t>();
+    config.remove(FPSTR(FP_ID));
+    const char* type = config[FPSTR(FP_OBJ)].as<const char*>();
+    if(type) {
+        header.has_obj = true;
+        header.obj     = Parser::get_sdbm(type);
+    }
+
+#if HASP_USE_LAZY_PAGES > 0
+    if(object_defer(header, config, saved_page_id)) return;
+#endif
+
+    bool created  = false;
+    lv_obj_t* obj = hasp_find_or_create_obj(header, saved_page_id, created);
+    if(!obj) return;
+
+    if(created) config.remove(FPSTR(FP_OBJ));
     hasp_parse_json_attributes(obj, config);
 }
+
+/**
+ * Create a new object from the key/value pairs of a jsonl line
+ * @param pairs the tokenized keys and values of this object
+ * @param count number of pairs
+ * @param saved_page_id the pageid to use when no pageid is specified in the line, updated when it is specified so
+ * following objects in the file can share the pageid
+ */
+void hasp_new_object(const hasp_jsonl_pair_t* pairs, uint8_t count, uint8_t& saved_page_id)
+{
+    hasp_object_header_t header = {};
+    if(!hasp_object_header_from_pairs(pairs, count, header)) return;
+
+#if HASP_USE_LAZY_PAGES > 0
+    if(object_defer(header, pairs, count, saved_page_id)) return;
+#endif
+
+    bool created  = false;
+    lv_obj_t* obj = hasp_find_or_create_obj(header, saved_page_id, created);
+    if(!obj) return;
+
+    for(uint8_t i = 0; i < count; i++) {
+        const char* key = pairs[i].key;
+        if(hasp_object_is_header_key(key) || (created && !strcmp_P(key, FP_OBJ))) continue;
+        hasp_process_obj_attribute(obj, key, pairs[i].value, true);
+    }
+}
+
+/**
+ * Collect the keys that select or create an object from the key/value pairs of a jsonl line
+ * @param pairs the tokenized keys and values of this object
+ * @param count number of pairs
+ * @param header receives the page, parent, id and type of the object
+ * @return false if the line has to be skipped
+ */
+bool hasp_object_header_from_pairs(const hasp_jsonl_pair_t* pairs, uint8_t count, hasp_object_header_t& header)
+{
+    for(uint8_t i = 0; i < count; i++) {
+        const char* key = pairs[i].key;
+        if(!strcmp_P(key, FP_SKIP)) {
+            if(Parser::is_true(pairs[i].value)) return false; /* Skip line detection */
+        } else if(!strcmp_P(key, FP_PAGE)) {
+            header.has_page = true;
+            header.pageid   = atoi(pairs[i].value);
+        } else if(!strcmp_P(key, FP_PARENTID)) {
+            header.has_parentid = true;
+            header.parentid     = atoi(pairs[i].value);
+        } else if(!strcmp_P(key, FP_ID)) {
+            header.id = atoi(pairs[i].value);
+        } else if(!strcmp_P(key, FP_OBJ)) {
+            header.has_obj = true;
+            header.obj     = Parser::get_sdbm(pairs[i].value);
+        }
+    }
+    return true;
+}
+
+/* The page, parentid and id keys are consumed by the header and are never passed on as attributes */
+bool hasp_object_is_header_key(const char* key)
+{
+    return !strcmp_P(key, FP_PAGE) || !strcmp_P(key, FP_PARENTID) || !strcmp_P(key, FP_ID);
+}
@@ -5,6 +5,7 @@
 #define HASP_OBJECT_H
 
 #include "hasplib.h"
+#include "hasp_jsonl.h"
 
 const char FP_SKIP[] PROGMEM     = "skip";
 const char FP_PAGE[] PROGMEM     = "page";
@@ -14,11 +15,21 @@ const char FP_OBJ[] PROGMEM      = "obj";
 const char FP_PARENTID[] PROGMEM = "parentid";
 const char FP_GROUPID[] PROGMEM  = "groupid";
 
+/* A loaded font in a style of the object */
+typedef struct
+{
+    lv_font_t* font;
+    lv_style_property_t prop; // text or value font with the state
+    uint8_t part;
+} hasp_font_slot_t;
+
 typedef struct
 {
     char* action;
     char* tag;
     const char* swipe;
+    hasp_font_slot_t* fonts; // loaded fonts set in a style of the object
+    uint8_t font_count;      // each slot in the list counts as one user of its font
 } hasp_ext_user_data_t;
 
 typedef struct
@@ -28,6 +39,18 @@ typedef struct
     uint16_t interval;
 } hasp_task_user_data_t;
 
+/* The keys that select or create an object, all other keys are attributes */
+struct hasp_object_header_t
+{
+    bool has_page;
+    bool has_parentid;
+    bool has_obj;
+    uint8_t pageid;
+    uint8_t parentid;
+    uint8_t id;
+    uint16_t obj; // sdbm hash of the object type
+};
+
 typedef struct
 {
     lv_obj_t* obj;
@@ -95,6 +118,17 @@ enum lv_hasp_obj_type_t {
 };
 
 void hasp_new_object(const JsonObject& config, uint8_t& saved_page_id);
+void hasp_new_object(const hasp_jsonl_pair_t* pairs, uint8_t count, uint8_t& saved_page_id);
+bool hasp_object_header_from_pairs(const hasp_jsonl_pair_t* pairs, uint8_t count, hasp_object_header_t& header);
+bool hasp_object_is_header_key(const char* key);
+lv_obj_t* hasp_find_or_create_obj(const hasp_object_header_t& header, uint8_t& saved_page_id, bool& created);
+
+void object_index_add(uint8_t pageid, lv_obj_t* obj);
+void object_index_remove(const lv_obj_t* obj);
+void object_index_clear(uint8_t pageid);
+void object_group_add(lv_obj_t* obj);
+void object_group_remove(const lv_obj_t* obj);
+void object_group_clear(uint8_t pageid);
 
 lv_obj_t* hasp_find_obj_from_parent_id(lv_obj_t* parent, uint8_t objid);
 lv_obj_t* hasp_find_obj_from_page_id(uint8_t pageid, uint8_t objid);
@@ -108,6 +142,9 @@ void hasp_process_attribute(uint8_t pageid, uint8_t objid, const char* attr, con
 int hasp_parse_json_attributes(lv_obj_t* obj, const JsonObject& doc);
 
 void object_set_normalized_group_values(hasp_update_value_t& value);
+#if HASP_USE_LAZY_PAGES > 0
+void object_set_page_group_values(uint8_t pageid, hasp_update_value_t& value);
+#endif
 
 /**
  * Get the hasp object type of a given LVGL object
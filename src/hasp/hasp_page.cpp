@@ -42,6 +42,7 @@ void Page::swap(lv_obj_t* page, uint8_t id)
     }
 
     // Swap page objects
+    object_index_clear(id + PAGE_START_INDEX);
     lv_obj_t* prev_page_obj     = _pages[id];
     _pages[id]                  = page;
     _pages[id]->user_data.objid = LV_HASP_SCREEN;
@@ -77,6 +78,15 @@ void Page::init(uint8_t start_page)
 
         set_name(i, NULL);
     }
+
+#if HASP_USE_LAZY_PAGES > 0
+    for(uint8_t i = 0; i < count(); i++) {
+        free_definition(i + PAGE_START_INDEX);
+        _last_used[i] = 0;
+    }
+    hasp_free(_pagesfile);
+    _pagesfile = NULL;
+#endif
 }
 
 void Page::clear(uint8_t pageid)
@@ -84,7 +94,11 @@ void Page::clear(uint8_t pageid)
     lv_obj_t* page = get_obj(pageid);
     if(page == lv_layer_top() || is_valid(pageid)) {
         LOG_TRACE(TAG_HASP, F(D_HASP_CLEAR_PAGE), pageid);
+        object_index_clear(pageid);
         lv_obj_clean(page);
+#if HASP_USE_LAZY_PAGES > 0
+        if(is_lazy(pageid)) free_definition(pageid); // don't rebuild the cleared objects
+#endif
     } else {
         LOG_WARNING(TAG_HASP, F(D_HASP_INVALID_LAYER)); // lv_layer_sys
     }
@@ -94,18 +108,29 @@ void Page::set(uint8_t pageid, lv_scr_load_anim_t anim_type, uint32_t time, uint
 {
     if(!is_valid(pageid)) return; // produces a log warning if not between 1 and 12
 
+#if HASP_USE_LAZY_PAGES > 0
+    load(pageid);
+#endif
+
     lv_obj_t* page = get_obj(pageid);
     if(!page) {
         // Invalid page object
         LOG_WARNING(TAG_HASP, F(D_HASP_INVALID_PAGE), pageid);
+        return;
+    }
 
-    } else if(page == lv_scr_act()) {
+    clock_refresh(page); // the template labels are only updated while their page is visible
+
+    if(page == lv_scr_act()) {
         // No change needed, just send current page again
         _current_page = pageid;
         dispatch_current_page();
 
     } else if((anim_type != LV_SCR_LOAD_ANIM_NONE && time > 0) || delay > 0) {
         // Change page after a delay or animation, don't publish it yet
+#if HASP_IMAGE_DECODE_CACHE > 0 && LV_USE_FILESYSTEM > 0
+        image_cache_prefetch(page); // decode the images now instead of during the animation
+#endif
         my_scr_load_anim(page, anim_type, time, delay, false); // dispatches when animation ends
 
     } else {
@@ -118,6 +143,10 @@ void Page::set(uint8_t pageid, lv_scr_load_anim_t anim_type, uint32_t time, uint
         hasp_object_tree(page, pageid, 0);
 #endif
     }
+
+#if HASP_IMAGE_DECODE_CACHE > 0 && LV_USE_FILESYSTEM > 0
+    image_cache_pin_page(pageid);
+#endif
 }
 
 uint8_t Page::get_next(uint8_t pageid)
@@ -222,16 +251,31 @@ void Page::load_jsonl(const char* pagesfile)
 
     LOG_TRACE(TAG_HASP, F(D_FILE_LOADING), pagesfile);
 
+#if HASP_USE_PAGE_CACHE > 0 && HASP_USE_LAZY_PAGES == 0
+    if(dispatch_parse_pagecache(pagesfile, savedPage)) {
+        LOG_INFO(TAG_HASP, F(D_FILE_LOADED), pagesfile);
+        return;
+    }
+#endif
+
     File file = HASP_FS.open(pagesfile, "r");
     if(!file) {
         LOG_ERROR(TAG_HASP, F(D_FILE_LOAD_FAILED), pagesfile);
         return;
     }
+#if HASP_USE_LAZY_PAGES > 0
+    scan_jsonl(file, pagesfile, savedPage);
+#else
     dispatch_parse_jsonl(file, savedPage);
+#endif
     file.close();
 
     LOG_INFO(TAG_HASP, F(D_FILE_LOADED), pagesfile);
 
+#if HASP_USE_PAGE_CACHE > 0 && HASP_USE_LAZY_PAGES == 0
+    hasp_pagecache_compile(pagesfile); // the compiled copy is used from the next load
+#endif
+
 #elif HASP_USE_EEPROM > 0
     LOG_TRACE(TAG_HASP, F("Loading jsonl from EEPROM..."));
     EepromStream eepromStream(4096, 1024);
@@ -315,6 +359,429 @@ bool Page::get_id(const lv_obj_t* obj, uint8_t* pageid)
     return false;
 }
 
+#if HASP_USE_LAZY_PAGES > 0
+
+/* Pages 1 to HASP_NUM_PAGES are built on demand when they were loaded from a pages file */
+bool Page::is_lazy(uint8_t pageid)
+{
+    return _pagesfile && pageid >= PAGE_START_INDEX && pageid <= HASP_NUM_PAGES;
+}
+
+bool Page::is_resident(uint8_t pageid)
+{
+    return !is_lazy(pageid) || _last_used[pageid - PAGE_START_INDEX] != 0;
+}
+
+/* True if an object of a page that is built on demand is in the group, whether the page is built or not */
+bool Page::has_group(uint8_t pageid, uint8_t groupid)
+{
+    return is_lazy(pageid) && groupid > 0 && groupid < 16 && (_groups[pageid - PAGE_START_INDEX] & (1 << groupid));
+}
+
+/* Build the page if it is not resident and mark it as the most recently used */
+void Page::load(uint8_t pageid)
+{
+    if(_building || !is_lazy(pageid)) return;
+
+    if(!is_resident(pageid)) build(pageid);
+    _last_used[pageid - PAGE_START_INDEX] = ++_use_count;
+}
+
+/* Object values of the page were changed by touch or a group, keep them when the page is evicted */
+void Page::changed(uint8_t pageid)
+{
+    if(is_lazy(pageid)) _changed[pageid - PAGE_START_INDEX] = true;
+}
+
+/**
+ * Index the objects of each page in the pages file, so the page can be built when it is shown
+ * @param file the opened pages file
+ * @param pagesfile the name of the pages file, to reopen it when a page is built
+ * @param saved_page_id the pageid to use when no pageid is specified
+ * @note objects on page 0 and the system layer are created right away
+ */
+void Page::scan_jsonl(File& file, const char* pagesfile, uint8_t& saved_page_id)
+{
+    for(uint8_t i = 0; i < count(); i++) free_definition(i + PAGE_START_INDEX);
+    hasp_free(_pagesfile);
+
+    char* buffer = (char*)hasp_malloc(HASP_JSONL_BUFFER_SIZE);
+    _pagesfile   = (char*)hasp_malloc(strlen(pagesfile) + 1);
+    if(!buffer || !_pagesfile) {
+        LOG_ERROR(TAG_HASP, F(D_ERROR_OUT_OF_MEMORY));
+        hasp_free(buffer);
+        hasp_free(_pagesfile);
+        _pagesfile = NULL;
+        dispatch_parse_jsonl(file, saved_page_id); // build all pages instead
+        return;
+    }
+    strcpy(_pagesfile, pagesfile);
+
+    index_jsonl(file, buffer, saved_page_id, true);
+    hasp_free(buffer);
+    dispatch_set_jsonl_page(saved_page_id);
+}
+
+/**
+ * Record the file ranges and the groups of the objects on each page that is built on demand
+ * @param file the opened pages file, positioned at the start
+ * @param buffer scratch space of HASP_JSONL_BUFFER_SIZE bytes
+ * @param saved_page_id the pageid to use when no pageid is specified
+ * @param create create the objects on page 0 and the system layer, false when the file is indexed again
+ */
+void Page::index_jsonl(File& file, char* buffer, uint8_t& saved_page_id, bool create)
+{
+    _pagesfile_size = file.size();
+    _pagesfile_time = file.getLastWrite();
+    file.setTimeout(25);
+
+    JsonlReader reader(file, buffer, HASP_JSONL_BUFFER_SIZE);
+    hasp_jsonl_pair_t pairs[HASP_JSONL_MAX_PAIRS];
+    hasp_jsonl_result_t result;
+    uint8_t pair_count;
+    uint16_t line = 1;
+    size_t start  = 0;
+
+    while((result = reader.next(pairs, pair_count)) == HASP_JSONL_OK) {
+        hasp_object_header_t header = {};
+        if(hasp_object_header_from_pairs(pairs, pair_count, header)) {
+            uint8_t pageid = header.has_page ? header.pageid : saved_page_id;
+            if(is_lazy(pageid)) {
+                add_span(pageid, start, reader.position());
+                for(uint8_t n = 0; n < pair_count; n++) {
+                    if(!strcmp_P(pairs[n].key, PSTR("groupid"))) add_group(pageid, pairs[n].value);
+                }
+                saved_page_id = pageid;
+            } else if(create) {
+                hasp_new_object(pairs, pair_count, saved_page_id);
+            }
+        }
+        start = reader.position();
+        line++;
+    }
+
+    if(result != HASP_JSONL_EMPTY) {
+        LOG_ERROR(TAG_HASP, F(D_JSONL_FAILED ": %s"), line, hasp_jsonl_result_name(result));
+    }
+}
+
+/* The pages file changed since it was indexed, the kept changes and the built pages stay as they are */
+void Page::rescan(File& file)
+{
+    uint8_t saved_page_id = PAGE_START_INDEX;
+    char* buffer          = (char*)hasp_malloc(HASP_JSONL_BUFFER_SIZE);
+    if(!buffer) {
+        LOG_ERROR(TAG_HASP, F(D_ERROR_OUT_OF_MEMORY));
+        return;
+    }
+
+    LOG_WARNING(TAG_HASP, F("%s changed, indexing it again"), _pagesfile);
+    for(uint8_t i = 0; i < count(); i++) {
+        hasp_free(_spans[i]);
+        _spans[i]      = NULL;
+        _span_count[i] = 0;
+        _groups[i]     = 0;
+    }
+
+    file.seek(0);
+    index_jsonl(file, buffer, saved_page_id, false);
+    hasp_free(buffer);
+
+    for(uint8_t i = 0; i < count(); i++) add_state_groups(i + PAGE_START_INDEX);
+}
+
+void Page::add_group(uint8_t pageid, const char* groupid)
+{
+    int group = atoi(groupid);
+    if(group > 0 && group < 16) _groups[pageid - PAGE_START_INDEX] |= 1 << group;
+}
+
+/* Groups set by a kept change are not in the pages file */
+void Page::add_state_groups(uint8_t pageid)
+{
+    for(hasp_page_state_t* state = _states[pageid - PAGE_START_INDEX]; state; state = state->next) {
+        if(!strcmp_P(state->key, FP_GROUPID)) add_group(pageid, state->value);
+    }
+}
+
+void Page::add_span(uint8_t pageid, uint32_t start, uint32_t end)
+{
+    uint8_t i  = pageid - PAGE_START_INDEX;
+    uint16_t n = _span_count[i];
+
+    /* Consecutive lines of the same page share a span */
+    if(n > 0 && _spans[i][n - 1].end == start) {
+        _spans[i][n - 1].end = end;
+        return;
+    }
+
+    hasp_page_span_t* spans = (hasp_page_span_t*)hasp_realloc(_spans[i], (n + 1) * sizeof(hasp_page_span_t));
+    if(!spans) {
+        LOG_ERROR(TAG_HASP, F(D_ERROR_OUT_OF_MEMORY));
+        return;
+    }
+    spans[n].start  = start;
+    spans[n].end    = end;
+    _spans[i]       = spans;
+    _span_count[i]  = n + 1;
+}
+
+void Page::free_definition(uint8_t pageid)
+{
+    uint8_t i = pageid - PAGE_START_INDEX;
+
+    hasp_free(_spans[i]);
+    _spans[i]      = NULL;
+    _span_count[i] = 0;
+    _groups[i]        = 0;
+    _group_pending[i] = 0;
+    _changed[i]       = false;
+
+    while(hasp_page_state_t* state = _states[i]) {
+        _states[i] = state->next;
+        hasp_free(state);
+    }
+}
+
+/**
+ * A change to a built page must be kept for when the page is built again
+ * @note values and texts are not kept, they are read from the objects when the page is evicted
+ */
+bool Page::keep_change(uint8_t pageid, uint8_t id, const char* key)
+{
+    if(!strcmp_P(key, FP_OBJ) || !strcmp_P(key, FP_PARENTID) || !strcmp_P(key, FP_GROUPID) ||
+       !strcasecmp_P(key, PSTR("delete")))
+        return true;
+    if(!strcasecmp_P(key, PSTR("val")) || !strcasecmp_P(key, PSTR("text"))) return false;
+
+    /* Objects created by a message are not in the pages file, a kept value must not be applied over a newer one */
+    for(hasp_page_state_t* state = _states[pageid - PAGE_START_INDEX]; state; state = state->next) {
+        if(state->id == id && (!strcmp_P(state->key, FP_OBJ) || !strcasecmp(state->key, key))) return true;
+    }
+    return false;
+}
+
+/**
+ * Keep a change to an object of a page that is built on demand
+ * @param pageid the page of the object
+ * @param id the id of the object
+ * @param key the attribute
+ * @param value the new value of the attribute
+ * @return true if the page is not built, the change will be applied when it is
+ */
+bool Page::defer(uint8_t pageid, uint8_t id, const char* key, const char* value)
+{
+    if(_building || !is_lazy(pageid)) return false;
+
+    /* Other changes to a built page are applied to its objects right away */
+    if(is_resident(pageid) && !keep_change(pageid, id, key)) {
+        _changed[pageid - PAGE_START_INDEX] = true;
+        return false;
+    }
+
+    size_t key_len           = strlen(key);
+    size_t value_len         = strlen(value);
+    hasp_page_state_t* state = (hasp_page_state_t*)hasp_malloc(sizeof(hasp_page_state_t) + key_len + value_len + 2);
+    if(!state) {
+        LOG_ERROR(TAG_HASP, F(D_ERROR_OUT_OF_MEMORY));
+        return !is_resident(pageid);
+    }
+    state->id    = id;
+    state->key   = (char*)(state + 1);
+    state->value = state->key + key_len + 1;
+    memcpy(state->key, key, key_len + 1);
+    memcpy(state->value, value, value_len + 1);
+    if(!strcasecmp_P(key, PSTR("groupid"))) add_group(pageid, value);
+
+    /* A new value replaces the previous one in place, deleting the object drops all of its changes */
+    bool deleted            = !strcasecmp_P(key, PSTR("delete"));
+    hasp_page_state_t** ref = &_states[pageid - PAGE_START_INDEX];
+    while(hasp_page_state_t* old = *ref) {
+        if(old->id == id && (deleted || !strcasecmp(old->key, key))) {
+            *ref = old->next;
+            hasp_free(old);
+            if(!deleted) break;
+        } else {
+            ref = &old->next;
+        }
+    }
+    state->next = *ref;
+    *ref        = state;
+
+    return !is_resident(pageid);
+}
+
+/**
+ * Keep the value of a group for a page that is not built
+ * @param pageid the page with objects in the group
+ * @param value the new value of the group
+ */
+void Page::defer_group(uint8_t pageid, const hasp_update_value_t& value)
+{
+    if(value.group == 0 || value.group >= 16) return;
+
+    _group_values[value.group]     = value;
+    _group_values[value.group].obj = NULL; // the object that changed the group is on another page
+    _group_pending[pageid - PAGE_START_INDEX] |= 1 << value.group;
+}
+
+/* Set the objects of a page that was just built to the group values changed while it was not built */
+void Page::apply_groups(uint8_t pageid)
+{
+    uint8_t i = pageid - PAGE_START_INDEX;
+    if(!_group_pending[i]) return;
+
+    for(uint8_t group = 1; group < 16; group++) {
+        if(_group_pending[i] & (1 << group)) object_set_page_group_values(pageid, _group_values[group]);
+    }
+    _group_pending[i] = 0;
+    _changed[i]       = true; // keep the new values when the page is evicted
+}
+
+/* Re-apply the kept changes, objects are handled in the order they were first changed */
+void Page::apply_states(uint8_t pageid, uint8_t& saved_page_id)
+{
+    hasp_page_state_t* states = _states[pageid - PAGE_START_INDEX];
+
+    for(hasp_page_state_t* first = states; first; first = first->next) {
+        hasp_page_state_t* state = states;
+        while(state != first && state->id != first->id) state = state->next;
+        if(state != first) continue; // object already handled
+
+        hasp_object_header_t header = {};
+        header.has_page             = true;
+        header.pageid               = pageid;
+        header.id                   = first->id;
+        for(state = first; state; state = state->next) {
+            if(state->id != first->id) continue;
+            if(!strcmp_P(state->key, FP_OBJ)) {
+                header.has_obj = true;
+                header.obj     = Parser::get_sdbm(state->value);
+            } else if(!strcmp_P(state->key, FP_PARENTID)) {
+                header.has_parentid = true;
+                header.parentid     = atoi(state->value);
+            }
+        }
+
+        bool created  = false;
+        lv_obj_t* obj = hasp_find_or_create_obj(header, saved_page_id, created);
+
+        for(state = first; state && obj; state = state->next) {
+            if(state->id != first->id || !strcmp_P(state->key, FP_OBJ) || !strcmp_P(state->key, FP_PARENTID)) continue;
+
+            if(!strcasecmp_P(state->key, PSTR("delete"))) {
+                /* The page is not shown, delete now so the object can be created again */
+                if(lv_obj_get_parent(obj)) lv_obj_del(obj);
+                obj = hasp_find_or_create_obj(header, saved_page_id, created);
+            } else {
+                hasp_process_obj_attribute(obj, state->key, state->value, true);
+            }
+        }
+    }
+}
+
+/* Create the objects of a page from its lines in the pages file and the changes made since */
+void Page::build(uint8_t pageid)
+{
+    uint8_t i             = pageid - PAGE_START_INDEX;
+    uint8_t saved_page_id = pageid;
+    unsigned long start   = millis();
+
+    evict_unused(pageid);
+    _building = true;
+
+    File file = HASP_FS.open(_pagesfile, "r");
+    if(file && (file.size() != _pagesfile_size || file.getLastWrite() != _pagesfile_time)) rescan(file);
+
+    if(_span_count[i] > 0) {
+        char* buffer = (char*)hasp_malloc(HASP_JSONL_BUFFER_SIZE);
+
+        if(file && buffer) {
+            file.setTimeout(25);
+            hasp_jsonl_pair_t pairs[HASP_JSONL_MAX_PAIRS];
+            uint8_t pair_count;
+
+            for(uint16_t n = 0; n < _span_count[i]; n++) {
+                size_t len = _spans[i][n].end - _spans[i][n].start;
+                file.seek(_spans[i][n].start);
+                JsonlReader reader(file, buffer, HASP_JSONL_BUFFER_SIZE);
+                while(reader.position() < len && reader.next(pairs, pair_count) == HASP_JSONL_OK) {
+                    hasp_new_object(pairs, pair_count, saved_page_id);
+                }
+            }
+        } else {
+            LOG_ERROR(TAG_HASP, F(D_FILE_LOAD_FAILED), _pagesfile);
+        }
+
+        hasp_free(buffer);
+    }
+    if(file) file.close();
+
+    apply_states(pageid, saved_page_id);
+    apply_groups(pageid);
+    _last_used[i] = ++_use_count;
+    _building     = false;
+
+    LOG_VERBOSE(TAG_HASP, F("Page %u built in %lu ms"), pageid, millis() - start);
+}
+
+/* Keep the values and texts of the objects, so they are restored when the page is rebuilt */
+void Page::keep_values(lv_obj_t* parent, uint8_t pageid)
+{
+    char value[12];
+    int32_t val;
+    const char* text;
+
+    for(lv_obj_t* child = lv_obj_get_child(parent, NULL); child; child = lv_obj_get_child(parent, child)) {
+        if(child->user_data.id != 0) {
+            if(attribute_get_value(child, val)) {
+                itoa(val, value, DEC);
+                defer(pageid, child->user_data.id, "val", value);
+            }
+            if(attribute_get_text(child, text)) defer(pageid, child->user_data.id, "text", text);
+        }
+        keep_values(child, pageid); // also finds the objects on tabs
+    }
+}
+
+/* Delete the objects of a page, the page is built again when it is shown */
+void Page::evict(uint8_t pageid)
+{
+    uint8_t i = pageid - PAGE_START_INDEX;
+
+    LOG_VERBOSE(TAG_HASP, F("Page %u evicted"), pageid);
+    _last_used[i] = 0; // not resident, so the values are kept
+    if(_changed[i]) keep_values(get_obj(pageid), pageid);
+    _changed[i] = false;
+
+    object_index_clear(pageid);
+    lv_obj_clean(get_obj(pageid));
+}
+
+/* Evict the least recently shown pages to make room for pageid */
+void Page::evict_unused(uint8_t pageid)
+{
+    uint8_t resident = 0;
+    for(uint8_t i = 0; i < count(); i++) {
+        if(_last_used[i]) resident++;
+    }
+
+    while(resident >= HASP_RESIDENT_PAGES) {
+        uint8_t oldest = 0;
+        for(uint8_t i = 0; i < count(); i++) {
+            uint8_t id = i + PAGE_START_INDEX;
+            if(!_last_used[i] || id == pageid || id == _current_page || _pages[i] == lv_scr_act()) continue;
+            if(!oldest || _last_used[i] < _last_used[oldest - PAGE_START_INDEX]) oldest = id;
+        }
+        if(!oldest) break; // only the visible page is left
+
+        evict(oldest);
+        resident--;
+    }
+}
+
+#endif // HASP_USE_LAZY_PAGES
+
 } // namespace hasp
 
 hasp::Page haspPages;
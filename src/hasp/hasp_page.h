@@ -22,6 +22,24 @@ struct hasp_page_meta_data_t
     uint8_t back : 4;
 };
 
+#if HASP_USE_LAZY_PAGES > 0
+/* A range of the pages file holding objects of one page */
+struct hasp_page_span_t
+{
+    uint32_t start;
+    uint32_t end;
+};
+
+/* A change made to an object of a page that is built on demand, re-applied when the page is rebuilt */
+struct hasp_page_state_t
+{
+    hasp_page_state_t* next;
+    char* key;   // points into the same allocation
+    char* value; // points into the same allocation
+    uint8_t id;
+};
+#endif
+
 namespace hasp {
 
 class Page {
@@ -31,6 +49,38 @@ class Page {
     lv_obj_t* _pages[HASP_NUM_PAGES];                 // index 0 = Page 1 etc.
     uint8_t _current_page;
 
+#if HASP_USE_LAZY_PAGES > 0
+    char* _pagesfile;                            // source of the page definitions, NULL if all pages are built
+    hasp_page_span_t* _spans[HASP_NUM_PAGES];    // index 0 = Page 1 etc.
+    uint16_t _span_count[HASP_NUM_PAGES];        // index 0 = Page 1 etc.
+    hasp_page_state_t* _states[HASP_NUM_PAGES];  // index 0 = Page 1 etc.
+    uint32_t _last_used[HASP_NUM_PAGES];         // index 0 = Page 1 etc., 0 = not built
+    uint16_t _groups[HASP_NUM_PAGES];            // index 0 = Page 1 etc., bit n = an object is in group n
+    bool _changed[HASP_NUM_PAGES];               // index 0 = Page 1 etc., values differ from the pages file
+    uint16_t _group_pending[HASP_NUM_PAGES];     // index 0 = Page 1 etc., bit n = group n changed while not built
+    hasp_update_value_t _group_values[16];       // last value of each group, applied when a page is built
+    uint32_t _pagesfile_size;                    // size of the pages file when it was indexed
+    time_t _pagesfile_time;                      // last write of the pages file when it was indexed
+    uint32_t _use_count;
+    bool _building;
+
+    void scan_jsonl(File& file, const char* pagesfile, uint8_t& saved_page_id);
+    void index_jsonl(File& file, char* buffer, uint8_t& saved_page_id, bool create);
+    void rescan(File& file);
+    void add_span(uint8_t pageid, uint32_t start, uint32_t end);
+    void add_group(uint8_t pageid, const char* groupid);
+    void add_state_groups(uint8_t pageid);
+    void free_definition(uint8_t pageid);
+    void build(uint8_t pageid);
+    void evict(uint8_t pageid);
+    void evict_unused(uint8_t pageid);
+    void apply_states(uint8_t pageid, uint8_t& saved_page_id);
+    void apply_groups(uint8_t pageid);
+    bool keep_change(uint8_t pageid, uint8_t id, const char* key);
+    void keep_values(lv_obj_t* parent, uint8_t pageid);
+    bool is_lazy(uint8_t pageid);
+#endif
+
   public:
     Page();
     uint8_t count();
@@ -59,6 +109,14 @@ class Page {
     lv_obj_t* get_obj(uint8_t pageid);
     bool get_id(const lv_obj_t* obj, uint8_t* pageid);
     bool is_valid(uint8_t pageid);
+#if HASP_USE_LAZY_PAGES > 0
+    bool is_resident(uint8_t pageid);
+    bool has_group(uint8_t pageid, uint8_t groupid);
+    void load(uint8_t pageid);
+    void changed(uint8_t pageid);
+    bool defer(uint8_t pageid, uint8_t id, const char* key, const char* value);
+    void defer_group(uint8_t pageid, const hasp_update_value_t& value);
+#endif
 };
 
 } // namespace hasp
@@ -0,0 +1,354 @@
+/* MIT License - Copyright (c) 2019-2024 Francis Van Roie
+   For full license information read the LICENSE file in the project folder */
+
+/* Compiled pages file
+ *
+ * The pages file is compiled into a binary copy stored next to it. Each record holds the resolved page,
+ * parent, id and object type followed by the attributes with their hash and unescaped value, so loading
+ * it skips the json tokenizing, the object type hashing and the attribute name lookups. Values of numeric
+ * and boolean attributes are stored parsed.
+ * The copy is tied to the size and the content hash of the source file and to the attribute table of the
+ * firmware. The header is written last, with the number of records, so an interrupted write never validates.
+ *
+ * Layout, all values little endian:
+ *   header    : magic u32, version u8, reserved u8[3], build u32, source size u32, source hash u32, records u32
+ *   record    : flags u8, pageid u8, parentid u8, id u8, obj u16, attribute count u8
+ *   attribute : hash u16, payload u8, key length u8, value length u16, key, value
+ *               the value is an int32 when the payload is HASP_ATTR_PAYLOAD_INT or HASP_ATTR_PAYLOAD_BOOL
+ */
+
+#include "hasplib.h"
+#include "hasp_pagecache.h"
+
+#if HASP_USE_PAGE_CACHE > 0
+
+#define PAGECACHE_HEADER_SIZE 24
+#define PAGECACHE_HEADER_COUNT 20 // offset of the record count, the bytes before it identify the source
+#define PAGECACHE_RECORD_SIZE 7
+#define PAGECACHE_ATTR_SIZE 6
+
+enum {
+    PAGECACHE_HAS_PAGE     = 0x01,
+    PAGECACHE_HAS_PARENTID = 0x02,
+    PAGECACHE_HAS_OBJ      = 0x04,
+};
+
+static inline void pagecache_put16(uint8_t* p, uint16_t value)
+{
+    p[0] = value;
+    p[1] = value >> 8;
+}
+
+static inline void pagecache_put32(uint8_t* p, uint32_t value)
+{
+    pagecache_put16(p, value);
+    pagecache_put16(p + 2, value >> 16);
+}
+
+static inline uint16_t pagecache_get16(const uint8_t* p)
+{
+    return p[0] | (p[1] << 8);
+}
+
+static inline uint32_t pagecache_get32(const uint8_t* p)
+{
+    return pagecache_get16(p) | ((uint32_t)pagecache_get16(p + 2) << 16);
+}
+
+/* The firmware version and attribute table the copy was compiled for */
+static uint32_t pagecache_build()
+{
+    uint32_t hash    = hasp_attribute_table_hash();
+    uint8_t build[3] = {HASP_VER_MAJ, HASP_VER_MIN, HASP_VER_REV};
+
+    for(uint8_t i = 0; i < sizeof(build); i++) {
+        hash ^= build[i];
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+/* FNV-1a hash of the content of the source file, the modification time is not reliable without a synced clock */
+static uint32_t pagecache_source_hash(File& source)
+{
+    uint8_t buffer[128];
+    uint32_t hash = 2166136261U;
+    size_t len;
+
+    source.seek(0);
+    while((len = source.read(buffer, sizeof(buffer))) > 0) {
+        for(size_t i = 0; i < len; i++) {
+            hash ^= buffer[i];
+            hash *= 16777619U;
+        }
+    }
+    source.seek(0);
+    return hash;
+}
+
+/* The header that identifies the source file and the firmware, the record count is filled in when written */
+static void pagecache_make_header(File& source, uint8_t* header)
+{
+    memset(header, 0, PAGECACHE_HEADER_SIZE);
+    pagecache_put32(header, HASP_PAGECACHE_MAGIC);
+    header[4] = HASP_PAGECACHE_VERSION;
+    pagecache_put32(header + 8, pagecache_build());
+    pagecache_put32(header + 12, source.size());
+    pagecache_put32(header + 16, pagecache_source_hash(source));
+}
+
+/* Parse the value of a numeric attribute, false if the text is not a plain decimal number */
+static bool pagecache_parse_int(const char* value, int32_t& val)
+{
+    const char* digits = value[0] == '-' ? value + 1 : value;
+    size_t len         = strlen(digits);
+    if(len == 0 || len > 9 || !Parser::is_only_digits(digits)) return false; // fits in an int32
+    val = atoi(value);
+    return true;
+}
+
+bool hasp_pagecache_filename(const char* pagesfile, char* cachefile, size_t size)
+{
+    int len = snprintf_P(cachefile, size, PSTR("%sc"), pagesfile);
+    return len > 1 && (size_t)len < size;
+}
+
+/**
+ * Remove the binary copy of a pages file, for when the file is replaced
+ * @param pagesfile char*: the jsonl file, with or without the leading /
+ */
+void hasp_pagecache_invalidate(const char* pagesfile)
+{
+    char path[64];
+    char cachefile[64];
+    snprintf_P(path, sizeof(path), pagesfile[0] == '/' ? PSTR("%s") : PSTR("/%s"), pagesfile);
+    if(hasp_pagecache_filename(path, cachefile, sizeof(cachefile)) && HASP_FS.exists(cachefile)) {
+        HASP_FS.remove(cachefile);
+    }
+}
+
+static bool pagecache_write_record(File& cache, const hasp_object_header_t& header, const hasp_jsonl_pair_t* pairs,
+                                   uint8_t count)
+{
+    uint8_t record[PAGECACHE_RECORD_SIZE];
+    record[0] = (header.has_page ? PAGECACHE_HAS_PAGE : 0) | (header.has_parentid ? PAGECACHE_HAS_PARENTID : 0) |
+                (header.has_obj ? PAGECACHE_HAS_OBJ : 0);
+    record[1] = header.pageid;
+    record[2] = header.parentid;
+    record[3] = header.id;
+    pagecache_put16(record + 4, header.obj);
+    record[6] = 0;
+    for(uint8_t i = 0; i < count; i++) {
+        if(!hasp_object_is_header_key(pairs[i].key)) record[6]++;
+    }
+    if(cache.write(record, sizeof(record)) != sizeof(record)) return false;
+
+    for(uint8_t i = 0; i < count; i++) {
+        const char* key   = pairs[i].key;
+        const char* value = pairs[i].value;
+        if(hasp_object_is_header_key(key)) continue;
+
+        uint16_t attr_hash = hasp_attribute_get_hash(key);
+        uint8_t payload    = hasp_attribute_get_payload(attr_hash);
+        size_t key_len     = strlen(key);
+        size_t value_len   = strlen(value);
+        uint8_t number[4];
+        int32_t val;
+
+        if(payload == HASP_ATTR_PAYLOAD_BOOL) {
+            val = Parser::is_true(value);
+        } else if(payload == HASP_ATTR_PAYLOAD_INT && !pagecache_parse_int(value, val)) {
+            payload = HASP_ATTR_PAYLOAD_TEXT; // e.g. an expression, keep the text
+        }
+        if(payload != HASP_ATTR_PAYLOAD_TEXT) {
+            pagecache_put32(number, val);
+            value     = (const char*)number;
+            value_len = sizeof(number);
+        }
+        if(key_len > UINT8_MAX || value_len > UINT16_MAX) return false;
+
+        uint8_t attr[PAGECACHE_ATTR_SIZE];
+        pagecache_put16(attr, attr_hash);
+        attr[2] = payload;
+        attr[3] = key_len;
+        pagecache_put16(attr + 4, value_len);
+
+        if(cache.write(attr, sizeof(attr)) != sizeof(attr) || cache.write((const uint8_t*)key, key_len) != key_len ||
+           cache.write((const uint8_t*)value, value_len) != value_len)
+            return false;
+    }
+
+    return true;
+}
+
+/**
+ * Compile a jsonl pages file into its binary copy
+ * @param pagesfile char*: the jsonl file to compile
+ * @return true if the binary copy was written
+ * @note a partially written copy is removed
+ */
+bool hasp_pagecache_compile(const char* pagesfile)
+{
+    char cachefile[64];
+    if(!hasp_pagecache_filename(pagesfile, cachefile, sizeof(cachefile))) return false;
+
+    File source = HASP_FS.open(pagesfile, "r");
+    if(!source) {
+        LOG_ERROR(TAG_HASP, F(D_FILE_LOAD_FAILED), pagesfile);
+        return false;
+    }
+
+    char* buffer = (char*)hasp_malloc(HASP_JSONL_BUFFER_SIZE);
+    if(!buffer) {
+        source.close();
+        LOG_ERROR(TAG_HASP, F(D_ERROR_OUT_OF_MEMORY));
+        return false;
+    }
+
+    uint8_t header[PAGECACHE_HEADER_SIZE];
+    pagecache_make_header(source, header);
+    source.setTimeout(25);
+
+    /* Reserve the header, it is only written after all records */
+    uint8_t blank[PAGECACHE_HEADER_SIZE] = {0};
+    File cache                           = HASP_FS.open(cachefile, "w");
+    bool ok                              = cache && cache.write(blank, sizeof(blank)) == sizeof(blank);
+
+    JsonlReader reader(source, buffer, HASP_JSONL_BUFFER_SIZE);
+    hasp_jsonl_pair_t pairs[HASP_JSONL_MAX_PAIRS];
+    hasp_jsonl_result_t result = HASP_JSONL_EMPTY;
+    uint8_t count;
+    uint16_t objects    = 0;
+    unsigned long start = millis();
+
+    while(ok && (result = reader.next(pairs, count)) == HASP_JSONL_OK) {
+        hasp_object_header_t obj_header = {};
+        if(!hasp_object_header_from_pairs(pairs, count, obj_header)) continue; // skipped line
+        ok = pagecache_write_record(cache, obj_header, pairs, count);
+        objects++;
+    }
+    ok = ok && result == HASP_JSONL_EMPTY;
+
+    pagecache_put32(header + PAGECACHE_HEADER_COUNT, objects);
+    ok = ok && cache.seek(0) && cache.write(header, sizeof(header)) == sizeof(header);
+
+    if(cache) cache.close();
+    source.close();
+    hasp_free(buffer);
+
+    if(!ok) {
+        HASP_FS.remove(cachefile);
+        LOG_ERROR(TAG_HASP, F(D_FILE_SAVE_FAILED), cachefile);
+        return false;
+    }
+
+    LOG_INFO(TAG_HASP, F(D_FILE_SAVED " (%u objects in %lu ms)"), cachefile, objects, millis() - start);
+    return true;
+}
+
+/**
+ * Create the objects of a pages file from its binary copy
+ * @param pagesfile char*: the jsonl file that was compiled
+ * @param saved_page_id the pageid to use when no pageid is specified, updated like when parsing the jsonl file
+ * @return true if all objects were loaded, false if the copy is missing, out of date or damaged
+ * @note on failure objects may already have been created, reloading the jsonl file updates those in place
+ */
+bool hasp_pagecache_load(const char* pagesfile, uint8_t& saved_page_id)
+{
+    char cachefile[64];
+    if(!hasp_pagecache_filename(pagesfile, cachefile, sizeof(cachefile)) || !HASP_FS.exists(cachefile)) return false;
+
+    File source = HASP_FS.open(pagesfile, "r");
+    if(!source) return false;
+
+    uint8_t expected[PAGECACHE_HEADER_SIZE];
+    uint8_t found[PAGECACHE_HEADER_SIZE];
+    pagecache_make_header(source, expected);
+    source.close();
+
+    File cache = HASP_FS.open(cachefile, "r");
+    if(!cache || cache.read(found, sizeof(found)) != sizeof(found) ||
+       memcmp(expected, found, PAGECACHE_HEADER_COUNT)) {
+        if(cache) cache.close();
+        LOG_VERBOSE(TAG_HASP, F("%s is out of date"), cachefile);
+        return false;
+    }
+
+    char* buffer = (char*)hasp_malloc(HASP_JSONL_BUFFER_SIZE);
+    if(!buffer) {
+        cache.close();
+        LOG_ERROR(TAG_HASP, F(D_ERROR_OUT_OF_MEMORY));
+        return false;
+    }
+
+    uint8_t record[PAGECACHE_RECORD_SIZE];
+    size_t len          = 0;
+    bool ok             = true;
+    uint32_t objects    = 0;
+    uint32_t records    = pagecache_get32(found + PAGECACHE_HEADER_COUNT);
+    unsigned long start = millis();
+
+    while(ok && objects < records && (len = cache.read(record, sizeof(record))) == sizeof(record)) {
+        hasp_object_header_t header = {};
+        header.has_page             = record[0] & PAGECACHE_HAS_PAGE;
+        header.has_parentid         = record[0] & PAGECACHE_HAS_PARENTID;
+        header.has_obj              = record[0] & PAGECACHE_HAS_OBJ;
+        header.pageid               = record[1];
+        header.parentid             = record[2];
+        header.id                   = record[3];
+        header.obj                  = pagecache_get16(record + 4);
+
+        bool created  = false;
+        lv_obj_t* obj = hasp_find_or_create_obj(header, saved_page_id, created);
+
+        for(uint8_t i = 0; i < record[6]; i++) {
+            uint8_t attr[PAGECACHE_ATTR_SIZE];
+            if(cache.read(attr, sizeof(attr)) != sizeof(attr)) {
+                ok = false;
+                break;
+            }
+
+            uint16_t attr_hash = pagecache_get16(attr);
+            uint8_t payload    = attr[2];
+            size_t key_len     = attr[3];
+            size_t value_len   = pagecache_get16(attr + 4);
+            char* key          = buffer;
+            char* value        = buffer + key_len + 1;
+
+            if(key_len + value_len + 2 > HASP_JSONL_BUFFER_SIZE || cache.read((uint8_t*)key, key_len) != key_len ||
+               cache.read((uint8_t*)value, value_len) != value_len) {
+                ok = false;
+                break;
+            }
+            key[key_len]     = '\0';
+            value[value_len] = '\0';
+
+            if(!obj || (created && attr_hash == ATTR_OBJ)) continue;
+
+            if(payload != HASP_ATTR_PAYLOAD_TEXT) {
+                if(value_len != 4) {
+                    ok = false;
+                    break;
+                }
+                hasp_process_obj_attribute_int(obj, key, attr_hash, (int32_t)pagecache_get32((uint8_t*)value));
+            } else {
+                hasp_process_obj_attribute_hash(obj, key, attr_hash, value, true);
+            }
+        }
+        objects++;
+    }
+    ok = ok && objects == records && cache.read(record, 1) == 0; // all records and nothing after them
+
+    cache.close();
+    hasp_free(buffer);
+
+    if(!ok) {
+        LOG_ERROR(TAG_HASP, F(D_FILE_LOAD_FAILED), cachefile);
+        return false;
+    }
+
+    LOG_DEBUG(TAG_HASP, F(D_FILE_LOADED " (%u objects in %lu ms)"), cachefile, objects, millis() - start);
+    return true;
+}
+
+#endif
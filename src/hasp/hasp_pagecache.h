@@ -0,0 +1,28 @@
+/* MIT License - Copyright (c) 2019-2024 Francis Van Roie
+   For full license information read the LICENSE file in the project folder */
+
+#ifndef HASP_PAGECACHE_H
+#define HASP_PAGECACHE_H
+
+#include "hasplib.h"
+
+#if HASP_USE_PAGE_CACHE > 0
+
+#define HASP_PAGECACHE_MAGIC 0x43505348 // "HSPC"
+#define HASP_PAGECACHE_VERSION 3
+
+/* Name of the compiled copy of a pages file, e.g. /pages.jsonl -> /pages.jsonlc */
+bool hasp_pagecache_filename(const char* pagesfile, char* cachefile, size_t size);
+
+/* Compile the pages file into its binary copy */
+bool hasp_pagecache_compile(const char* pagesfile);
+
+/* Create the objects from the binary copy, fails if it is missing or out of date */
+bool hasp_pagecache_load(const char* pagesfile, uint8_t& saved_page_id);
+
+/* Remove the binary copy of a file that was replaced */
+void hasp_pagecache_invalidate(const char* pagesfile);
+
+#endif
+
+#endif
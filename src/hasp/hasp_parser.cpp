@@ -169,11 +169,11 @@ void Parser::get_event_name(uint8_t eventid, char* buffer, size_t size)
 
 /* 16-bit hashing function http://www.cse.yorku.ca/~oz/hash.html */
 /* all possible attributes are hashed and checked if they are unique */
-uint16_t Parser::get_sdbm(const char* str)
+uint16_t Parser::get_sdbm(const char* str, bool with_digits)
 {
     uint16_t hash = 0;
     while(char c = tolower(*str++))
-        if(c > 57 || c < 48) hash = c + (hash << 6) - hash; // exclude numbers which can cause collisions
+        if(with_digits || c > 57 || c < 48) hash = c + (hash << 6) - hash; // numbers are excluded by default
     return hash;
 }
 
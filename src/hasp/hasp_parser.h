@@ -15,11 +15,22 @@ class Parser {
     static bool get_event_state(uint8_t eventid);
     static void get_event_name(uint8_t eventid, char* buffer, size_t size);
     static uint8_t get_action_id(const char* action);
-    static uint16_t get_sdbm(const char* str);
+    static uint16_t get_sdbm(const char* str, bool with_digits = false);
     static bool is_true(const char* s);
     static bool is_true(JsonVariant json);
     static bool is_only_digits(const char* s);
     static int format_bytes(uint64_t filesize, char* buf, size_t len);
+
+    /* compile-time equivalent of get_sdbm(), used to verify the hash constants */
+    static constexpr uint16_t get_sdbm_const(const char* str, bool with_digits = false, uint16_t hash = 0)
+    {
+        return *str == '\0' ? hash
+                            : get_sdbm_const(str + 1, with_digits,
+                                             (!with_digits && *str >= '0' && *str <= '9')
+                                                 ? hash
+                                                 : (uint16_t)(((*str >= 'A' && *str <= 'Z') ? *str + 32 : *str) +
+                                                              (hash << 6) - hash));
+    }
 };
 
 #ifndef ARDUINO
@@ -0,0 +1,608 @@
+/* MIT License - Copyright (c) 2019-2024 Francis Van Roie
+   For full license information read the LICENSE file in the project folder */
+
+/* ********************************************************************************************
+ *
+ *  HASP Benchmark
+ *     - Loads a pages file and replays a script of commands on the headless display
+ *     - Each command is dispatched and rendered right away, so its latency is measured separately
+ *     - "wait <ms>" lets the animations and tasks run, like the main loop would
+ *     - MQTT topics like "hasp/plate/command/p1b1.text Hello" are accepted as well
+ *     - A trace recorded with the mqtttrace command is replayed at its own pace, or faster
+ *     - The state messages are written with JsonWriter and with the printf formats it replaced
+ *     - Objects are looked up with the page index and with the tree walk it replaced
+ *     - Attributes are applied with hasp_parse_json_attributes, like a line of pages.jsonl
+ *     - A generated pages file with hundreds of objects is loaded with dispatch_parse_jsonl
+ *
+ ******************************************************************************************** */
+
+#include "hasplib.h"
+
+#if HASP_TARGET_PC && USE_HEADLESS
+
+#include <time.h>
+#include <unistd.h>
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "dev/device.h"
+#include "drv/tft/tft_driver.h"
+#include "hasp_debug.h"
+#include "hasp_gui.h"
+#include "hasp_bench.h"
+
+#define BENCH_HISTOGRAM_SIZE 22 // latency buckets of up to 1us, 2us, 4us ... 1s, and one for the slower ones
+
+struct bench_command_t
+{
+    std::string line;
+    uint32_t dispatch_us; // time to parse and execute the command
+    uint32_t render_us;   // time to redraw the screen afterwards
+};
+
+struct bench_message_t
+{
+    uint32_t time_ms; // since the start of the recording
+    std::string topic;
+    std::string payload;
+};
+
+static uint64_t bench_micros()
+{
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+// Run the main loop for a while, without the network and console services
+static void bench_wait(uint32_t ms)
+{
+    uint64_t end = bench_micros() + ms * 1000ULL;
+    while(bench_micros() < end) {
+        guiLoop();
+        haspLoop();
+        usleep(1000);
+    }
+}
+
+// Strip the topic prefix of an MQTT command, the subtopic is the command itself
+static std::string bench_command(const std::string& line)
+{
+    size_t space      = line.find(' ');
+    std::string topic = line.substr(0, space);
+
+    size_t pos = topic.find("/command");
+    if(pos == std::string::npos) return line;
+
+    pos += 8; // strlen("/command")
+    if(pos == topic.length()) return space == std::string::npos ? "" : line.substr(space + 1);
+    if(topic[pos] == '/') return line.substr(pos + 1);
+    return line;
+}
+
+static uint32_t bench_load_pages(const char* pages)
+{
+    std::ifstream file(pages);
+    if(!file) {
+        LOG_ERROR(TAG_HASP, F(D_FILE_LOAD_FAILED), pages);
+        return 0;
+    }
+
+    uint64_t start = bench_micros();
+    hasp_init();
+    uint8_t savedPage = haspPages.get();
+    dispatch_parse_jsonl(file, savedPage);
+    haspPages.set(savedPage, LV_SCR_LOAD_ANIM_NONE, 0, 0);
+    lv_refr_now(NULL);
+
+    return (bench_micros() - start) / 1000;
+}
+
+// Usage of the lvgl memory pool
+static void bench_add_mem(JsonDocument& doc)
+{
+#if LV_MEM_CUSTOM == 0
+    lv_mem_monitor_t mem_mon;
+    lv_mem_monitor(&mem_mon);
+    JsonObject mem  = doc.createNestedObject("lv_mem");
+    mem["total"]    = mem_mon.total_size;
+    mem["max_used"] = mem_mon.max_used;
+    mem["used"]     = mem_mon.total_size - mem_mon.free_size;
+    mem["frag_pct"] = mem_mon.frag_pct;
+#endif
+}
+
+// Frame rate, flush times and lvgl memory of the run
+static void bench_add_stats(JsonDocument& doc, uint32_t duration_us, uint32_t frames)
+{
+    doc["width"]       = haspTft.width();
+    doc["height"]      = haspTft.height();
+    doc["duration_ms"] = duration_us / 1000;
+    doc["frames"]      = frames;
+    doc["fps"]         = duration_us ? frames * 1000000.0 / duration_us : 0;
+
+    JsonObject flush = doc.createNestedObject("flush");
+    flush["count"]   = haspTft.flush_count;
+    flush["avg_us"]  = haspTft.flush_count ? haspTft.flush_time_us / haspTft.flush_count : 0;
+    flush["max_us"]  = haspTft.flush_max_us;
+    flush["pixels"]  = haspTft.flush_pixels_total;
+
+    bench_add_mem(doc);
+}
+
+static bool bench_write_report(JsonDocument& doc, const char* report)
+{
+    if(!report || !*report) {
+        serializeJsonPretty(doc, std::cout);
+        std::cout << std::endl;
+        return true;
+    }
+
+    std::ofstream output(report);
+    if(!output) {
+        LOG_ERROR(TAG_HASP, F(D_FILE_SAVE_FAILED), report);
+        return false;
+    }
+    serializeJsonPretty(doc, output);
+    return true;
+}
+
+bool bench_run(const char* script, const char* pages, const char* report)
+{
+    std::ifstream input(script);
+    if(!input) {
+        LOG_ERROR(TAG_HASP, F(D_FILE_NOT_FOUND ": %s"), script);
+        haspDevice.pc_is_running = false;
+        return false;
+    }
+
+    uint32_t pages_ms = 0;
+    if(pages && *pages) pages_ms = bench_load_pages(pages);
+    lv_refr_now(NULL); // start from a drawn screen
+
+    std::vector<bench_command_t> commands;
+    std::string line;
+    haspTft.reset_stats();
+    uint32_t frames = gui_get_perf().frames;
+    uint64_t start  = bench_micros();
+
+    while(std::getline(input, line)) {
+        if(!line.empty() && line.back() == '\r') line.pop_back();
+        if(line.empty() || line[0] == '#') continue;
+
+        if(line.compare(0, 5, "wait ") == 0) {
+            bench_wait(atoi(line.c_str() + 5));
+            continue;
+        }
+
+        bench_command_t command;
+        command.line = bench_command(line);
+
+        uint64_t t0 = bench_micros();
+        dispatch_text_line(command.line.c_str(), TAG_CONS);
+        uint64_t t1 = bench_micros();
+        lv_refr_now(NULL);
+        uint64_t t2 = bench_micros();
+
+        command.dispatch_us = t1 - t0;
+        command.render_us   = t2 - t1;
+        commands.push_back(command);
+    }
+
+    uint32_t duration_us = bench_micros() - start;
+    frames               = gui_get_perf().frames - frames;
+
+    DynamicJsonDocument doc(2048 + commands.size() * (JSON_OBJECT_SIZE(3) + 16));
+    doc["pages_ms"] = pages_ms;
+    bench_add_stats(doc, duration_us, frames);
+
+    uint64_t dispatch_total = 0;
+    uint32_t dispatch_max   = 0;
+    for(const bench_command_t& command : commands) {
+        dispatch_total += command.dispatch_us;
+        if(command.dispatch_us > dispatch_max) dispatch_max = command.dispatch_us;
+    }
+
+    JsonObject dispatch = doc.createNestedObject("dispatch");
+    dispatch["count"]   = commands.size();
+    dispatch["avg_us"]  = commands.empty() ? 0 : dispatch_total / commands.size();
+    dispatch["max_us"]  = dispatch_max;
+
+    JsonArray list = doc.createNestedArray("commands");
+    for(const bench_command_t& command : commands) {
+        JsonObject item     = list.createNestedObject();
+        item["cmd"]         = command.line.c_str();
+        item["dispatch_us"] = command.dispatch_us;
+        item["render_us"]   = command.render_us;
+    }
+
+    haspDevice.pc_is_running = false;
+    return bench_write_report(doc, report);
+}
+
+static bool bench_read_trace(const char* trace, std::vector<bench_message_t>& messages)
+{
+    std::ifstream input(trace);
+    if(!input) {
+        LOG_ERROR(TAG_HASP, F(D_FILE_NOT_FOUND ": %s"), trace);
+        return false;
+    }
+
+    std::string line;
+    uint32_t number = 0;
+    while(std::getline(input, line)) {
+        number++;
+        if(line.empty()) continue;
+
+        DynamicJsonDocument doc(JSON_OBJECT_SIZE(3) + line.length());
+        DeserializationError error = deserializeJson(doc, line);
+        if(error || !doc["topic"].is<const char*>()) {
+            LOG_WARNING(TAG_HASP, F("Skipped line %u of %s"), number, trace);
+            continue;
+        }
+
+        bench_message_t message;
+        message.time_ms = doc["t"].as<uint32_t>();
+        message.topic   = doc["topic"].as<const char*>();
+        message.payload = doc["payload"] | "";
+        messages.push_back(message);
+    }
+    return true;
+}
+
+// Latency in us at a percentile of the sorted latencies
+static uint32_t bench_percentile(const std::vector<uint32_t>& sorted, float percentile)
+{
+    if(sorted.empty()) return 0;
+    size_t index = percentile * (sorted.size() - 1) / 100 + 0.5f;
+    return sorted[index];
+}
+
+bool bench_replay(const char* trace, float speed, const char* pages, const char* report)
+{
+    std::vector<bench_message_t> messages;
+    if(!bench_read_trace(trace, messages)) {
+        haspDevice.pc_is_running = false;
+        return false;
+    }
+
+    uint32_t pages_ms = 0;
+    if(pages && *pages) pages_ms = bench_load_pages(pages);
+    lv_refr_now(NULL); // start from a drawn screen
+
+    std::vector<uint32_t> latencies;
+    uint32_t histogram[BENCH_HISTOGRAM_SIZE] = {0};
+    uint64_t dispatch_total                  = 0;
+    uint32_t late                            = 0;
+    latencies.reserve(messages.size());
+
+    haspTft.reset_stats();
+    uint32_t frames = gui_get_perf().frames;
+    uint64_t start  = bench_micros();
+
+    for(const bench_message_t& message : messages) {
+        // Keep the screen and the tasks going between the messages, like mqttLoop does
+        guiLoop();
+        haspLoop();
+
+        if(speed > 0) {
+            uint64_t due = start + (uint64_t)(message.time_ms * 1000.0 / speed);
+            if(bench_micros() > due + 1000) late++; // behind schedule by more than 1ms
+            while(bench_micros() < due) {
+                guiLoop();
+                haspLoop();
+                usleep(std::min<uint64_t>(1000, due - bench_micros() + 1));
+            }
+        }
+
+        uint64_t t0 = bench_micros();
+        dispatch_topic_payload(message.topic.c_str(), message.payload.c_str(), !message.payload.empty(), TAG_MQTT);
+        uint32_t latency = bench_micros() - t0;
+
+        uint8_t bucket = 0;
+        while(bucket < BENCH_HISTOGRAM_SIZE - 1 && (1U << bucket) < latency) bucket++;
+        histogram[bucket]++;
+        dispatch_total += latency;
+        latencies.push_back(latency);
+    }
+    lv_refr_now(NULL); // include drawing the final state
+
+    uint32_t duration_us = bench_micros() - start;
+    frames               = gui_get_perf().frames - frames;
+    std::sort(latencies.begin(), latencies.end());
+
+    DynamicJsonDocument doc(4096);
+    doc["pages_ms"] = pages_ms;
+    doc["speed"]    = speed;
+    bench_add_stats(doc, duration_us, frames);
+
+    JsonObject dispatch     = doc.createNestedObject("dispatch");
+    dispatch["count"]       = messages.size();
+    dispatch["late"]        = late;
+    dispatch["msg_per_sec"] = duration_us ? messages.size() * 1000000.0 / duration_us : 0;
+    dispatch["avg_us"]      = messages.empty() ? 0 : dispatch_total / messages.size();
+    dispatch["p50_us"]      = bench_percentile(latencies, 50);
+    dispatch["p90_us"]      = bench_percentile(latencies, 90);
+    dispatch["p99_us"]      = bench_percentile(latencies, 99);
+    dispatch["p999_us"]     = bench_percentile(latencies, 99.9);
+    dispatch["max_us"]      = latencies.empty() ? 0 : latencies.back();
+
+    /* Upper bound of each bucket in us, the last bucket holds everything slower */
+    JsonArray buckets = dispatch.createNestedArray("histogram");
+    for(uint8_t i = 0; i < BENCH_HISTOGRAM_SIZE; i++) {
+        if(!histogram[i]) continue;
+        JsonObject bucket = buckets.createNestedObject();
+        if(i < BENCH_HISTOGRAM_SIZE - 1)
+            bucket["le_us"] = 1U << i;
+        else
+            bucket["gt_us"] = 1U << (i - 1);
+        bucket["count"] = histogram[i];
+    }
+
+    haspDevice.pc_is_running = false;
+    return bench_write_report(doc, report);
+}
+
+// Nanoseconds per item of a timed loop
+static double bench_ns_per_item(uint64_t start, uint64_t end, uint32_t count)
+{
+    return count ? (end - start) * 1000.0 / count : 0;
+}
+
+bool bench_json(uint32_t count, const char* report)
+{
+    /* A val event, a selection with its text and a text event with a tag, like the event handlers send */
+    static const char* events[] = {"down", "up", "changed"};
+    const char* text            = "Living room";
+    const char* tag             = "{\"room\":2}";
+    size_t check_writer         = 0;
+    size_t check_printf         = 0;
+    char data[HASP_JSON_STATE_SIZE];
+
+    uint64_t t0 = bench_micros();
+    for(uint32_t i = 0; i < count; i++) {
+        const char* eventname = events[i % 3];
+        {
+            JsonWriter json(data, sizeof(data));
+            json.add_str("event", eventname);
+            json.add_int("val", i);
+            check_writer += strlen(json.end());
+        }
+        {
+            JsonWriter json(data, sizeof(data));
+            json.add_str("event", eventname);
+            json.add_int("val", i);
+            json.add_str("text", text);
+            check_writer += strlen(json.end());
+        }
+        {
+            JsonWriter json(data, sizeof(data));
+            json.add_str("event", eventname);
+            json.add_str("text", text);
+            json.add_json("tag", tag);
+            check_writer += strlen(json.end());
+        }
+    }
+
+    uint64_t t1 = bench_micros();
+    for(uint32_t i = 0; i < count; i++) {
+        const char* eventname = events[i % 3];
+        check_printf += snprintf_P(data, sizeof(data), PSTR("{\"event\":\"%s\",\"val\":%d}"), eventname, (int)i);
+        check_printf += snprintf_P(data, sizeof(data), PSTR("{\"event\":\"%s\",\"val\":%d,\"text\":\"%s\"}"),
+                                   eventname, (int)i, text);
+        check_printf += snprintf_P(data, sizeof(data), PSTR("{\"event\":\"%s\",\"text\":\"%s\",\"tag\":%s}"),
+                                   eventname, text, tag);
+    }
+    uint64_t t2 = bench_micros();
+
+    /* Both produce the same messages for this text, so the lengths must match */
+    DynamicJsonDocument doc(1024);
+    doc["messages"] = count * 3;
+    doc["match"]    = check_writer == check_printf;
+
+    JsonObject writer        = doc.createNestedObject("json_writer");
+    writer["duration_us"]    = t1 - t0;
+    writer["ns_per_message"] = bench_ns_per_item(t0, t1, count * 3);
+    writer["msg_per_sec"]    = t1 > t0 ? count * 3 * 1000000.0 / (t1 - t0) : 0;
+
+    JsonObject format        = doc.createNestedObject("snprintf");
+    format["duration_us"]    = t2 - t1;
+    format["ns_per_message"] = bench_ns_per_item(t1, t2, count * 3);
+    format["msg_per_sec"]    = t2 > t1 ? count * 3 * 1000000.0 / (t2 - t1) : 0;
+
+    haspDevice.pc_is_running = false;
+    return bench_write_report(doc, report);
+}
+
+// Create objects 1 to count on page 1, each container holds the next 7 objects
+static void bench_create_objects(uint16_t count)
+{
+    std::stringstream jsonl;
+    uint16_t parent = 0;
+    for(uint16_t id = 1; id <= count; id++) {
+        jsonl << "{\"page\":1,\"id\":" << id;
+        if(id % 8 == 1) {
+            parent = id;
+            jsonl << ",\"obj\":\"obj\",\"x\":" << (id % 64) * 4 << ",\"w\":64,\"h\":64}\n";
+        } else {
+            jsonl << ",\"obj\":\"btn\",\"parentid\":" << parent << ",\"w\":8,\"h\":8}\n";
+        }
+    }
+
+    uint8_t savedPage = 1;
+    dispatch_parse_jsonl(jsonl, savedPage);
+}
+
+bool bench_lookup(uint32_t count, const char* report)
+{
+    static const uint16_t sizes[] = {16, 64, 128, 254};
+
+    DynamicJsonDocument doc(2048);
+    doc["lookups"]    = count;
+    JsonArray results = doc.createNestedArray("results");
+    bool match        = true;
+
+    hasp_init();
+    for(uint16_t objects : sizes) {
+        haspPages.clear(1);
+        bench_create_objects(objects);
+        lv_obj_t* page = haspPages.get_obj(1);
+
+        /* The same spread of ids for both, the sums of the found objects must match */
+        uintptr_t check_index = 0;
+        uintptr_t check_tree  = 0;
+
+        uint64_t t0 = bench_micros();
+        for(uint32_t i = 0; i < count; i++) {
+            check_index += (uintptr_t)hasp_find_obj_from_page_id(1, 1 + (i * 7919) % objects);
+        }
+        uint64_t t1 = bench_micros();
+        for(uint32_t i = 0; i < count; i++) {
+            check_tree += (uintptr_t)hasp_find_obj_from_parent_id(page, 1 + (i * 7919) % objects);
+        }
+        uint64_t t2 = bench_micros();
+        match &= check_index == check_tree;
+
+        JsonObject result  = results.createNestedObject();
+        result["objects"]  = objects;
+        result["index_ns"] = bench_ns_per_item(t0, t1, count);
+        result["tree_ns"]  = bench_ns_per_item(t1, t2, count);
+    }
+    haspPages.clear(1);
+    doc["match"] = match;
+
+    haspDevice.pc_is_running = false;
+    return bench_write_report(doc, report);
+}
+
+bool bench_attributes(uint32_t count, const char* report)
+{
+    /* Attribute sets that take different paths through the attribute table */
+    static const struct
+    {
+        const char* name;
+        const char* json;
+    } sets[] = {
+        {"common", "{\"x\":10,\"y\":20,\"w\":120,\"h\":50,\"hidden\":false,\"enabled\":true}"},
+        {"style", "{\"radius\":8,\"border_width\":2,\"bg_opa\":255,\"pad_top\":4,\"text_opa\":200}"},
+        {"part_state", "{\"radius20\":8,\"border_width01\":2,\"bg_opa10\":255,\"pad_top20\":4,\"text_opa01\":200}"},
+        {"color", "{\"bg_color\":\"#FF0000\",\"text_color\":\"#00FF00\",\"border_color10\":\"#0000FF\"}"},
+        {"text", "{\"text\":\"Living room\",\"align\":\"center\",\"tag\":\"kitchen\"}"},
+    };
+
+    DynamicJsonDocument doc(2048);
+    doc["count"]      = count;
+    JsonArray results = doc.createNestedArray("results");
+
+    hasp_init();
+    haspPages.clear(1);
+    std::stringstream jsonl("{\"page\":1,\"id\":1,\"obj\":\"btn\"}\n");
+    uint8_t savedPage = 1;
+    dispatch_parse_jsonl(jsonl, savedPage);
+    lv_obj_t* obj = hasp_find_obj_from_page_id(1, 1);
+
+    for(const auto& set : sets) {
+        StaticJsonDocument<512> attributes;
+        deserializeJson(attributes, set.json);
+        JsonObject settings = attributes.as<JsonObject>();
+
+        uint32_t applied = 0;
+        uint64_t t0      = bench_micros();
+        for(uint32_t i = 0; i < count && obj; i++) {
+            applied += hasp_parse_json_attributes(obj, settings);
+        }
+        uint64_t t1 = bench_micros();
+
+        JsonObject result      = results.createNestedObject();
+        result["set"]          = set.name;
+        result["attributes"]   = applied;
+        result["ns_per_attr"]  = bench_ns_per_item(t0, t1, applied);
+        result["attr_per_sec"] = t1 > t0 ? applied * 1000000.0 / (t1 - t0) : 0;
+    }
+    haspPages.clear(1);
+
+    haspDevice.pc_is_running = false;
+    return bench_write_report(doc, report);
+}
+
+#define BENCH_LOAD_PER_PAGE 100 // objects on each page of the generated pages file
+#define BENCH_LOAD_ROUNDS 5
+
+// A pages file with a mix of objects and attributes, 100 objects on each page starting from page 1
+static std::string bench_pages_jsonl(uint16_t objects)
+{
+    static const char* types[] = {"btn", "label", "slider", "switch", "obj"};
+    std::stringstream jsonl;
+
+    for(uint16_t i = 0; i < objects; i++) {
+        uint16_t id = 1 + i % BENCH_LOAD_PER_PAGE;
+        jsonl << "{\"page\":" << 1 + i / BENCH_LOAD_PER_PAGE << ",\"id\":" << id << ",\"obj\":\"" << types[i % 5]
+              << "\",\"x\":" << (id % 10) * 48 << ",\"y\":" << (id / 10) * 32 << ",\"w\":44,\"h\":28";
+        switch(i % 5) {
+            case 0:
+                jsonl << ",\"text\":\"Button " << id << "\",\"radius\":6,\"bg_color\":\"#2C3E50\",\"toggle\":true}\n";
+                break;
+            case 1:
+                jsonl << ",\"text\":\"Label " << id << "\",\"align\":\"center\",\"text_color\":\"#FFFFFF\"}\n";
+                break;
+            case 2:
+                jsonl << ",\"min\":0,\"max\":100,\"val\":" << id << ",\"bg_color10\":\"#E67E22\"}\n";
+                break;
+            case 3:
+                jsonl << ",\"val\":" << id % 2 << ",\"groupid\":1}\n";
+                break;
+            default:
+                jsonl << ",\"border_width\":2,\"pad_top\":4,\"tag\":{\"room\":" << id << "}}\n";
+        }
+    }
+    return jsonl.str();
+}
+
+bool bench_load(uint16_t objects, const char* report)
+{
+    uint8_t pages = (objects + BENCH_LOAD_PER_PAGE - 1) / BENCH_LOAD_PER_PAGE;
+    if(pages > HASP_NUM_PAGES) {
+        pages   = HASP_NUM_PAGES;
+        objects = pages * BENCH_LOAD_PER_PAGE;
+    }
+    std::string jsonl = bench_pages_jsonl(objects);
+
+    DynamicJsonDocument doc(1024);
+    doc["objects"] = objects;
+    doc["pages"]   = pages;
+    doc["bytes"]   = jsonl.length();
+
+    /* Each round starts from empty pages, the first round also warms up the fonts and styles */
+    uint64_t best  = UINT64_MAX;
+    uint64_t total = 0;
+    hasp_init();
+    for(uint8_t round = 0; round < BENCH_LOAD_ROUNDS; round++) {
+        for(uint8_t page = 1; page <= pages; page++) haspPages.clear(page);
+
+        std::stringstream stream(jsonl);
+        uint8_t savedPage = 1;
+        uint64_t t0       = bench_micros();
+        dispatch_parse_jsonl(stream, savedPage);
+        uint64_t duration = bench_micros() - t0;
+
+        total += duration;
+        if(duration < best) best = duration;
+    }
+
+    doc["rounds"]          = BENCH_LOAD_ROUNDS;
+    doc["best_us"]         = (uint32_t)best;
+    doc["avg_us"]          = (uint32_t)(total / BENCH_LOAD_ROUNDS);
+    doc["objects_per_sec"] = best ? objects * 1000000.0 / best : 0;
+
+    bench_add_mem(doc); // with the last round still loaded
+    for(uint8_t page = 1; page <= pages; page++) haspPages.clear(page);
+
+    haspDevice.pc_is_running = false;
+    return bench_write_report(doc, report);
+}
+
+#endif
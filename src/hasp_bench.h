@@ -0,0 +1,64 @@
+/* MIT License - Copyright (c) 2019-2024 Francis Van Roie
+   For full license information read the LICENSE file in the project folder */
+
+#ifndef HASP_BENCH_H
+#define HASP_BENCH_H
+
+#include "hasplib.h"
+
+#if HASP_TARGET_PC && USE_HEADLESS
+
+/**
+ * Replay a script of commands on the headless display and write the measurements as JSON
+ * @param script file with one command per line, like on the console or an MQTT topic and payload
+ * @param pages optional pages file to load before the script starts, or an empty string
+ * @param report file to write the results to, or an empty string for stdout
+ * @return false if a file could not be opened
+ */
+bool bench_run(const char* script, const char* pages, const char* report);
+
+/**
+ * Feed a trace recorded with the mqtttrace command through dispatch_topic_payload
+ * @param trace file with one json message per line
+ * @param speed 1 replays at the recorded pace, 10 ten times faster, 0 as fast as possible
+ * @param pages optional pages file to load before the replay starts, or an empty string
+ * @param report file to write the throughput and latency histogram to, or an empty string for stdout
+ * @return false if a file could not be opened
+ */
+bool bench_replay(const char* trace, float speed, const char* pages, const char* report);
+
+/**
+ * Write val, text and tag state messages with JsonWriter and with the snprintf formats it replaced
+ * @param count number of each kind of message to write
+ * @param report file to write the throughput of both to, or an empty string for stdout
+ * @return false if the report could not be written
+ */
+bool bench_json(uint32_t count, const char* report);
+
+/**
+ * Look up objects on page 1 with the page index and with a walk of the object tree, for 16 to 254 objects
+ * @param count number of lookups of each kind for each number of objects
+ * @param report file to write the time per lookup to, or an empty string for stdout
+ * @return false if the report could not be written
+ */
+bool bench_lookup(uint32_t count, const char* report);
+
+/**
+ * Apply sets of attributes to a button with hasp_parse_json_attributes, like the lines of a pages file
+ * @param count number of times each set is applied
+ * @param report file to write the attributes per second of each set to, or an empty string for stdout
+ * @return false if the report could not be written
+ */
+bool bench_attributes(uint32_t count, const char* report);
+
+/**
+ * Load a generated pages file with dispatch_parse_jsonl, 100 objects on each page
+ * @param objects number of objects in the pages file, 500 to compare with the boot time of a full config
+ * @param report file to write the best and average load time to, or an empty string for stdout
+ * @return false if the report could not be written
+ */
+bool bench_load(uint16_t objects, const char* report);
+
+#endif
+
+#endif
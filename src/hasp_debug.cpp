@@ -37,6 +37,63 @@
 
 bool debugAnsiCodes = false;
 
+/* Memory stats of the log prefix, walking the heaps for every line is too slow when trace logging is on */
+typedef struct
+{
+    uint32_t sampled; // millis() of the last measurement
+    bool valid;
+#ifdef ARDUINO
+    size_t maxfree;
+    size_t totalfree;
+    uint8_t frag;
+#endif
+#if LV_MEM_CUSTOM == 0
+    lv_mem_monitor_t lv_mem;
+#endif
+} debug_mem_stats_t;
+
+static debug_mem_stats_t debugMemStats;
+
+#if HASP_TARGET_ARDUINO && HASP_LOG_BUFFER_SIZE > 0
+static const debug_log_context_t* debugLogContext = NULL; // set while the log task writes a queued line
+
+void debugSetLogContext(const debug_log_context_t* context)
+{
+    debugLogContext = context;
+}
+
+#if LV_MEM_CUSTOM == 0
+/* The log task must not walk the lvgl allocator while the GUI thread uses it,
+ * so the lvgl memory of a queued line is sampled by an lv_task instead */
+static lv_mem_monitor_t debugLvglMemSample;
+#if defined(ESP32)
+static portMUX_TYPE debugLvglMemMux = portMUX_INITIALIZER_UNLOCKED;
+#define DEBUG_MEM_LOCK() portENTER_CRITICAL(&debugLvglMemMux)
+#define DEBUG_MEM_UNLOCK() portEXIT_CRITICAL(&debugLvglMemMux)
+#else
+#define DEBUG_MEM_LOCK()
+#define DEBUG_MEM_UNLOCK()
+#endif
+
+static void debugSampleLvglMemory(lv_task_t* task)
+{
+    lv_mem_monitor_t mem_mon;
+    lv_mem_monitor(&mem_mon);
+
+    DEBUG_MEM_LOCK();
+    debugLvglMemSample = mem_mon;
+    DEBUG_MEM_UNLOCK();
+}
+
+void debugStartMemSampler(void)
+{
+    uint32_t interval = HASP_LOG_MEM_INTERVAL > 0 ? HASP_LOG_MEM_INTERVAL : 100;
+    debugSampleLvglMemory(NULL);
+    lv_task_create(debugSampleLvglMemory, interval, LV_TASK_PRIO_LOWEST, NULL);
+}
+#endif // LV_MEM_CUSTOM
+#endif
+
 inline void debugSendAnsiCode(const __FlashStringHelper* code, Print* _logOutput)
 {
 #ifdef ARDUINO
@@ -73,10 +130,19 @@ static void debugPrintTimestamp(int level, Print* _logOutput)
 { /* Print Current Time */
 
     timeval curTime;
-    int rslt     = gettimeofday(&curTime, NULL);
+    uint32_t msecs;
+#if HASP_TARGET_ARDUINO && HASP_LOG_BUFFER_SIZE > 0
+    if(debugLogContext) { // time the line was queued
+        curTime = debugLogContext->time;
+        msecs   = debugLogContext->millis;
+    } else
+#endif
+    {
+        gettimeofday(&curTime, NULL);
+        msecs = millis();
+    }
     time_t t     = curTime.tv_sec;
     tm* timeinfo = localtime(&t);
-    (void)rslt; // unused
 
     debugSendAnsiCode(F(TERM_COLOR_CYAN), _logOutput);
 
@@ -94,7 +160,6 @@ static void debugPrintTimestamp(int level, Print* _logOutput)
 
     } else {
 
-        uint32_t msecs = millis();
 #ifdef ARDUINO
         _logOutput->printf(PSTR("[" D_TIME_MILLIS ".%03d]"), msecs / 1000, msecs % 1000);
 #else
@@ -147,7 +212,12 @@ void debugStart(void)
 }
 
 void debugStop()
-{}
+{
+#if HASP_TARGET_ARDUINO && HASP_LOG_BUFFER_SIZE > 0
+    debugFlushLog();
+    Log.setQueue(NULL); // the last lines before a reboot are written right away
+#endif
+}
 
 /* ===== Special Event Processors ===== */
 
@@ -343,12 +413,44 @@ void debug_get_tag(uint8_t tag, char* buffer)
     }
 }
 
+// Measure the memory at most once per HASP_LOG_MEM_INTERVAL, the log lines in between reuse the values
+static const debug_mem_stats_t* debugGetMemStats()
+{
+#if HASP_LOG_MEM_INTERVAL > 0
+    if(debugMemStats.valid && millis() - debugMemStats.sampled < HASP_LOG_MEM_INTERVAL) return &debugMemStats;
+#endif
+
+#ifdef ARDUINO
+    debugMemStats.maxfree   = haspDevice.get_free_max_block();
+    debugMemStats.totalfree = haspDevice.get_free_heap();
+    debugMemStats.frag      = haspDevice.get_heap_fragmentation();
+#endif
+#if LV_MEM_CUSTOM == 0
+#if HASP_TARGET_ARDUINO && HASP_LOG_BUFFER_SIZE > 0
+    if(debugLogContext) { // written by the log task
+        DEBUG_MEM_LOCK();
+        debugMemStats.lv_mem = debugLvglMemSample;
+        DEBUG_MEM_UNLOCK();
+    } else {
+        lv_mem_monitor(&debugMemStats.lv_mem);
+    }
+#else
+    lv_mem_monitor(&debugMemStats.lv_mem);
+#endif
+#endif
+
+    debugMemStats.sampled = millis();
+    debugMemStats.valid   = true;
+    return &debugMemStats;
+}
+
 static void debugPrintHaspMemory(int level, Print* _logOutput)
 {
 #ifdef ARDUINO
-    size_t maxfree   = haspDevice.get_free_max_block();
-    size_t totalfree = haspDevice.get_free_heap();
-    uint8_t frag     = haspDevice.get_heap_fragmentation();
+    const debug_mem_stats_t* stats = debugGetMemStats();
+    size_t maxfree                 = stats->maxfree;
+    size_t totalfree               = stats->totalfree;
+    uint8_t frag                   = stats->frag;
 
     /* Print HASP Memory Info */
     if(debugAnsiCodes) {
@@ -366,8 +468,7 @@ static void debugPrintHaspMemory(int level, Print* _logOutput)
 static void debugPrintLvglMemory(int level, Print* _logOutput)
 {
 #if LV_MEM_CUSTOM == 0
-    lv_mem_monitor_t mem_mon;
-    lv_mem_monitor(&mem_mon);
+    const lv_mem_monitor_t& mem_mon = debugGetMemStats()->lv_mem;
 
     /* Print LVGL Memory Info */
     if(debugAnsiCodes) {
@@ -392,6 +493,12 @@ static void debugPrintLvglMemory(int level, Print* _logOutput)
 #if defined(ESP32) && defined(HASP_LOG_TASKS)
 static void debugPrintTaskName(int level, Print* _logOutput)
 {
+#if HASP_LOG_BUFFER_SIZE > 0
+    if(debugLogContext) { // task that queued the line
+        debug_print(_logOutput, "[%s%6u]", debugLogContext->task, debugLogContext->stack);
+        return;
+    }
+#endif
     debug_print(_logOutput, "[%s%6u]", pcTaskGetTaskName(NULL), uxTaskGetStackHighWaterMark(NULL));
 }
 #endif
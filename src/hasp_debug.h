@@ -151,6 +151,25 @@ bool debugSyslogPrefix(uint8_t tag, int level, Print* _logOutput, const char* pr
 }
 #endif
 
+#if HASP_TARGET_ARDUINO && HASP_LOG_BUFFER_SIZE > 0
+#include <sys/time.h>
+
+/* Time and task of a queued log line, used for its prefix when the log task writes it */
+typedef struct
+{
+    timeval time;
+    uint32_t millis;
+#if defined(ESP32) && defined(HASP_LOG_TASKS)
+    const char* task;
+    uint32_t stack;
+#endif
+} debug_log_context_t;
+
+void debugSetLogContext(const debug_log_context_t* context);
+void debugStartMemSampler(void); // on the GUI thread, after lvgl is initialized
+void debugFlushLog(void);
+#endif
+
 /* ===== Read/Write Configuration ===== */
 #if HASP_USE_CONFIG > 0
 bool debugGetConfig(const JsonObject& settings);
@@ -30,6 +30,10 @@ static TaskHandle_t g_lvgl_task_handle;
 
 #define LVGL_TICK_PERIOD 20
 
+#ifndef GUI_DIRTY_LOG_SIZE
+#define GUI_DIRTY_LOG_SIZE 32 // flushed areas remembered for the screenshot delta stream
+#endif
+
 #ifndef TFT_BCKL
 #define TFT_BCKL -1 // No Backlight Control
 #endif
@@ -54,10 +58,46 @@ uint16_t tft_height = TFT_HEIGHT;
 
 bool screenshotIsDirty  = true;
 uint32_t screenshotEtag = 0;
+
+#if HASP_USE_HTTP > 0
+/* Areas flushed to the display, for the screenshot delta stream */
+struct gui_dirty_area_t
+{
+    uint32_t seq; // refresh that flushed the area
+    lv_area_t area;
+};
+static gui_dirty_area_t gui_dirty_log[GUI_DIRTY_LOG_SIZE];
+static uint8_t gui_dirty_next;
+static uint32_t gui_dirty_seq;  // last completed refresh
+static uint32_t gui_dirty_lost; // areas flushed up to this refresh are no longer all in the log
+static bool gui_screenshot_busy;
+#endif
 void (*drv_display_flush_cb)(struct _disp_drv_t* disp_drv, const lv_area_t* area, lv_color_t* color_p);
 
 static lv_disp_buf_t disp_buf;
 
+/* Refresh statistics, collected by the monitor callback */
+static gui_perf_t gui_perf;
+static uint32_t gui_perf_start;
+static uint16_t gui_frame_count;
+static uint32_t gui_refresh_time;
+static uint32_t gui_flush_time;
+static bool gui_first_frame_pending;
+
+static lv_color_t* gui_alloc_vdb(size_t size)
+{
+#ifdef ESP32
+#if LV_VDB_PSRAM > 0
+    if(psramFound())
+        return (lv_color_t*)heap_caps_malloc(sizeof(lv_color_t) * size, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+#endif
+    return (lv_color_t*)heap_caps_malloc(sizeof(lv_color_t) * size,
+                                         MALLOC_CAP_INTERNAL | MALLOC_CAP_DMA | MALLOC_CAP_8BIT);
+#else
+    return (lv_color_t*)malloc(sizeof(lv_color_t) * size);
+#endif
+}
+
 static inline void gui_init_lvgl()
 {
     LOG_VERBOSE(TAG_LVGL, F("Version    : %u.%u.%u %s"), LVGL_VERSION_MAJOR, LVGL_VERSION_MINOR, LVGL_VERSION_PATCH,
@@ -70,12 +110,12 @@ static inline void gui_init_lvgl()
 #endif
 
     /* Create the Virtual Device Buffers */
-    const size_t guiVDBsize = LV_VDB_SIZE / sizeof(lv_color_t);
-#ifdef ESP32
-    static lv_color_t* guiVdbBuffer1 =
-        (lv_color_t*)heap_caps_malloc(sizeof(lv_color_t) * guiVDBsize, MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+    const size_t guiVDBsize          = LV_VDB_SIZE / sizeof(lv_color_t);
+    static lv_color_t* guiVdbBuffer1 = gui_alloc_vdb(guiVDBsize);
+#if LV_VDB_DOUBLE > 0
+    static lv_color_t* guiVdbBuffer2 = gui_alloc_vdb(guiVDBsize); // render the next stripe while flushing
 #else
-    static lv_color_t* guiVdbBuffer1 = (lv_color_t*)malloc(sizeof(lv_color_t) * guiVDBsize);
+    static lv_color_t* guiVdbBuffer2 = NULL;
 #endif
 
     /* Static VDB allocation */
@@ -84,7 +124,7 @@ static inline void gui_init_lvgl()
 
     /* Initialize VDB */
     if(guiVdbBuffer1 && guiVDBsize > 0) {
-        lv_disp_buf_init(&disp_buf, guiVdbBuffer1, NULL, guiVDBsize);
+        lv_disp_buf_init(&disp_buf, guiVdbBuffer1, guiVdbBuffer2, guiVDBsize);
     } else {
         LOG_FATAL(TAG_GUI, F(D_ERROR_OUT_OF_MEMORY));
     }
@@ -92,7 +132,7 @@ static inline void gui_init_lvgl()
 #ifdef LV_MEM_SIZE
     LOG_VERBOSE(TAG_LVGL, F("MEM size   : %d"), LV_MEM_SIZE);
 #endif
-    LOG_VERBOSE(TAG_LVGL, F("VFB size   : %d"), (size_t)sizeof(lv_color_t) * guiVDBsize);
+    LOG_VERBOSE(TAG_LVGL, F("VFB size   : %d x %d"), (size_t)sizeof(lv_color_t) * guiVDBsize, guiVdbBuffer2 ? 2 : 1);
 }
 
 void gui_hide_pointer(bool hidden)
@@ -100,10 +140,41 @@ void gui_hide_pointer(bool hidden)
     if(cursor) lv_obj_set_hidden(cursor, hidden || !gui_settings.show_pointer);
 }
 
+#if HASP_USE_HTTP > 0
+/* Remember the area flushed by the refresh in progress */
+static inline void gui_dirty_add(lv_disp_drv_t* disp, const lv_area_t* area)
+{
+    uint32_t seq = gui_dirty_seq + 1;
+
+    if(disp->sw_rotate) { // the area is in panel coordinates, clients need a full frame
+        gui_dirty_lost = seq;
+        return;
+    }
+
+    /* Consecutive stripes of the same area are joined */
+    gui_dirty_area_t& last = gui_dirty_log[(gui_dirty_next + GUI_DIRTY_LOG_SIZE - 1) % GUI_DIRTY_LOG_SIZE];
+    if(last.seq == seq && last.area.x1 == area->x1 && last.area.x2 == area->x2 && last.area.y2 + 1 == area->y1) {
+        last.area.y2 = area->y2;
+        return;
+    }
+
+    gui_dirty_area_t& entry = gui_dirty_log[gui_dirty_next];
+    if(entry.seq > gui_dirty_lost) gui_dirty_lost = entry.seq;
+    entry.seq      = seq;
+    entry.area     = *area;
+    gui_dirty_next = (gui_dirty_next + 1) % GUI_DIRTY_LOG_SIZE;
+}
+#endif
+
 IRAM_ATTR void gui_flush_cb(lv_disp_drv_t* disp, const lv_area_t* area, lv_color_t* color_p)
 {
+    uint32_t start = millis();
     haspTft.flush_pixels(disp, area, color_p);
+    gui_flush_time += millis() - start; // time lvgl is blocked, not the transfer time
     screenshotIsDirty = true;
+#if HASP_USE_HTTP > 0
+    if(!gui_screenshot_busy) gui_dirty_add(disp, area);
+#endif
 }
 
 void gui_antiburn_cb(lv_disp_drv_t* disp, const lv_area_t* area, lv_color_t* color_p)
@@ -129,9 +200,54 @@ void gui_antiburn_cb(lv_disp_drv_t* disp, const lv_area_t* area, lv_color_t* col
 
 IRAM_ATTR void gui_monitor_cb(lv_disp_drv_t* disp_drv, uint32_t time, uint32_t px)
 {
+#ifdef HASP_TFT_ASYNC_FLUSH
+    haspTft.flush_end(); // the last stripe of this refresh may still be transferring
+#endif
+
     // if(screenshotIsDirty) return;
     LOG_DEBUG(TAG_GUI, F("The Screen is dirty"));
     screenshotIsDirty = true;
+#if HASP_USE_HTTP > 0
+    if(!gui_screenshot_busy) gui_dirty_seq++;
+#endif
+
+    gui_frame_count++;
+    gui_refresh_time += time;
+    gui_perf.frames++;
+
+    uint32_t now = millis();
+    if(gui_first_frame_pending) {
+        gui_first_frame_pending = false;
+        gui_perf.first_frame_ms = now;
+        LOG_INFO(TAG_GUI, F("First frame drawn after %u ms"), now);
+    }
+    if(now - gui_perf_start >= 1000) {
+        gui_perf.fps        = gui_frame_count * 1000 / (now - gui_perf_start);
+        gui_perf.refresh_ms = gui_refresh_time / gui_frame_count;
+        gui_perf.flush_ms   = gui_flush_time / gui_frame_count;
+
+        gui_perf_start   = now;
+        gui_frame_count  = 0;
+        gui_refresh_time = 0;
+        gui_flush_time   = 0;
+    }
+}
+
+gui_perf_t gui_get_perf(void)
+{
+    if(millis() - gui_perf_start > 2000) { // no refresh happened recently
+        gui_perf_t idle     = {};
+        idle.first_frame_ms = gui_perf.first_frame_ms;
+        idle.frames         = gui_perf.frames;
+        return idle;
+    }
+    return gui_perf;
+}
+
+// Log the time until the next refresh has finished, called when the start page is loaded
+void gui_measure_first_frame(void)
+{
+    gui_first_frame_pending = true;
 }
 
 IRAM_ATTR bool gui_touch_read(lv_indev_drv_t* indev_driver, lv_indev_data_t* data)
@@ -199,6 +315,14 @@ static inline void gui_init_images()
     lv_split_jpeg_init(); // Initialize JPG decoder
 #endif
 
+#if HASP_USE_RLEDECODE > 0 && LV_USE_FILESYSTEM > 0
+    image_rle_init(); // Initialize RLE .bin decoder
+#endif
+
+#if HASP_IMAGE_DECODE_CACHE > 0 && LV_USE_FILESYSTEM > 0
+    image_cache_setup(); // Keep the decoded images of the decoders above
+#endif
+
 #if defined(ARDUINO_ARCH_ESP32)
     if(hasp_use_psram()) lv_img_cache_set_size(LV_IMG_CACHE_DEF_SIZE_PSRAM);
 #endif
@@ -226,6 +350,9 @@ void guiSetup()
     gui_init_images();
     gui_init_filesystems();
     font_setup();
+#if HASP_TARGET_ARDUINO && HASP_LOG_BUFFER_SIZE > 0 && LV_MEM_CUSTOM == 0
+    debugStartMemSampler(); // lvgl memory for the log prefix of queued lines
+#endif
 
     /* Initialize the LVGL display driver with correct orientation */
 #if(TOUCH_DRIVER == 0x2046) ||                                                                                         \
@@ -666,6 +793,175 @@ void gui_flush_not_complete()
 {
     LOG_WARNING(TAG_GUI, F("Pixelbuffer not completely sent"));
 }
+
+/* Buffered output of the encoded screenshot formats */
+static uint8_t* gui_out_buf;
+static size_t gui_out_len;
+static size_t gui_out_size;
+static void (*gui_out_sink)(const uint8_t* buf, size_t size);
+
+static void gui_out_begin(uint8_t* buffer, size_t size, void (*sink)(const uint8_t* buf, size_t size))
+{
+    gui_out_buf  = buffer;
+    gui_out_size = size;
+    gui_out_len  = 0;
+    gui_out_sink = sink;
+}
+
+static void gui_out_flush()
+{
+    if(gui_out_len) gui_out_sink(gui_out_buf, gui_out_len);
+    gui_out_len = 0;
+}
+
+static void gui_out_write(const void* data, size_t len)
+{
+    const uint8_t* p = (const uint8_t*)data;
+    while(len > 0) {
+        if(gui_out_len == gui_out_size) gui_out_flush();
+        size_t n = gui_out_size - gui_out_len;
+        if(n > len) n = len;
+        memcpy(gui_out_buf + gui_out_len, p, n);
+        gui_out_len += n;
+        p += n;
+        len -= n;
+    }
+}
+
+static inline void gui_out_byte(uint8_t value)
+{
+    if(gui_out_len == gui_out_size) gui_out_flush();
+    gui_out_buf[gui_out_len++] = value;
+}
+
+static void gui_out_write16(uint16_t value)
+{
+    gui_out_byte(value);
+    gui_out_byte(value >> 8);
+}
+
+/* QOI encoder, https://qoiformat.org
+ *
+ * The pixels are encoded as lvgl flushes the stripes of a full screen refresh, so only the encoder state
+ * and a small output buffer are needed instead of a frame buffer.
+ */
+#define QOI_OP_INDEX 0x00
+#define QOI_OP_DIFF 0x40
+#define QOI_OP_LUMA 0x80
+#define QOI_OP_RUN 0xC0
+#define QOI_OP_RGB 0xFE
+
+struct gui_qoi_t
+{
+    uint32_t index[64]; // recently seen pixels as 0xAARRGGBB
+    uint32_t prev;
+    uint8_t run;
+};
+static gui_qoi_t* gui_qoi;
+static bool gui_screenshot_to_screen; // also flush the encoded stripes to the display
+
+static void gui_qoi_begin(gui_qoi_t* qoi, uint32_t width, uint32_t height)
+{
+    memset(qoi, 0, sizeof(gui_qoi_t));
+    qoi->prev = 0xFF000000;
+    gui_qoi   = qoi;
+
+    uint8_t header[14] = {'q',
+                          'o',
+                          'i',
+                          'f',
+                          (uint8_t)(width >> 24),
+                          (uint8_t)(width >> 16),
+                          (uint8_t)(width >> 8),
+                          (uint8_t)width,
+                          (uint8_t)(height >> 24),
+                          (uint8_t)(height >> 16),
+                          (uint8_t)(height >> 8),
+                          (uint8_t)height,
+                          3,  // RGB
+                          0}; // sRGB with linear alpha
+    gui_out_write(header, sizeof(header));
+}
+
+static void gui_qoi_encode(const lv_color_t* color_p, size_t count)
+{
+    gui_qoi_t* qoi = gui_qoi;
+
+    for(size_t i = 0; i < count; i++) {
+        uint32_t px = lv_color_to32(color_p[i]) | 0xFF000000;
+
+        if(px == qoi->prev) {
+            if(++qoi->run == 62) {
+                gui_out_byte(QOI_OP_RUN | (qoi->run - 1));
+                qoi->run = 0;
+            }
+            continue;
+        }
+
+        if(qoi->run) {
+            gui_out_byte(QOI_OP_RUN | (qoi->run - 1));
+            qoi->run = 0;
+        }
+
+        uint8_t r    = px >> 16;
+        uint8_t g    = px >> 8;
+        uint8_t b    = px;
+        uint8_t hash = (r * 3 + g * 5 + b * 7 + 255 * 11) % 64;
+
+        if(qoi->index[hash] == px) {
+            gui_out_byte(QOI_OP_INDEX | hash);
+        } else {
+            qoi->index[hash] = px;
+
+            int8_t vr   = r - (uint8_t)(qoi->prev >> 16);
+            int8_t vg   = g - (uint8_t)(qoi->prev >> 8);
+            int8_t vb   = b - (uint8_t)qoi->prev;
+            int8_t vg_r = vr - vg;
+            int8_t vg_b = vb - vg;
+
+            if(vr > -3 && vr < 2 && vg > -3 && vg < 2 && vb > -3 && vb < 2) {
+                gui_out_byte(QOI_OP_DIFF | (vr + 2) << 4 | (vg + 2) << 2 | (vb + 2));
+            } else if(vg_r > -9 && vg_r < 8 && vg > -33 && vg < 32 && vg_b > -9 && vg_b < 8) {
+                gui_out_byte(QOI_OP_LUMA | (vg + 32));
+                gui_out_byte((vg_r + 8) << 4 | (vg_b + 8));
+            } else {
+                gui_out_byte(QOI_OP_RGB);
+                gui_out_byte(r);
+                gui_out_byte(g);
+                gui_out_byte(b);
+            }
+        }
+        qoi->prev = px;
+    }
+}
+
+static void gui_qoi_end()
+{
+    if(gui_qoi->run) gui_out_byte(QOI_OP_RUN | (gui_qoi->run - 1));
+
+    static const uint8_t padding[8] = {0, 0, 0, 0, 0, 0, 0, 1};
+    gui_out_write(padding, sizeof(padding));
+    gui_out_flush();
+    gui_qoi = NULL;
+}
+
+/* Encode VDB pixels to QOI */
+static void gui_screenshot_to_qoi(lv_disp_drv_t* disp, const lv_area_t* area, lv_color_t* color_p)
+{
+    gui_qoi_encode(color_p, lv_area_get_size(area));
+
+    if(gui_screenshot_to_screen)
+        drv_display_flush_cb(disp, area, color_p); // indirect callback to flush screenshot data to the screen
+    else
+        lv_disp_flush_ready(disp);
+}
+
+gui_screenshot_format_t gui_screenshot_get_format(const char* name)
+{
+    const char* ext = strrchr(name, '.');
+    if(ext) name = ext + 1;
+    return strcasecmp_P(name, PSTR("qoi")) ? GUI_SCREENSHOT_BMP : GUI_SCREENSHOT_QOI;
+}
 #endif // HASP_USE_SPIFFS > 0 || HASP_USE_LITTLEFS > 0 || HASP_USE_HTTP > 0
 
 #if HASP_USE_SPIFFS > 0 || HASP_USE_LITTLEFS > 0
@@ -690,13 +986,44 @@ static void gui_screenshot_to_file(lv_disp_drv_t* disp, const lv_area_t* area, l
  * @param[in] pFileName   Output binary file name.
  *
  **/
+static void gui_out_to_file(const uint8_t* buf, size_t size)
+{
+    if(pFileOut.write(buf, size) != size) gui_flush_not_complete();
+}
+
+static void gui_screenshot_qoi_to_file(const char* pFileName)
+{
+    uint8_t buffer[512];
+    gui_qoi_t qoi;
+    lv_disp_t* disp = lv_disp_get_default();
+
+    gui_out_begin(buffer, sizeof(buffer), gui_out_to_file);
+    gui_qoi_begin(&qoi, lv_disp_get_hor_res(disp), lv_disp_get_ver_res(disp));
+
+    /* Refresh screen to screenshot callback */
+    gui_screenshot_to_screen = true;
+    drv_display_flush_cb     = disp->driver.flush_cb; /* store callback */
+    disp->driver.flush_cb    = gui_screenshot_to_qoi;
+
+    lv_obj_invalidate(lv_scr_act());
+    lv_refr_now(NULL);                            /* Will call our disp_drv.disp_flush function */
+    disp->driver.flush_cb = drv_display_flush_cb; /* restore callback */
+
+    gui_qoi_end();
+    LOG_VERBOSE(TAG_GUI, F("QOI data flushed to %s"), pFileName);
+}
+
 void guiTakeScreenshot(const char* pFileName)
 {
     uint8_t buffer[sizeof(bmp_header_t) + 2];
     gui_get_bitmap_header(buffer, sizeof(buffer));
 
     pFileOut = HASP_FS.open(pFileName, "w");
-    if(pFileOut) {
+    if(pFileOut && gui_screenshot_get_format(pFileName) == GUI_SCREENSHOT_QOI) {
+        gui_screenshot_qoi_to_file(pFileName);
+        pFileOut.close();
+
+    } else if(pFileOut) {
 
         size_t len = pFileOut.write(buffer, sizeof(buffer));
         if(len == sizeof(buffer)) {
@@ -749,21 +1076,39 @@ static void gui_screenshot_to_both(lv_disp_drv_t* disp, const lv_area_t* area, l
  * Flush buffer into a http client.
  *
  * @note: data pixel should be formatted to uint16_t RGB. Set by Bitmap header.
+ * @note: QOI is sent as chunked data, the response must be started with an unknown content length.
+ *
+ * @param[in] format   Image format to send.
  *
  **/
-void guiTakeScreenshot()
+void guiTakeScreenshot(gui_screenshot_format_t format)
 {
     uint8_t buffer[sizeof(bmp_header_t) + 2];
-    gui_get_bitmap_header(buffer, sizeof(buffer));
+    uint8_t qoi_buffer[512];
+    gui_qoi_t qoi;
+    lv_disp_t* disp = lv_disp_get_default();
+    bool sent;
+
+    if(format == GUI_SCREENSHOT_QOI) {
+        gui_out_begin(qoi_buffer, sizeof(qoi_buffer), httpClientWriteChunk);
+        gui_qoi_begin(&qoi, lv_disp_get_hor_res(disp), lv_disp_get_ver_res(disp));
+        sent = true;
+    } else {
+        gui_get_bitmap_header(buffer, sizeof(buffer));
+        sent = httpClientWrite(buffer, sizeof(buffer)) == sizeof(buffer);
+    }
 
-    if(httpClientWrite(buffer, sizeof(buffer)) == sizeof(buffer)) {
+    if(sent) {
         LOG_VERBOSE(TAG_GUI, F("Bitmap header sent"));
 
-        lv_disp_t* disp      = lv_disp_get_default();
+        lv_refr_now(NULL); /* Pending changes are flushed normally, so the delta stream sees them */
+        gui_screenshot_busy = true;
+
         drv_display_flush_cb = disp->driver.flush_cb; /* store callback */
 
         if(disp->driver.sw_rotate) {
-            disp->driver.flush_cb  = gui_screenshot_to_http;
+            gui_screenshot_to_screen = false;
+            disp->driver.flush_cb = format == GUI_SCREENSHOT_QOI ? gui_screenshot_to_qoi : gui_screenshot_to_http;
             disp->driver.sw_rotate = 0;
             lv_obj_invalidate(lv_scr_act());
             lv_refr_now(NULL);                            /* Will call our disp_drv.disp_flush function */
@@ -774,13 +1119,16 @@ void guiTakeScreenshot()
             lv_refr_now(NULL);
         } else {
             /* Refresh screen to screenshot callback */
-            disp->driver.flush_cb = gui_screenshot_to_both;
+            gui_screenshot_to_screen = true;
+            disp->driver.flush_cb = format == GUI_SCREENSHOT_QOI ? gui_screenshot_to_qoi : gui_screenshot_to_both;
             lv_obj_invalidate(lv_scr_act());
             lv_refr_now(NULL);                            /* Will call our disp_drv.disp_flush function */
             disp->driver.flush_cb = drv_display_flush_cb; /* restore callback */
         }
 
-        screenshotIsDirty = false;
+        if(format == GUI_SCREENSHOT_QOI) gui_qoi_end();
+        gui_screenshot_busy = false;
+        screenshotIsDirty   = false;
         LOG_VERBOSE(TAG_GUI, F("Bitmap data flushed to webclient"));
     } else {
         LOG_ERROR(TAG_GUI, F("Data sent does not match header size"));
@@ -798,4 +1146,151 @@ uint32_t guiScreenshotEtag()
     LOG_DEBUG(TAG_GUI, F("The ETag is %u"), screenshotEtag);
     return screenshotEtag;
 }
+
+/* Screenshot delta stream
+ *
+ * Only the areas flushed since the sequence the client already has are rendered again and sent, with
+ * the pixels run length encoded. A client without a usable sequence gets the full screen.
+ * Layout, all values little endian:
+ *   header : "HSPD", version u8, bytes per pixel u8, flags u8, reserved u8, width u16, height u16, sequence u32
+ *   area   : x1 u16, y1 u16, x2 u16, y2 u16, followed by runs covering the area row by row
+ *   run    : ctrl u8, 0x00-0x7F = ctrl + 1 literal pixels follow, 0x80-0xFF = next pixel repeated (ctrl & 0x7F) + 1
+ *   end    : x1 = 0xFFFF
+ */
+#define GUI_DELTA_MAX_AREAS 8
+#define GUI_DELTA_FULL_FRAME 0x01
+#define GUI_DELTA_SWAPPED 0x02
+
+/* Flush VDB pixels as a run length encoded area to a webclient */
+static void gui_screenshot_delta_to_http(lv_disp_drv_t* disp, const lv_area_t* area, lv_color_t* color_p)
+{
+    gui_out_write16(area->x1);
+    gui_out_write16(area->y1);
+    gui_out_write16(area->x2);
+    gui_out_write16(area->y2);
+
+    size_t count = lv_area_get_size(area);
+    size_t i     = 0;
+    while(i < count) {
+        size_t run = 1;
+        while(i + run < count && run < 128 && color_p[i + run].full == color_p[i].full) run++;
+
+        if(run > 1) {
+            uint8_t ctrl = 0x80 | (run - 1);
+            gui_out_write(&ctrl, 1);
+            gui_out_write(color_p + i, sizeof(lv_color_t));
+        } else {
+            /* Literal pixels up to the start of the next repeat */
+            while(i + run < count && run < 128 &&
+                  !(i + run + 1 < count && color_p[i + run].full == color_p[i + run + 1].full))
+                run++;
+            uint8_t ctrl = run - 1;
+            gui_out_write(&ctrl, 1);
+            gui_out_write(color_p + i, run * sizeof(lv_color_t));
+        }
+        i += run;
+    }
+
+    lv_disp_flush_ready(disp);
+}
+
+/* Collect the areas flushed after a sequence, overlapping areas are joined */
+static uint8_t gui_dirty_collect(uint32_t since, lv_area_t* areas)
+{
+    uint8_t count = 0;
+
+    for(uint8_t i = 0; i < GUI_DIRTY_LOG_SIZE; i++) {
+        const gui_dirty_area_t& entry = gui_dirty_log[i];
+        if(entry.seq <= since) continue;
+
+        /* Join with an overlapping area, or with the one that grows least when the list is full */
+        uint8_t best        = count;
+        uint32_t best_extra = UINT32_MAX;
+        for(uint8_t j = 0; j < count; j++) {
+            lv_area_t joined;
+            _lv_area_join(&joined, &areas[j], &entry.area);
+            uint32_t extra = lv_area_get_size(&joined) - lv_area_get_size(&areas[j]);
+            if(_lv_area_is_on(&areas[j], &entry.area)) extra = 0;
+            if(extra < best_extra) {
+                best       = j;
+                best_extra = extra;
+            }
+        }
+
+        if(best < count && (best_extra == 0 || count == GUI_DELTA_MAX_AREAS)) {
+            _lv_area_join(&areas[best], &areas[best], &entry.area);
+        } else {
+            areas[count++] = entry.area;
+        }
+    }
+
+    return count;
+}
+
+/**
+ * Current screenshot sequence, increases with every display refresh
+ */
+uint32_t guiScreenshotSequence()
+{
+    return gui_dirty_seq;
+}
+
+/** Take Screenshot Delta.
+ *
+ * Send the areas that changed since a previous delta to a http client.
+ *
+ * @param[in] since   Sequence received in the previous delta, 0 for a full frame.
+ *
+ **/
+void guiTakeScreenshotDelta(uint32_t since)
+{
+    lv_refr_now(NULL); /* Pending changes are flushed normally first, so they are part of this delta */
+
+    lv_disp_t* disp = lv_disp_get_default();
+    lv_area_t areas[GUI_DELTA_MAX_AREAS];
+    uint8_t count = 0;
+    uint8_t flags = LV_COLOR_16_SWAP ? GUI_DELTA_SWAPPED : 0;
+
+    if(since > 0 && since >= gui_dirty_lost && since <= gui_dirty_seq) {
+        count = gui_dirty_collect(since, areas);
+    } else {
+        lv_area_set(&areas[0], 0, 0, lv_disp_get_hor_res(disp) - 1, lv_disp_get_ver_res(disp) - 1);
+        count = 1;
+        flags |= GUI_DELTA_FULL_FRAME;
+    }
+
+    uint8_t buffer[512];
+    gui_out_begin(buffer, sizeof(buffer), httpClientWriteChunk);
+
+    uint8_t header[8] = {'H', 'S', 'P', 'D', 1, sizeof(lv_color_t), flags, 0};
+    gui_out_write(header, sizeof(header));
+    gui_out_write16(lv_disp_get_hor_res(disp));
+    gui_out_write16(lv_disp_get_ver_res(disp));
+    gui_out_write16(gui_dirty_seq);
+    gui_out_write16(gui_dirty_seq >> 16);
+
+    if(count > 0) {
+        gui_screenshot_busy  = true;
+        drv_display_flush_cb = disp->driver.flush_cb; /* store callback */
+        disp->driver.flush_cb = gui_screenshot_delta_to_http;
+        uint8_t sw_rotate      = disp->driver.sw_rotate;
+        disp->driver.sw_rotate = 0;
+
+        for(uint8_t i = 0; i < count; i++) _lv_inv_area(disp, &areas[i]);
+        lv_refr_now(disp); /* Will call our disp_drv.disp_flush function */
+
+        disp->driver.flush_cb  = drv_display_flush_cb; /* restore callback */
+        disp->driver.sw_rotate = sw_rotate;
+        if(sw_rotate) { /* redraw to screen */
+            for(uint8_t i = 0; i < count; i++) _lv_inv_area(disp, &areas[i]);
+            lv_refr_now(disp);
+        }
+        gui_screenshot_busy = false;
+    }
+
+    gui_out_write16(0xFFFF);
+    gui_out_flush();
+
+    LOG_VERBOSE(TAG_GUI, F("Screenshot delta %u..%u sent with %u areas"), since, gui_dirty_seq, count);
+}
 #endif
@@ -40,6 +40,20 @@ struct gui_conf_t
 #endif
 };
 
+enum gui_screenshot_format_t {
+    GUI_SCREENSHOT_BMP, // uncompressed RGB565 with a bitfields header
+    GUI_SCREENSHOT_QOI, // Quite OK Image format, RGB888
+};
+
+struct gui_perf_t
+{
+    uint16_t fps;            // refreshes during the last second
+    uint16_t refresh_ms;     // average render and flush time of a refresh
+    uint16_t flush_ms;       // average time lvgl was blocked in the flush callback per refresh
+    uint32_t first_frame_ms; // time since boot when the start page was first drawn
+    uint32_t frames;         // refreshes since boot
+};
+
 /* ===== Default Event Processors ===== */
 void guiTftInit(void);
 void guiSetup(void);
@@ -51,10 +65,15 @@ void gui_hide_pointer(bool hidden);
 
 /* ===== Special Event Processors ===== */
 void guiCalibrate(void);
-void guiTakeScreenshot(const char* pFileName); // to file
-void guiTakeScreenshot(void);                  // webclient
+gui_screenshot_format_t gui_screenshot_get_format(const char* name);
+void guiTakeScreenshot(const char* pFileName);                            // to file
+void guiTakeScreenshot(gui_screenshot_format_t format = GUI_SCREENSHOT_BMP); // webclient
 bool guiScreenshotIsDirty();
 uint32_t guiScreenshotEtag();
+uint32_t guiScreenshotSequence();
+void guiTakeScreenshotDelta(uint32_t since); // webclient, changed areas only
+gui_perf_t gui_get_perf(void);
+void gui_measure_first_frame(void);
 
 /* ===== Callbacks ===== */
 void gui_flush_cb(lv_disp_drv_t* disp, const lv_area_t* area, lv_color_t* color_p);
@@ -32,6 +32,13 @@
 #include "hasp/hasp_object.h"
 #include "hasp/hasp_page.h"
 #include "hasp/hasp_parser.h"
+#include "hasp/hasp_jsonl.h"
+#include "hasp/hasp_json_writer.h"
+#include "hasp/hasp_clock.h"
+#include "hasp/hasp_image_fetch.h"
+#include "hasp/hasp_image_cache.h"
+#include "hasp/hasp_image_rle.h"
+#include "hasp/hasp_pagecache.h"
 #include "hasp/hasp_lvfs.h"
 
 #include "hasp/lv_theme_hasp.h"
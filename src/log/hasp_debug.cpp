@@ -41,6 +41,7 @@
 
 #include "hasp/hasp_dispatch.h"
 #include "hasp/hasp.h"
+#include "log/hasp_log_ring.h"
 
 #ifndef SERIAL_SPEED
 #define SERIAL_SPEED 115200
@@ -89,6 +90,38 @@ WriteBufferingStream* bufferedSyslogClient = NULL;
 int32_t debugSerialBaud = SERIAL_SPEED;
 extern bool debugAnsiCodes;
 
+#if HASP_LOG_BUFFER_SIZE > 0
+/* Log lines are formatted by the caller and queued, so it never waits for serial, telnet or syslog.
+ * The log task writes them to the outputs on ESP32, debugLoop does it on the other platforms.
+ * Each record in the ring is a debug_log_record_t followed by the text of the message.
+ * Only the space is reserved inside the lock, the record is copied outside and then marked ready. */
+typedef struct
+{
+    debug_log_context_t context;
+    uint8_t tag;
+    int8_t level;
+    uint16_t length; // of the message text that follows
+    uint8_t ready;   // set when the writer has copied the whole record
+} debug_log_record_t;
+
+#define DEBUG_LOG_READY_POS(pos) (((pos) + offsetof(debug_log_record_t, ready)) % HASP_LOG_BUFFER_SIZE)
+
+static uint8_t debugLogRing[HASP_LOG_BUFFER_SIZE];
+static size_t debugLogHead;          // position of the next record
+static volatile size_t debugLogUsed; // bytes of the queued records
+static uint32_t debugLogDropped;     // lines that did not fit in the ring
+
+#if defined(ESP32)
+static portMUX_TYPE debugLogMux  = portMUX_INITIALIZER_UNLOCKED;
+static TaskHandle_t debugLogTask = NULL;
+#define DEBUG_LOG_LOCK() portENTER_CRITICAL(&debugLogMux)
+#define DEBUG_LOG_UNLOCK() portEXIT_CRITICAL(&debugLogMux)
+#else
+#define DEBUG_LOG_LOCK()
+#define DEBUG_LOG_UNLOCK()
+#endif
+#endif // HASP_LOG_BUFFER_SIZE
+
 extern dispatch_conf_t dispatch_setings;
 
 // #if HASP_USE_SYSLOG > 0
@@ -372,6 +405,128 @@ void debugPrintSuffix(uint8_t tag, int level, Print* _logOutput)
     }
 }
 
+#if HASP_LOG_BUFFER_SIZE > 0
+static void debugLogCopyIn(size_t pos, const void* src, size_t len)
+{
+    const uint8_t* data = (const uint8_t*)src;
+    size_t first        = LV_MATH_MIN(len, HASP_LOG_BUFFER_SIZE - pos);
+    memcpy(debugLogRing + pos, data, first);
+    memcpy(debugLogRing, data + first, len - first);
+}
+
+static void debugLogCopyOut(size_t pos, void* dst, size_t len)
+{
+    uint8_t* data = (uint8_t*)dst;
+    size_t first  = LV_MATH_MIN(len, HASP_LOG_BUFFER_SIZE - pos);
+    memcpy(data, debugLogRing + pos, first);
+    memcpy(data + first, debugLogRing, len - first);
+}
+
+// Called by Log instead of writing to the outputs, from any task
+static void debugLogQueue(uint8_t tag, int level, const char* message)
+{
+    debug_log_record_t record;
+    gettimeofday(&record.context.time, NULL);
+    record.context.millis = millis();
+#if defined(ESP32) && defined(HASP_LOG_TASKS)
+    record.context.task  = pcTaskGetTaskName(NULL);
+    record.context.stack = uxTaskGetStackHighWaterMark(NULL);
+#endif
+    record.tag    = tag;
+    record.level  = level;
+    record.length = strlen(message);
+    record.ready  = false;
+    size_t size   = sizeof(record) + record.length;
+
+    DEBUG_LOG_LOCK();
+    if(debugLogUsed + size > HASP_LOG_BUFFER_SIZE) {
+        debugLogDropped++; // never wait for the outputs
+        DEBUG_LOG_UNLOCK();
+        return;
+    }
+    size_t pos                             = debugLogHead;
+    debugLogRing[DEBUG_LOG_READY_POS(pos)] = false; // the reader stops here until the copy is done
+    debugLogHead                           = (debugLogHead + size) % HASP_LOG_BUFFER_SIZE;
+    debugLogUsed += size;
+    DEBUG_LOG_UNLOCK();
+
+    /* The reserved space is only touched by this writer until it is marked ready */
+    debugLogCopyIn(pos, &record, sizeof(record));
+    debugLogCopyIn((pos + sizeof(record)) % HASP_LOG_BUFFER_SIZE, message, record.length);
+
+    DEBUG_LOG_LOCK();
+    debugLogRing[DEBUG_LOG_READY_POS(pos)] = true;
+    DEBUG_LOG_UNLOCK();
+
+#if defined(ESP32)
+    if(debugLogTask) xTaskNotifyGive(debugLogTask);
+#endif
+}
+
+// Write the queued lines to the outputs, there is only one reader
+static void debugLogWriteQueued()
+{
+    debug_log_record_t record;
+    char message[LOG_MESSAGE_SIZE];
+
+    while(true) {
+        DEBUG_LOG_LOCK();
+        size_t tail = (debugLogHead + HASP_LOG_BUFFER_SIZE - debugLogUsed) % HASP_LOG_BUFFER_SIZE;
+        bool ready  = debugLogUsed > 0 && debugLogRing[DEBUG_LOG_READY_POS(tail)];
+        DEBUG_LOG_UNLOCK();
+        if(!ready) break; // empty, or the oldest record is still being copied
+
+        /* Writers never touch a ready record, it is released after the copy */
+        debugLogCopyOut(tail, &record, sizeof(record));
+        debugLogCopyOut((tail + sizeof(record)) % HASP_LOG_BUFFER_SIZE, message, record.length);
+
+        DEBUG_LOG_LOCK();
+        debugLogUsed -= sizeof(record) + record.length;
+        DEBUG_LOG_UNLOCK();
+
+        message[record.length] = 0;
+        debugSetLogContext(&record.context);
+        Log.printMessage(record.tag, record.level, message);
+        debugSetLogContext(NULL);
+    }
+
+    DEBUG_LOG_LOCK();
+    uint32_t dropped = debugLogDropped;
+    debugLogDropped  = 0;
+    DEBUG_LOG_UNLOCK();
+
+    if(dropped) {
+        snprintf_P(message, sizeof(message), PSTR("%u log lines dropped, the log buffer is full"), dropped);
+        Log.printMessage(TAG_DEBG, LOG_LEVEL_WARNING, message);
+    }
+}
+
+#if defined(ESP32)
+static void debugLogTaskLoop(void* arg)
+{
+    while(true) {
+        ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(100));
+        debugLogWriteQueued();
+    }
+}
+#endif
+
+// Write out the queued lines before a reboot
+void debugFlushLog()
+{
+#if defined(ESP32)
+    if(debugLogTask && xTaskGetCurrentTaskHandle() != debugLogTask) {
+        for(uint8_t i = 0; i < 50 && debugLogUsed > 0; i++) { // the log task remains the only reader
+            xTaskNotifyGive(debugLogTask);
+            delay(2);
+        }
+        return;
+    }
+#endif
+    debugLogWriteQueued();
+}
+#endif // HASP_LOG_BUFFER_SIZE
+
 // Start Serial Port at correct
 bool debugStartSerial()
 {
@@ -413,6 +568,20 @@ void debugSetup(JsonObject settings)
     Log.unregisterOutput(1);
     Log.unregisterOutput(3);
 
+#if HASP_LOG_RING_SIZE > 0
+    log_ring_setup();
+#endif
+
+#if HASP_LOG_BUFFER_SIZE > 0
+#if defined(ESP32)
+    // Low priority, the log lines are written when the GUI and network tasks have nothing to do
+    if(!debugLogTask) xTaskCreatePinnedToCore(debugLogTaskLoop, "logTask", 1024 * 4, NULL, 1, &debugLogTask, 0);
+    if(debugLogTask) Log.setQueue(debugLogQueue);
+#else
+    Log.setQueue(debugLogQueue);
+#endif
+#endif
+
 #if HASP_USE_CONFIG > 0
     if(!settings[FPSTR(FP_CONFIG_BAUD)].isNull()) {
         debugSerialBaud = multiply_legacy_baudrate(settings[FPSTR(FP_CONFIG_BAUD)].as<int32_t>());
@@ -421,7 +590,11 @@ void debugSetup(JsonObject settings)
 }
 
 IRAM_ATTR void debugLoop(void)
-{}
+{
+#if HASP_LOG_BUFFER_SIZE > 0 && !defined(ESP32)
+    debugLogWriteQueued(); // no log task, write the queued lines once per loop
+#endif
+}
 
 void printLocalTime()
 {
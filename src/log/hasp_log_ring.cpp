@@ -0,0 +1,231 @@
+/* MIT License - Copyright (c) 2019-2024 Francis Van Roie
+   For full license information read the LICENSE file in the project folder */
+
+#include "hasplib.h"
+#include "hasp_log_ring.h"
+
+#if HASP_TARGET_ARDUINO && HASP_LOG_RING_SIZE > 0
+
+#include "hasp_debug.h"
+
+#if HASP_USE_SPIFFS > 0 || HASP_USE_LITTLEFS > 0
+#include "hasp_filesystem.h"
+#endif
+
+#if defined(ESP32)
+#include "esp_attr.h"
+#include "esp_system.h"
+#endif
+
+#define LOG_RING_MAGIC 0x484C4F47 // "HLOG"
+#define LOG_RING_RECORD_HEADER 8  // size, millis, tag, level
+#define LOG_RING_COPY_CHUNK 256   // bytes copied at a time by a snapshot, interrupts are blocked while copying
+
+static_assert(HASP_LOG_RING_SIZE >= 4 * (LOG_RING_RECORD_HEADER + LOG_RECORD_SIZE), "HASP_LOG_RING_SIZE is too small");
+
+typedef struct
+{
+    uint32_t magic; // LOG_RING_MAGIC when the records are valid
+    uint32_t head;  // position of the next record
+    uint32_t used;  // bytes of the stored records
+    uint32_t total; // bytes written since the boot, wraps around
+    uint8_t data[HASP_LOG_RING_SIZE];
+} log_ring_t;
+
+#if defined(ESP32) && defined(__NOINIT_ATTR)
+static __NOINIT_ATTR log_ring_t log_ring; // survives a software reset
+#else
+static log_ring_t log_ring;
+#endif
+
+#if defined(ESP32)
+static portMUX_TYPE log_ring_mux = portMUX_INITIALIZER_UNLOCKED;
+#define LOG_RING_LOCK() portENTER_CRITICAL(&log_ring_mux)
+#define LOG_RING_UNLOCK() portEXIT_CRITICAL(&log_ring_mux)
+#else
+#define LOG_RING_LOCK()
+#define LOG_RING_UNLOCK()
+#endif
+
+static void log_ring_copy_in(uint32_t pos, const void* src, size_t len)
+{
+    const uint8_t* data = (const uint8_t*)src;
+    size_t first        = LV_MATH_MIN(len, HASP_LOG_RING_SIZE - pos);
+    memcpy(log_ring.data + pos, data, first);
+    memcpy(log_ring.data, data + first, len - first);
+}
+
+static void log_ring_copy_out(uint32_t pos, void* dst, size_t len)
+{
+    uint8_t* data = (uint8_t*)dst;
+    size_t first  = LV_MATH_MIN(len, HASP_LOG_RING_SIZE - pos);
+    memcpy(data, log_ring.data + pos, first);
+    memcpy(data + first, log_ring.data, len - first);
+}
+
+static inline uint32_t log_ring_tail()
+{
+    return (log_ring.head + HASP_LOG_RING_SIZE - log_ring.used) % HASP_LOG_RING_SIZE;
+}
+
+// Position in the ring of a byte, counted in bytes written
+static inline uint32_t log_ring_pos(uint32_t offset)
+{
+    return (log_ring.head + HASP_LOG_RING_SIZE - (log_ring.total - offset) % HASP_LOG_RING_SIZE) % HASP_LOG_RING_SIZE;
+}
+
+static uint16_t log_ring_size_at(uint32_t pos)
+{
+    uint16_t size;
+    log_ring_copy_out(pos, &size, sizeof(size));
+    return size;
+}
+
+// Check the records left by the previous boot, any inconsistency clears the ring
+static bool log_ring_is_valid()
+{
+    if(log_ring.magic != LOG_RING_MAGIC) return false;
+    if(log_ring.head >= HASP_LOG_RING_SIZE || log_ring.used > HASP_LOG_RING_SIZE) return false;
+
+    uint32_t pos  = log_ring_tail();
+    uint32_t left = log_ring.used;
+    while(left > 0) {
+        uint16_t size = log_ring_size_at(pos);
+        if(size < LOG_RING_RECORD_HEADER || size > left) return false;
+        pos = (pos + size) % HASP_LOG_RING_SIZE;
+        left -= size;
+    }
+    return true;
+}
+
+static void log_ring_add(uint8_t tag, uint8_t level, const uint8_t* data, size_t length)
+{
+    uint8_t header[LOG_RING_RECORD_HEADER];
+    uint16_t size  = LOG_RING_RECORD_HEADER + length;
+    uint32_t msecs = millis();
+    memcpy(header, &size, 2);
+    memcpy(header + 2, &msecs, 4);
+    header[6] = tag;
+    header[7] = level;
+
+    LOG_RING_LOCK();
+    while(log_ring.used + size > HASP_LOG_RING_SIZE) { // drop the oldest records
+        log_ring.used -= log_ring_size_at(log_ring_tail());
+    }
+    log_ring_copy_in(log_ring.head, header, sizeof(header));
+    log_ring_copy_in((log_ring.head + sizeof(header)) % HASP_LOG_RING_SIZE, data, length);
+    log_ring.head = (log_ring.head + size) % HASP_LOG_RING_SIZE;
+    log_ring.used += size;
+    log_ring.total += size;
+    LOG_RING_UNLOCK();
+}
+
+// Called by Log for every log command up to HASP_LOG_RING_LEVEL, from any task
+static void log_ring_record(uint8_t tag, int level, const uint8_t* data, size_t length)
+{
+    log_ring_add(tag, level, data, length);
+}
+
+void log_ring_setup()
+{
+    if(!log_ring_is_valid()) log_ring_clear();
+    log_ring.total = 0;
+
+    /* Mark the boot, the decoder shows the reset reason */
+    LogRecord record;
+#if defined(ESP32)
+    record.add((int)esp_reset_reason());
+#endif
+    log_ring_add(TAG_MAIN, LOG_RING_BOOT_LEVEL, record.data(), record.length());
+
+    Log.setRecorder(log_ring_record, HASP_LOG_RING_LEVEL);
+}
+
+void log_ring_clear()
+{
+    LOG_RING_LOCK();
+    log_ring.head  = 0;
+    log_ring.used  = 0;
+    log_ring.magic = LOG_RING_MAGIC;
+    LOG_RING_UNLOCK();
+}
+
+/**
+ * Copy the header and the records from old to new into a new buffer
+ * @param length receives the size of the dump
+ * @return the dump to be freed with hasp_free, or NULL when out of memory
+ */
+uint8_t* log_ring_snapshot(size_t* length)
+{
+    uint8_t* buffer = (uint8_t*)hasp_malloc(LOG_RING_HEADER_SIZE + HASP_LOG_RING_SIZE);
+    if(!buffer) return NULL;
+
+    uint32_t msecs = millis();
+    uint32_t size  = HASP_LOG_RING_SIZE;
+    memcpy(buffer, "HASPLOG", 7);
+    buffer[7] = LOG_RING_VERSION;
+    memcpy(buffer + 8, &msecs, 4);
+    memcpy(buffer + 12, &size, 4);
+
+    LOG_RING_LOCK();
+    uint32_t end   = log_ring.total;
+    uint32_t start = end - log_ring.used;
+    LOG_RING_UNLOCK();
+
+    /* Copy in chunks, records added meanwhile may overwrite the oldest ones */
+    uint8_t* records = buffer + LOG_RING_HEADER_SIZE;
+    for(uint32_t copied = 0; copied < end - start; copied += LOG_RING_COPY_CHUNK) {
+        size_t len = LV_MATH_MIN(LOG_RING_COPY_CHUNK, end - start - copied);
+        LOG_RING_LOCK();
+        log_ring_copy_out(log_ring_pos(start + copied), records + copied, len);
+        LOG_RING_UNLOCK();
+    }
+
+    /* Drop the records that were overwritten, the bytes after the oldest record were copied before that */
+    LOG_RING_LOCK();
+    uint32_t oldest = log_ring.total - log_ring.used;
+    LOG_RING_UNLOCK();
+    if((int32_t)(oldest - start) > 0) {
+        uint32_t dropped = LV_MATH_MIN(oldest - start, end - start);
+        memmove(records, records + dropped, end - start - dropped);
+        start += dropped;
+    }
+
+    *length = LOG_RING_HEADER_SIZE + end - start;
+    return buffer;
+}
+
+/**
+ * Save a dump of the ring to the flash filesystem
+ * @param filename the file to create, a previous dump is overwritten
+ * @return true if the dump was saved
+ */
+bool log_ring_save(const char* filename)
+{
+#if HASP_USE_SPIFFS > 0 || HASP_USE_LITTLEFS > 0
+    if(filename[0] == 'L' && filename[1] == ':') filename += 2; // strip littlefs drive letter
+
+    size_t length;
+    uint8_t* dump = log_ring_snapshot(&length);
+    if(!dump) {
+        LOG_ERROR(TAG_DEBG, F(D_ERROR_OUT_OF_MEMORY));
+        return false;
+    }
+
+    File file  = HASP_FS.open(filename, "w");
+    bool saved = file && file.write(dump, length) == length;
+    if(file) file.close();
+    hasp_free(dump);
+
+    if(!saved) {
+        LOG_ERROR(TAG_DEBG, F(D_FILE_SAVE_FAILED), filename);
+        return false;
+    }
+    LOG_INFO(TAG_DEBG, F("Saved %u bytes of log records to %s"), length, filename);
+    return true;
+#else
+    return false;
+#endif
+}
+
+#endif
@@ -0,0 +1,40 @@
+/* MIT License - Copyright (c) 2019-2024 Francis Van Roie
+   For full license information read the LICENSE file in the project folder */
+
+#ifndef HASP_LOG_RING_H
+#define HASP_LOG_RING_H
+
+#include "hasplib.h"
+
+#if HASP_TARGET_ARDUINO && HASP_LOG_RING_SIZE > 0
+
+#ifndef HASP_LOG_RING_LEVEL
+#define HASP_LOG_RING_LEVEL HASP_LOG_LEVEL // highest level kept in the ring
+#endif
+
+#ifndef LOG_RING_FILE
+#define LOG_RING_FILE "/logring.bin" // default file of the logring command
+#endif
+
+#define LOG_RING_VERSION 1
+#define LOG_RING_HEADER_SIZE 16 // "HASPLOG", version, uptime in ms, ring size
+#define LOG_RING_BOOT_LEVEL 0xFF // level of the record added at each boot, followed by the reset reason
+
+/* Binary log of the LOG_* commands, formatted on a host with tools/hasp_log_decode.py
+ *
+ * Each log command is kept as its time, tag, level and the LogRecord of ArduinoLog with the format string
+ * address and the raw arguments, without formatting it. The oldest records are overwritten when the ring
+ * is full. On ESP32 the ring is not cleared by a software reset or crash, so the lines leading up to it
+ * can be downloaded from /logring after the reboot.
+ *
+ * A dump is the header followed by the records from old to new, each record is:
+ *   uint16 size of the record, uint32 millis, uint8 tag, uint8 level, LogRecord items
+ */
+void log_ring_setup();
+void log_ring_clear();
+uint8_t* log_ring_snapshot(size_t* length);
+bool log_ring_save(const char* filename);
+
+#endif
+
+#endif
@@ -191,10 +191,13 @@ IRAM_ATTR void loop()
     // haspDevice.loop();
 
 #if HASP_USE_CONSOLE > 0
-    // debugLoop();
     consoleLoop();
 #endif
 
+#if HASP_TARGET_ARDUINO && HASP_LOG_BUFFER_SIZE > 0
+    debugLoop(); // writes the queued log lines on platforms without a log task
+#endif
+
 #if defined(HASP_USE_CUSTOM) && HASP_USE_CUSTOM > 0
     custom_loop();
 #endif
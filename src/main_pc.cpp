@@ -34,6 +34,10 @@
 #include "display/monitor.h"
 #endif
 
+#if USE_HEADLESS
+#include "hasp_bench.h"
+#endif
+
 #include "hasp_debug.h"
 
 // hasp_gui.cpp
@@ -123,16 +127,52 @@ void usage(const char* progName, const char* version)
               << "                        (default: 'AppData\\hasp\\hasp')" << std::endl
 #elif defined(POSIX)
               << "                        (default: '~/.local/share/hasp/hasp')" << std::endl
+#endif
+#if USE_HEADLESS
+              << "    -b  | --bench       Replay a script of commands and report the timings as JSON" << std::endl
+              << "    -t  | --replay      Replay a recorded MQTT trace and report the dispatch latency as JSON" << std::endl
+              << "    -s  | --speed       Replay speed factor, 0 is as fast as possible (default: 1)" << std::endl
+              << "    -j  | --json        Write this many state messages and report the JSON writer speed" << std::endl
+              << "    -l  | --lookup      Look up objects this many times and report the time per lookup" << std::endl
+              << "    -a  | --attributes  Apply attributes this many times and report the attributes/sec" << std::endl
+              << "    -o  | --objects     Load pages with this many objects and report the load time" << std::endl
+              << "    -p  | --pages       Pages file to load before the benchmark starts" << std::endl
+              << "    -r  | --report      Write the benchmark report to a file instead of the console" << std::endl
 #endif
               << std::endl;
     fflush(stdout);
 }
 
+#if USE_HEADLESS
+// The benchmark files are opened after changing to the config directory
+static void absolute_path(char* path, const char* name)
+{
+    if(name[0] == '/' || !cwd(path, PATH_MAX)) {
+        strncpy(path, name, PATH_MAX - 1);
+        return;
+    }
+    strncat(path, "/", PATH_MAX - strlen(path) - 1);
+    strncat(path, name, PATH_MAX - strlen(path) - 1);
+}
+#endif
+
 int main(int argc, char* argv[])
 {
     bool showhelp         = false;
     bool console          = true;
+    int result            = 0;
     char config[PATH_MAX] = {'\0'};
+#if USE_HEADLESS
+    char bench_script[PATH_MAX] = {'\0'};
+    char bench_pages[PATH_MAX]  = {'\0'};
+    char bench_report[PATH_MAX] = {'\0'};
+    char bench_trace[PATH_MAX]  = {'\0'};
+    float bench_speed           = 1;
+    uint32_t bench_messages     = 0;
+    uint32_t bench_lookups      = 0;
+    uint32_t bench_attrs        = 0;
+    uint16_t bench_objects      = 0;
+#endif
 
 #if defined(WINDOWS)
     InitializeConsoleOutput();
@@ -179,6 +219,80 @@ int main(int argc, char* argv[])
                 std::cout << "Missing config directory" << std::endl;
                 showhelp = true;
             }
+#if USE_HEADLESS
+        } else if(strncmp(argv[arg], "--bench", 7) == 0 || strncmp(argv[arg], "-b", 2) == 0) {
+            if(arg + 1 < argc) {
+                absolute_path(bench_script, argv[arg + 1]);
+                arg++;
+            } else {
+                std::cout << "Missing benchmark script" << std::endl;
+                showhelp = true;
+            }
+        } else if(strncmp(argv[arg], "--replay", 8) == 0 || strncmp(argv[arg], "-t", 2) == 0) {
+            if(arg + 1 < argc) {
+                absolute_path(bench_trace, argv[arg + 1]);
+                arg++;
+            } else {
+                std::cout << "Missing trace file" << std::endl;
+                showhelp = true;
+            }
+        } else if(strncmp(argv[arg], "--speed", 7) == 0 || strncmp(argv[arg], "-s", 2) == 0) {
+            if(arg + 1 < argc) {
+                bench_speed = atof(argv[arg + 1]);
+                arg++;
+            } else {
+                std::cout << "Missing speed value" << std::endl;
+                showhelp = true;
+            }
+        } else if(strncmp(argv[arg], "--json", 6) == 0 || strncmp(argv[arg], "-j", 2) == 0) {
+            if(arg + 1 < argc) {
+                bench_messages = atoi(argv[arg + 1]);
+                arg++;
+            } else {
+                std::cout << "Missing message count" << std::endl;
+                showhelp = true;
+            }
+        } else if(strncmp(argv[arg], "--lookup", 8) == 0 || strncmp(argv[arg], "-l", 2) == 0) {
+            if(arg + 1 < argc) {
+                bench_lookups = atoi(argv[arg + 1]);
+                arg++;
+            } else {
+                std::cout << "Missing lookup count" << std::endl;
+                showhelp = true;
+            }
+        } else if(strncmp(argv[arg], "--attributes", 12) == 0 || strncmp(argv[arg], "-a", 2) == 0) {
+            if(arg + 1 < argc) {
+                bench_attrs = atoi(argv[arg + 1]);
+                arg++;
+            } else {
+                std::cout << "Missing attribute count" << std::endl;
+                showhelp = true;
+            }
+        } else if(strncmp(argv[arg], "--objects", 9) == 0 || strncmp(argv[arg], "-o", 2) == 0) {
+            if(arg + 1 < argc) {
+                bench_objects = atoi(argv[arg + 1]);
+                arg++;
+            } else {
+                std::cout << "Missing object count" << std::endl;
+                showhelp = true;
+            }
+        } else if(strncmp(argv[arg], "--pages", 7) == 0 || strncmp(argv[arg], "-p", 2) == 0) {
+            if(arg + 1 < argc) {
+                absolute_path(bench_pages, argv[arg + 1]);
+                arg++;
+            } else {
+                std::cout << "Missing pages file" << std::endl;
+                showhelp = true;
+            }
+        } else if(strncmp(argv[arg], "--report", 8) == 0 || strncmp(argv[arg], "-r", 2) == 0) {
+            if(arg + 1 < argc) {
+                absolute_path(bench_report, argv[arg + 1]);
+                arg++;
+            } else {
+                std::cout << "Missing report file" << std::endl;
+                showhelp = true;
+            }
+#endif
         } else {
             std::cout << "Unrecognized command line parameter: " << argv[arg] << std::endl;
             showhelp = true;
@@ -209,6 +323,21 @@ int main(int argc, char* argv[])
     cd(config);
 
     setup();
+#if USE_HEADLESS
+    if(bench_trace[0] != '\0') {
+        if(!bench_replay(bench_trace, bench_speed, bench_pages, bench_report)) result = 1;
+    } else if(bench_script[0] != '\0') {
+        if(!bench_run(bench_script, bench_pages, bench_report)) result = 1;
+    } else if(bench_messages > 0) {
+        if(!bench_json(bench_messages, bench_report)) result = 1;
+    } else if(bench_lookups > 0) {
+        if(!bench_lookup(bench_lookups, bench_report)) result = 1;
+    } else if(bench_attrs > 0) {
+        if(!bench_attributes(bench_attrs, bench_report)) result = 1;
+    } else if(bench_objects > 0) {
+        if(!bench_load(bench_objects, bench_report)) result = 1;
+    }
+#endif
     while(haspDevice.pc_is_running) {
         loop();
     }
@@ -218,9 +347,9 @@ end:
     std::cout << std::endl << std::flush;
     fflush(stdout);
     FreeConsole();
-    exit(0);
+    exit(result);
 #endif
-    return 0;
+    return result;
 }
 
 #endif
@@ -20,7 +20,8 @@
 #include "hasp_gui.h"
 
 #include "../hasp/hasp_dispatch.h"
-#include "freertos/queue.h"
+#include "hasp_mqtt_ring.h"
+#include "hasp_mqtt_trace.h"
 
 #include "esp_http_server.h"
 #include "esp_tls.h"
@@ -30,12 +31,7 @@
 #define MQTT_DEFAULT_BROADCAST_TOPIC MQTT_PREFIX "/" MQTT_TOPIC_BROADCAST "/%topic%"
 #define MQTT_DEFAULT_HASS_TOPIC "homeassistant/status"
 
-QueueHandle_t queue;
-typedef struct
-{
-    char* topic;   //[64];
-    char* payload; //[512];
-} mqtt_message_t;
+mqtt_ring_t mqttRing; // received messages waiting for mqttLoop
 
 char mqttClientId[64];
 String mqttNodeLwtTopic;
@@ -185,51 +181,17 @@ int mqtt_send_discovery(const char* payload, size_t len)
     return mqttPublish(tmp_topic, payload, len, false);
 }
 
-static inline size_t mqtt_msg_length(size_t len)
-{
-    return (len / 64) * 64 + 64;
-}
-
 void mqtt_enqueue_message(const char* topic, const char* payload, size_t payload_len)
 {
-    // Add new message to the queue
-    mqtt_message_t data;
-
-    size_t topic_len = strlen(topic);
-    data.topic       = (char*)hasp_calloc(sizeof(char), mqtt_msg_length(topic_len + 1));
-    data.payload     = (char*)hasp_calloc(sizeof(char), mqtt_msg_length(payload_len + 1));
-
-    if(!data.topic || !data.payload) {
-        LOG_ERROR(TAG_MQTT_RCV, D_ERROR_OUT_OF_MEMORY);
-        hasp_free(data.topic);
-        hasp_free(data.payload);
-        return;
-    }
-    memcpy(data.topic, topic, topic_len);
-    memcpy(data.payload, payload, payload_len);
-
-    {
-        size_t attempt = 0;
-        while(xQueueSend(queue, &data, (TickType_t)0) == errQUEUE_FULL && attempt < 100) {
-            delay(5);
-            attempt++;
-        };
-        if(attempt >= 100) {
-            LOG_ERROR(TAG_MQTT_RCV, D_ERROR_OUT_OF_MEMORY);
-        }
-    }
+    // Never blocks the MQTT task, the message is dropped and counted when the ring is full
+    mqtt_ring_push(mqttRing, topic, payload, payload_len);
 }
 
 void mqtt_process_topic_payload(const char* topic, const char* payload, unsigned int length)
 {
-    if(gui_acquire(pdMS_TO_TICKS(30))) {
-        mqttLoop(); // First empty the MQTT queue
-        LOG_TRACE(TAG_MQTT_RCV, F("%s = %s"), topic, payload);
-        dispatch_topic_payload(topic, payload, length > 0, TAG_MQTT);
-        gui_release();
-    } else {
-        mqtt_enqueue_message(topic, payload, length);
-    }
+    // Dispatched by mqttLoop, together with all other messages received during the same frame
+    mqtt_trace_record(topic, payload);
+    mqtt_enqueue_message(topic, payload, length);
 }
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -486,7 +448,7 @@ static esp_err_t mqtt_event_handler(esp_mqtt_event_handle_t event)
 
 void mqttSetup()
 {
-    queue = xQueueCreate(64, sizeof(mqtt_message_t));
+    mqtt_ring_init(mqttRing, MQTT_RING_SIZE);
     // esp_crt_bundle_set(rootca_crt_bundle_start, rootca_crt_bundle_end-rootca_crt_bundle_start);
     //    arduino_esp_crt_bundle_set(rootca_crt_bundle_start);
     mqttStart();
@@ -496,17 +458,8 @@ IRAM_ATTR void mqttLoop(void)
 {
     // mqttClient.loop();
 
-    if(!uxQueueMessagesWaiting(queue)) return;
-
-    mqtt_message_t data;
-    while(xQueueReceive(queue, &data, (TickType_t)0)) {
-        LOG_WARNING(TAG_MQTT, F("[%d] QUE %s => %s"), uxQueueMessagesWaiting(queue), data.topic, data.payload);
-        size_t length = strlen(data.payload);
-        dispatch_topic_payload(data.topic, data.payload, length > 0, TAG_MQTT);
-        hasp_free(data.topic);
-        hasp_free(data.payload);
-        // delay(1);
-    }
+    /* Dispatch the messages received since the last frame, the caller holds the gui lock for all of them */
+    mqtt_ring_dispatch(mqttRing);
 }
 
 void mqttEverySecond()
@@ -695,6 +648,9 @@ void mqtt_get_info(JsonDocument& doc)
                                                   : D_SERVICE_DISCONNECTED;
 
     info[F(D_INFO_RECEIVED)]  = mqttReceiveCount;
+    info[F("Applied")]        = mqttRing.applied;
+    info[F("Dropped")]        = mqttRing.dropped;
+    info[F("Coalesced")]      = mqttRing.coalesced;
     info[F(D_INFO_PUBLISHED)] = mqttPublishCount;
     info[F(D_INFO_FAILED)]    = mqttFailedCount;
 }
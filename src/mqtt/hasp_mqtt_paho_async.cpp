@@ -46,6 +46,8 @@ const char FP_CONFIG_GROUP[] PROGMEM = "group";
 
 #include "hasp/hasp_dispatch.h" // for dispatch_topic_payload
 #include "hasp_debug.h"         // for logging
+#include "hasp_mqtt_ring.h"     // for the received messages
+#include "hasp_mqtt_trace.h"    // for recording the received messages
 
 #if !defined(_WIN32)
 #include <unistd.h>
@@ -71,6 +73,7 @@ bool mqttHAautodiscover = true;
 uint32_t mqttPublishCount;
 uint32_t mqttReceiveCount;
 uint32_t mqttFailedCount;
+mqtt_ring_t mqttRing; // received messages waiting for mqttLoop
 
 std::recursive_mutex dispatch_mtx;
 std::recursive_mutex publish_mtx;
@@ -159,9 +162,8 @@ static void mqtt_message_cb(char* topic, char* payload, size_t length)
 
         // Group topic
         topic += mqttGroupTopic.length(); // shorten topic
-        dispatch_mtx.lock();
-        dispatch_topic_payload(topic, (const char*)payload, length > 0, TAG_MQTT);
-        dispatch_mtx.unlock();
+        mqtt_trace_record(topic, payload);
+        mqtt_ring_push(mqttRing, topic, (const char*)payload, length); // dispatched by mqttLoop
         return;
 
 #ifdef HASP_USE_BROADCAST
@@ -170,9 +172,8 @@ static void mqtt_message_cb(char* topic, char* payload, size_t length)
 
         // /" MQTT_TOPIC_BROADCAST "/ topic
         topic += strlen(MQTT_PREFIX "/" MQTT_TOPIC_BROADCAST "/"); // shorten topic
-        dispatch_mtx.lock();
-        dispatch_topic_payload(topic, (const char*)payload, length > 0, TAG_MQTT);
-        dispatch_mtx.unlock();
+        mqtt_trace_record(topic, payload);
+        mqtt_ring_push(mqttRing, topic, (const char*)payload, length); // dispatched by mqttLoop
         return;
 #endif
 
@@ -206,9 +207,8 @@ static void mqtt_message_cb(char* topic, char* payload, size_t length)
             // LOG_TRACE(TAG_MQTT, F("ignoring LWT = online"));
         }
     } else {
-        dispatch_mtx.lock();
-        dispatch_topic_payload(topic, (const char*)payload, length > 0, TAG_MQTT);
-        dispatch_mtx.unlock();
+        mqtt_trace_record(topic, payload);
+        mqtt_ring_push(mqttRing, topic, (const char*)payload, length); // dispatched by mqttLoop
     }
 }
 
@@ -434,9 +434,14 @@ void mqttSetup()
 
     mqttLwtTopic = mqttNodeTopic;
     mqttLwtTopic += MQTT_TOPIC_LWT;
+
+    mqtt_ring_init(mqttRing, MQTT_RING_SIZE);
 }
 
-IRAM_ATTR void mqttLoop() {};
+IRAM_ATTR void mqttLoop()
+{
+    mqtt_ring_dispatch(mqttRing);
+};
 
 void mqttEverySecond()
 {}
@@ -459,6 +464,9 @@ void mqtt_get_info(JsonDocument& doc)
     info[F(D_INFO_CLIENTID)]  = haspDevice.get_hostname();
     info[F(D_INFO_STATUS)]    = mqttIsConnected() ? F(D_SERVICE_CONNECTED) : F(D_SERVICE_DISCONNECTED);
     info[F(D_INFO_RECEIVED)]  = mqttReceiveCount;
+    info[F("Applied")]        = mqttRing.applied;
+    info[F("Dropped")]        = mqttRing.dropped;
+    info[F("Coalesced")]      = mqttRing.coalesced;
     info[F(D_INFO_PUBLISHED)] = mqttPublishCount;
     info[F(D_INFO_FAILED)]    = mqttFailedCount;
 }
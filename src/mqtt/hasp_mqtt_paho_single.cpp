@@ -46,6 +46,7 @@ const char FP_CONFIG_GROUP[] PROGMEM = "group";
 
 #include "hasp/hasp_dispatch.h" // for dispatch_topic_payload
 #include "hasp_debug.h"         // for logging
+#include "hasp_mqtt_trace.h"    // for recording the received messages
 
 #if !defined(_WIN32)
 #include <unistd.h>
@@ -116,6 +117,7 @@ static void mqtt_message_cb(char* topic, char* payload, size_t length)
 
         // Group topic
         topic += mqttGroupTopic.length(); // shorten topic
+        mqtt_trace_record(topic, payload);
         dispatch_topic_payload(topic, (const char*)payload, length > 0, TAG_MQTT);
         return;
 
@@ -125,6 +127,7 @@ static void mqtt_message_cb(char* topic, char* payload, size_t length)
 
         // /" MQTT_TOPIC_BROADCAST "/ topic
         topic += strlen(MQTT_PREFIX "/" MQTT_TOPIC_BROADCAST "/"); // shorten topic
+        mqtt_trace_record(topic, payload);
         dispatch_topic_payload(topic, (const char*)payload, length > 0, TAG_MQTT);
         return;
 #endif
@@ -157,6 +160,7 @@ static void mqtt_message_cb(char* topic, char* payload, size_t length)
             // LOG_TRACE(TAG_MQTT, F("ignoring LWT = online"));
         }
     } else {
+        mqtt_trace_record(topic, payload);
         dispatch_topic_payload(topic, (const char*)payload, length > 0, TAG_MQTT);
     }
 }
@@ -44,6 +44,7 @@ EthernetClient mqttNetworkClient;
 #include "hasp_config.h"
 
 #include "../hasp/hasp_dispatch.h"
+#include "hasp_mqtt_trace.h"
 
 char mqttNodeTopic[24];
 char mqttGroupTopic[24];
@@ -155,6 +156,7 @@ static void mqtt_message_cb(char* topic, byte* payload, unsigned int length)
 
         // Group topic
         topic += strlen(mqttGroupTopic); // shorten topic
+        mqtt_trace_record(topic, (const char*)payload);
         dispatch_topic_payload(topic, (const char*)payload, length > 0, TAG_MQTT);
         return;
 
@@ -163,6 +165,7 @@ static void mqtt_message_cb(char* topic, byte* payload, unsigned int length)
 
         // Broadcast topic
         topic += strlen_P(PSTR(MQTT_PREFIX "/" MQTT_TOPIC_BROADCAST "/")); // shorten topic
+        mqtt_trace_record(topic, (const char*)payload);
         dispatch_topic_payload(topic, (const char*)payload, length > 0, TAG_MQTT);
         return;
 #endif
@@ -203,6 +206,7 @@ static void mqtt_message_cb(char* topic, byte* payload, unsigned int length)
                 }
                 else */
     {
+        mqtt_trace_record(topic, (const char*)payload);
         dispatch_topic_payload(topic, (const char*)payload, length > 0, TAG_MQTT);
     }
 }
@@ -0,0 +1,185 @@
+/* MIT License - Copyright (c) 2019-2024 Francis Van Roie
+   For full license information read the LICENSE file in the project folder */
+
+#include "hasplib.h"
+#include "hasp_mqtt_ring.h"
+
+#if (HASP_USE_MQTT > 0 && defined(HASP_USE_ESP_MQTT)) || HASP_USE_MQTT_ASYNC > 0
+
+#define MQTT_RING_WRAP 0xFFFF // topic length of the marker that sends the reader back to the start
+#define MQTT_RING_RESTART 1   // bit in the head and tail offsets, the records are 4 byte aligned
+
+/* The producer can't move the tail. When the ring is empty and a message doesn't fit behind the head, it starts
+ * again at the front and toggles MQTT_RING_RESTART in the head. While the bit differs from the one in the tail,
+ * the consumer still has to move to the front, it does so and copies the bit into the tail. */
+
+/* Each record is 4 byte aligned: topic length, payload length, topic, '\0', payload, '\0' */
+struct mqtt_ring_record_t
+{
+    uint16_t topic_len;
+    uint16_t payload_len;
+};
+
+static inline size_t mqtt_ring_record_size(size_t topic_len, size_t payload_len)
+{
+    return (sizeof(mqtt_ring_record_t) + topic_len + 1 + payload_len + 1 + 3) & ~(size_t)3;
+}
+
+bool mqtt_ring_init(mqtt_ring_t& ring, size_t size)
+{
+    size &= ~(size_t)3;
+    if(!ring.buffer) ring.buffer = (uint8_t*)hasp_malloc(size);
+    if(!ring.buffer) {
+        LOG_ERROR(TAG_MQTT, F(D_ERROR_OUT_OF_MEMORY));
+        return false;
+    }
+
+    ring.size = size;
+    ring.head.store(0);
+    ring.tail.store(0);
+    return true;
+}
+
+/**
+ * Append a received message, called from the MQTT task
+ * @param topic the topic, zero terminated
+ * @param payload the payload, doesn't need to be zero terminated
+ * @param payload_len the length of the payload
+ * @return false if the message was dropped because the ring is full
+ */
+bool mqtt_ring_push(mqtt_ring_t& ring, const char* topic, const char* payload, size_t payload_len)
+{
+    size_t topic_len  = strlen(topic);
+    size_t need       = mqtt_ring_record_size(topic_len, payload_len);
+    size_t head_flags = ring.head.load(std::memory_order_relaxed);
+    size_t tail_flags = ring.tail.load(std::memory_order_acquire);
+    size_t head       = head_flags & ~(size_t)MQTT_RING_RESTART;
+    size_t tail       = tail_flags & ~(size_t)MQTT_RING_RESTART;
+    size_t restart    = head_flags & MQTT_RING_RESTART;
+    bool pending      = restart != (tail_flags & MQTT_RING_RESTART);
+    size_t pos;
+
+    if(pending) tail = 0; // the consumer has not moved to the front yet
+
+    /* The head never catches up with the tail, head == tail means empty */
+    if(!ring.buffer || topic_len >= MQTT_RING_WRAP || payload_len >= MQTT_RING_WRAP) {
+        pos = SIZE_MAX;
+    } else if(head < tail) {
+        pos = tail - head > need ? head : SIZE_MAX;
+    } else if(ring.size - head >= need && (head + need) % ring.size != tail) {
+        pos = head;
+    } else if(head == tail && !pending && need < ring.size) {
+        restart ^= MQTT_RING_RESTART; // empty, start again at the front instead of wrapping
+        pos = 0;
+    } else if(tail > need) {
+        ((mqtt_ring_record_t*)(ring.buffer + head))->topic_len = MQTT_RING_WRAP;
+        pos = 0;
+    } else {
+        pos = SIZE_MAX;
+    }
+
+    if(pos == SIZE_MAX) {
+        ring.dropped++;
+        LOG_ERROR(TAG_MQTT_RCV, F("Receive buffer full, dropped %s"), topic);
+        return false;
+    }
+
+    mqtt_ring_record_t* record = (mqtt_ring_record_t*)(ring.buffer + pos);
+    char* text                 = (char*)(record + 1);
+    record->topic_len          = topic_len;
+    record->payload_len        = payload_len;
+    memcpy(text, topic, topic_len + 1);
+    memcpy(text + topic_len + 1, payload, payload_len);
+    text[topic_len + 1 + payload_len] = '\0';
+
+    pos += need;
+    ring.head.store((pos == ring.size ? 0 : pos) | restart, std::memory_order_release);
+    return true;
+}
+
+// Writes to an object attribute can be replaced by a later write to the same attribute
+static bool mqtt_ring_is_attribute_write(const char* topic, const char* payload)
+{
+    if((topic[0] != 'p' && topic[0] != 'P') || !isdigit(topic[1]) || payload[0] == '\0') return false;
+
+    const char* attr = strchr(topic, '.');
+    if(!attr) return false;
+
+    /* Merges and methods act on every message, they are barriers like commands */
+    switch(hasp_attribute_get_hash(attr + 1)) {
+        case ATTR_JSONL:
+        case ATTR_DELETE:
+        case ATTR_CLEAR:
+        case ATTR_TO_FRONT:
+        case ATTR_TO_BACK:
+        case ATTR_OPEN:
+        case ATTR_CLOSE:
+            return false;
+        default:
+            return true;
+    }
+}
+
+/**
+ * Dispatch the messages received since the last call, called from the main loop
+ * @note within one batch a write to pXbY.attr replaces an earlier write to the same attribute,
+ * commands, attribute reads, jsonl merges and methods like delete are barriers so the order around them is kept
+ */
+void mqtt_ring_dispatch(mqtt_ring_t& ring)
+{
+    size_t tail_flags = ring.tail.load(std::memory_order_relaxed);
+    size_t head_flags = ring.head.load(std::memory_order_acquire);
+    size_t tail       = tail_flags & ~(size_t)MQTT_RING_RESTART;
+    size_t head       = head_flags & ~(size_t)MQTT_RING_RESTART;
+    size_t restart    = head_flags & MQTT_RING_RESTART;
+
+    if(restart != (tail_flags & MQTT_RING_RESTART)) tail = 0; // the producer started again at the front
+    if(tail == head) return;
+
+    const char* topics[MQTT_RING_BATCH];
+    const char* payloads[MQTT_RING_BATCH];
+    uint16_t count   = 0;
+    uint16_t barrier = 0; // writes before this index are not merged with later ones
+
+    /* The records stay in place until the tail is moved, so they can be dispatched without copying */
+    while(tail != head && count < MQTT_RING_BATCH) {
+        mqtt_ring_record_t* record = (mqtt_ring_record_t*)(ring.buffer + tail);
+        if(record->topic_len == MQTT_RING_WRAP) {
+            tail = 0;
+            continue;
+        }
+
+        const char* topic   = (const char*)(record + 1);
+        const char* payload = topic + record->topic_len + 1;
+
+        if(mqtt_ring_is_attribute_write(topic, payload)) {
+            for(uint16_t i = barrier; i < count; i++) {
+                if(topics[i] && !strcasecmp(topics[i], topic)) { // last write wins
+                    topics[i] = NULL;
+                    ring.coalesced++;
+                    break;
+                }
+            }
+        } else {
+            barrier = count + 1;
+        }
+
+        topics[count]   = topic;
+        payloads[count] = payload;
+        count++;
+
+        tail += mqtt_ring_record_size(record->topic_len, record->payload_len);
+        if(tail == ring.size) tail = 0;
+    }
+
+    for(uint16_t i = 0; i < count; i++) {
+        if(!topics[i]) continue;
+        LOG_TRACE(TAG_MQTT_RCV, F("%s = %s"), topics[i], payloads[i]);
+        dispatch_topic_payload(topics[i], payloads[i], payloads[i][0] != '\0', TAG_MQTT);
+        ring.applied++;
+    }
+
+    ring.tail.store(tail | restart, std::memory_order_release);
+}
+
+#endif
@@ -0,0 +1,39 @@
+/* MIT License - Copyright (c) 2019-2024 Francis Van Roie
+   For full license information read the LICENSE file in the project folder */
+
+#ifndef HASP_MQTT_RING_H
+#define HASP_MQTT_RING_H
+
+#include <atomic>
+#include "hasplib.h"
+
+#ifndef MQTT_RING_SIZE
+#define MQTT_RING_SIZE (4 * MQTT_MAX_PACKET_SIZE) // bytes reserved for received messages waiting to be dispatched
+#endif
+
+#ifndef MQTT_RING_BATCH
+#define MQTT_RING_BATCH 64 // maximum number of messages dispatched per loop
+#endif
+
+/* Received messages waiting for the main loop
+ *
+ * Single producer, single consumer: the MQTT task only appends, the main loop only removes. Topic and
+ * payload are packed into one record of the preallocated buffer, so no allocation is done per message.
+ * When a message does not fit it is dropped and counted, the MQTT task never waits for the main loop.
+ */
+struct mqtt_ring_t
+{
+    uint8_t* buffer;
+    size_t size;
+    std::atomic<size_t> head; // next write offset, only changed by the producer
+    std::atomic<size_t> tail; // next read offset, only changed by the consumer
+    uint32_t dropped;         // messages that did not fit
+    uint32_t applied;         // messages dispatched
+    uint32_t coalesced;       // attribute writes replaced by a later write to the same attribute
+};
+
+bool mqtt_ring_init(mqtt_ring_t& ring, size_t size);
+bool mqtt_ring_push(mqtt_ring_t& ring, const char* topic, const char* payload, size_t payload_len);
+void mqtt_ring_dispatch(mqtt_ring_t& ring);
+
+#endif
@@ -0,0 +1,134 @@
+/* MIT License - Copyright (c) 2019-2024 Francis Van Roie
+   For full license information read the LICENSE file in the project folder */
+
+#include "hasplib.h"
+#include "hasp_mqtt_trace.h"
+
+#if HASP_USE_MQTT > 0 && HASP_USE_MQTT_TRACE > 0
+
+#include <atomic>
+
+#if HASP_USE_SPIFFS > 0 || HASP_USE_LITTLEFS > 0
+#include "hasp_filesystem.h"
+#else
+#include <stdio.h>
+#include <string>
+#endif
+
+#if defined(HASP_USE_ESP_MQTT) || HASP_USE_MQTT_ASYNC > 0
+#include <mutex>
+static std::mutex trace_mtx; // messages are recorded by the MQTT task, the command runs in the main loop
+#define MQTT_TRACE_LOCK() std::lock_guard<std::mutex> lock(trace_mtx)
+#else
+#define MQTT_TRACE_LOCK()
+#endif
+
+#if HASP_USE_SPIFFS > 0 || HASP_USE_LITTLEFS > 0
+static File trace_file;
+#else
+static FILE* trace_file;
+#endif
+static std::atomic<bool> trace_active(false);
+static unsigned long trace_start;
+static size_t trace_size;
+static uint32_t trace_count;
+
+static size_t trace_write(const char* line, size_t len)
+{
+#if HASP_USE_SPIFFS > 0 || HASP_USE_LITTLEFS > 0
+    return trace_file.write((const uint8_t*)line, len);
+#else
+    return fwrite(line, 1, len, trace_file);
+#endif
+}
+
+static void trace_close()
+{
+    trace_active = false;
+#if HASP_USE_SPIFFS > 0 || HASP_USE_LITTLEFS > 0
+    trace_file.close();
+#else
+    fclose(trace_file);
+    trace_file = NULL;
+#endif
+    LOG_INFO(TAG_MQTT, F("Trace stopped, %u messages recorded"), trace_count);
+}
+
+/**
+ * Record the received messages into a file, a previous recording is overwritten
+ * @param filename the file on the flash filesystem, or relative to the config directory on PC
+ * @return true if the file was created
+ */
+bool mqtt_trace_start(const char* filename)
+{
+    MQTT_TRACE_LOCK();
+    if(trace_active) trace_close();
+    if(filename[0] == 'L' && filename[1] == ':') filename += 2; // strip littlefs drive letter
+
+#if HASP_USE_SPIFFS > 0 || HASP_USE_LITTLEFS > 0
+    trace_file = HASP_FS.open(filename, "w");
+#else
+    std::string path = filename[0] == '/' ? std::string(".") + filename : filename;
+    trace_file       = fopen(path.c_str(), "w");
+#endif
+    if(!trace_file) {
+        LOG_ERROR(TAG_MQTT, F(D_FILE_SAVE_FAILED), filename);
+        return false;
+    }
+
+    trace_start  = millis();
+    trace_size   = 0;
+    trace_count  = 0;
+    trace_active = true;
+    LOG_INFO(TAG_MQTT, F("Recording received messages to %s"), filename);
+    return true;
+}
+
+void mqtt_trace_stop()
+{
+    MQTT_TRACE_LOCK();
+    if(trace_active) trace_close();
+}
+
+bool mqtt_trace_is_active()
+{
+    return trace_active;
+}
+
+/**
+ * Append a received message to the trace, called before it is dispatched
+ * @param topic the shortened topic passed to dispatch_topic_payload
+ * @param payload the zero terminated payload
+ */
+void mqtt_trace_record(const char* topic, const char* payload)
+{
+    if(!trace_active) return; // no locking when nothing is recorded
+
+    MQTT_TRACE_LOCK();
+    if(!trace_active) return;
+
+    char buffer[HASP_JSON_STATE_SIZE];
+    JsonWriter json(buffer, sizeof(buffer));
+    json.add_int("t", millis() - trace_start);
+    json.add_str("topic", topic);
+    json.add_str("payload", payload);
+    const char* line = json.end();
+    if(!line) return;
+
+    size_t len = strlen(line);
+    if(trace_size + len + 1 > MQTT_TRACE_MAX_SIZE) {
+        LOG_WARNING(TAG_MQTT, F("Trace reached %u bytes"), (uint32_t)trace_size);
+        trace_close();
+        return;
+    }
+
+    if(trace_write(line, len) != len || trace_write("\n", 1) != 1) {
+        LOG_ERROR(TAG_MQTT, F("Trace write failed"));
+        trace_close();
+        return;
+    }
+    trace_size += len + 1;
+    trace_count++;
+}
+
+#endif
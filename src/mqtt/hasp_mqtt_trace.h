@@ -0,0 +1,34 @@
+/* MIT License - Copyright (c) 2019-2024 Francis Van Roie
+   For full license information read the LICENSE file in the project folder */
+
+#ifndef HASP_MQTT_TRACE_H
+#define HASP_MQTT_TRACE_H
+
+#include "hasplib.h"
+
+#if HASP_USE_MQTT > 0 && HASP_USE_MQTT_TRACE > 0
+
+#ifndef MQTT_TRACE_FILE
+#define MQTT_TRACE_FILE "/mqtt_trace.jsonl" // default file of the mqtttrace command
+#endif
+
+#ifndef MQTT_TRACE_MAX_SIZE
+#define MQTT_TRACE_MAX_SIZE (256 * 1024U) // the recording stops when the file reaches this size
+#endif
+
+/* Recording of the received messages, replayed with the --replay option of the headless build
+ *
+ * Each line of the trace is a json object with the time in ms since the recording started, the topic as
+ * it is passed to dispatch_topic_payload and the payload: {"t":1520,"topic":"p1b2.val","payload":"50"}
+ */
+bool mqtt_trace_start(const char* filename);
+void mqtt_trace_stop();
+bool mqtt_trace_is_active();
+void mqtt_trace_record(const char* topic, const char* payload);
+
+#else
+static inline void mqtt_trace_record(const char* topic, const char* payload)
+{}
+#endif
+
+#endif
@@ -23,6 +23,7 @@
 
 #include "hasp_gui.h"
 #include "hasp_debug.h"
+#include "log/hasp_log_ring.h"
 
 #include "sys/net/hasp_network.h"
 #include "sys/net/hasp_time.h"
@@ -494,6 +495,21 @@ static void http_handle_screenshot()
             return;
         }
 
+        // Send the areas changed since the sequence the client has
+        if(webServer.hasArg("s")) {
+            uint32_t since = atol(webServer.arg("s").c_str());
+            if(since > 0 && since == guiScreenshotSequence()) {
+                webServer.send(304, F("application/octet-stream"), ""); // 304 not Modified
+                return;
+            }
+            webServer.sendHeader("Cache-Control", F("no-cache, no-store"));
+            webServer.setContentLength(CONTENT_LENGTH_UNKNOWN);
+            webServer.send(200, F("application/octet-stream"), "");
+            guiTakeScreenshotDelta(since);
+            webServer.sendContent(""); // end of the chunked response
+            return;
+        }
+
         uint32_t modified = guiScreenshotEtag();
         String etag((char*)0);
         etag.reserve(64);
@@ -514,9 +530,17 @@ static void http_handle_screenshot()
             lv_disp_t* disp = lv_disp_get_default();
             etag            = (String)(modified);
             http_send_etag(etag); // Send new tag with modification version
-            webServer.setContentLength(66 + disp->driver.hor_res * disp->driver.ver_res * sizeof(lv_color_t));
-            webServer.send(200, "image/bmp", "");
-            guiTakeScreenshot();
+
+            if(gui_screenshot_get_format(webServer.arg("format").c_str()) == GUI_SCREENSHOT_QOI) {
+                webServer.setContentLength(CONTENT_LENGTH_UNKNOWN); // compressed size is not known in advance
+                webServer.send(200, "image/qoi", "");
+                guiTakeScreenshot(GUI_SCREENSHOT_QOI);
+                webServer.sendContent(""); // end of the chunked response
+            } else {
+                webServer.setContentLength(66 + disp->driver.hor_res * disp->driver.ver_res * sizeof(lv_color_t));
+                webServer.send(200, "image/bmp", "");
+                guiTakeScreenshot(GUI_SCREENSHOT_BMP);
+            }
             webServer.client().stop();
             return;
         }
@@ -540,6 +564,34 @@ static void http_handle_screenshot()
     http_send_content(html, min(i, len));
 }
 
+////////////////////////////////////////////////////////////////////////////////////////////////////
+#if HASP_LOG_RING_SIZE > 0
+static void http_handle_log_ring()
+{ // http://plate01/logring, decode with tools/hasp_log_decode.py
+    if(!http_is_authenticated("logring")) return;
+
+    if(webServer.method() == HTTP_DELETE) {
+        log_ring_clear();
+        webServer.send(200, PSTR("text/plain"), "");
+        return;
+    }
+
+    size_t length;
+    uint8_t* dump = log_ring_snapshot(&length);
+    if(!dump) {
+        webServer.send(500, PSTR("text/plain"), PSTR(D_ERROR_OUT_OF_MEMORY));
+        return;
+    }
+
+    webServer.sendHeader("Content-Disposition", F("attachment; filename=\"logring.bin\""));
+    webServer.sendHeader("Cache-Control", F("no-cache, no-store"));
+    webServer.setContentLength(length);
+    webServer.send(200, F("application/octet-stream"), "");
+    webServer.sendContent((const char*)dump, length);
+    hasp_free(dump);
+}
+#endif
+
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 static void add_json(String& data, JsonDocument& doc)
 {
@@ -1251,6 +1303,12 @@ static void handleFileUpload()
             if(fsUploadFile) {
                 LOG_INFO(TAG_HTTP, F("Uploaded %s (%u bytes)"), fsUploadFile.name(), upload->totalSize);
                 fsUploadFile.close();
+#if HASP_IMAGE_DECODE_CACHE > 0 && LV_USE_FILESYSTEM > 0
+                image_cache_invalidate(upload->filename.c_str()); // show the new file
+#endif
+#if HASP_USE_PAGE_CACHE > 0
+                hasp_pagecache_invalidate(upload->filename.c_str()); // compiled again on the next load
+#endif
 
                 // Redirect to /config/hasp page. This flushes the web buffer and frees the memory
                 // webServer.sendHeader(String("Location"), String(F("/config/hasp")), true);
@@ -1293,6 +1351,9 @@ static void handleFileDelete()
         result = HASP_FS.rmdir(path);
     } else {
         result = HASP_FS.remove(path);
+#if HASP_IMAGE_DECODE_CACHE > 0 && LV_USE_FILESYSTEM > 0
+        if(result) image_cache_invalidate(path.c_str());
+#endif
     }
     if(result) {
         webServer.send(200, mimetype, String(""));
@@ -2768,6 +2829,9 @@ void httpSetup()
 
     webServer.on("/", http_handle_root);
     webServer.on("/screenshot", http_handle_screenshot);
+#if HASP_LOG_RING_SIZE > 0
+    webServer.on("/logring", http_handle_log_ring);
+#endif
 #ifdef HTTP_LEGACY
     webServer.on("/info", http_handle_info);
     webServer.on("/reboot", http_handle_reboot);
@@ -2872,6 +2936,12 @@ bool httpSetConfig(const JsonObject& settings)
 }
 #endif // HASP_USE_CONFIG
 
+void httpClientWriteChunk(const uint8_t* buf, size_t size)
+{
+    if(!webServer.client() || !webServer.client().connected()) return;
+    webServer.sendContent((const char*)buf, size);
+}
+
 size_t httpClientWrite(const uint8_t* buf, size_t size)
 {
     /***** Sending 16Kb at once freezes on STM32 EthernetClient *****/
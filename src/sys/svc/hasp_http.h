@@ -30,6 +30,7 @@ void httpStart(void);
 void httpStop(void);
 
 size_t httpClientWrite(const uint8_t* buf, size_t size); // Screenshot Write Data
+void httpClientWriteChunk(const uint8_t* buf, size_t size); // Screenshot Write Chunked Data
 
 #if HASP_USE_CONFIG > 0
 bool httpGetConfig(const JsonObject& settings);
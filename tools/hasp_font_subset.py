@@ -0,0 +1,143 @@
+#!/usr/bin/env python3
+
+# Creates .bin fonts that only hold the glyphs used in the pages
+#
+# The text, options and template attributes in the pages files are scanned for the codepoints they use.
+# Icons in the private use area are looked up in md-icons.json and taken from the Material Design font.
+# One subset is made per size, the sizes default to the text_font and value_font sizes found in the pages.
+#
+# Codepoints that are shown at runtime but are not in a loaded .bin font are listed per font on the
+# device information page, pass them with --add to include them in the next subset.
+#
+# Example: python tools/hasp_font_subset.py data/pages/pages.jsonl --size 24 --add 0xE9,0x20AC
+# Then use "text_font":"roboto_subset_24" after uploading bin/roboto_subset_24.bin
+
+import argparse
+import os
+import re
+import sys
+import json
+import subprocess
+from jsmin import jsmin
+
+TEXT_ATTRIBUTES = ("text", "txt", "value_str", "options", "template")
+FONT_ATTRIBUTES = ("text_font", "value_font")
+ICON_FIRST = 0xE000
+ICON_LAST = 0xF8FF
+ASCII_RANGE = range(0x20, 0x7F)
+
+with open("src/font/encodings.json") as js_file:
+    fonts = json.loads(jsmin(js_file.read()))
+
+with open("src/font/md-icons.json") as js_file:
+    icons = json.loads(jsmin(js_file.read()))
+
+# The icons are shifted into the private use area: "0xF0045=>0xE045"
+icon_map = {}
+for (name, code) in icons["icons"].items():
+    target = code.split("=>")[-1]
+    icon_map[int(target, base=16)] = code
+
+parser = argparse.ArgumentParser(description="Create .bin font subsets with the glyphs used in the pages")
+parser.add_argument("pages", nargs="*", default=["data/pages/pages.jsonl"], help="pages files to scan")
+parser.add_argument("--size", type=int, action="append", help="font size, can be repeated")
+parser.add_argument("--name", default="roboto_subset", help="font name, the files are named <name>_<size>.bin")
+parser.add_argument("--font", default=fonts["all"]["textfont"], help="text font to take the glyphs from")
+parser.add_argument("--bpp", type=int, default=3, help="bits per pixel")
+parser.add_argument("--output", default="bin", help="output folder")
+parser.add_argument("--add", default="", help="extra codepoints or ranges, like 0xE9,0x400-0x4FF")
+parser.add_argument("--no-ascii", action="store_true", help="don't include the printable ASCII range")
+parser.add_argument("--dry-run", action="store_true", help="only print the lv_font_conv commands")
+args = parser.parse_args()
+
+
+def parse_ranges(text):
+    codepoints = set()
+    for item in filter(None, text.split(",")):
+        first, _, last = item.strip().partition("-")
+        first = int(first, base=0)
+        last = int(last, base=0) if last else first
+        codepoints.update(range(first, last + 1))
+    return codepoints
+
+
+def format_ranges(codepoints):
+    ranges = []
+    for code in sorted(codepoints):
+        if ranges and ranges[-1][1] == code - 1:
+            ranges[-1][1] = code
+        else:
+            ranges.append([code, code])
+    return ",".join("0x{:X}".format(a) if a == b else "0x{:X}-0x{:X}".format(a, b) for (a, b) in ranges)
+
+
+def font_size(value):
+    match = re.search(r"(\d+)$", str(value))
+    return int(match.group(1)) if match else None
+
+
+def strings(value):
+    if isinstance(value, str):
+        yield value
+    elif isinstance(value, list):  # btnmatrix options
+        for item in value:
+            yield from strings(item)
+
+
+codepoints = set() if args.no_ascii else set(ASCII_RANGE)
+codepoints |= parse_ranges(args.add)
+sizes = set(args.size or [])
+objects = 0
+
+for path in args.pages:
+    with open(path, encoding="utf8") as pages:
+        for (number, line) in enumerate(pages, start=1):
+            line = jsmin(line).strip()
+            if not line:
+                continue
+            try:
+                obj = json.loads(line)
+            except ValueError as error:
+                print("{}:{}: skipped, {}".format(path, number, error), file=sys.stderr)
+                continue
+            objects += 1
+
+            for (key, value) in obj.items():
+                if key in TEXT_ATTRIBUTES:
+                    for text in strings(value):
+                        codepoints.update(ord(char) for char in text)
+                        if key == "template" or "%" in text:
+                            codepoints.update(ASCII_RANGE)  # filled in at runtime
+                elif key in FONT_ATTRIBUTES and not args.size:
+                    size = font_size(value)
+                    if size and size > 8:
+                        sizes.add(size)
+
+if not sizes:
+    sizes = set(fonts["all"]["size"])
+
+text_codes = {code for code in codepoints if not ICON_FIRST <= code <= ICON_LAST and code >= 0x20}
+icon_codes = {code for code in codepoints if ICON_FIRST <= code <= ICON_LAST}
+
+missing = sorted(code for code in icon_codes if code not in icon_map)
+for code in missing:
+    print("Unknown icon 0x{:X}".format(code), file=sys.stderr)
+icon_ranges = sorted(icon_map[code] for code in icon_codes if code in icon_map)
+
+print("{} objects scanned, {} text codepoints, {} icons".format(objects, len(text_codes), len(icon_ranges)))
+print("Text: {}".format(format_ranges(text_codes)))
+
+if not args.dry_run:
+    os.makedirs(args.output, exist_ok=True)
+
+for size in sorted(sizes):
+    output = os.path.join(args.output, "{}_{}.bin".format(args.name, size))
+    cmd = ["lv_font_conv", "--no-kerning", "--bpp", str(args.bpp), "--size", str(size)]
+    cmd += ["--font", args.font, "-r", format_ranges(text_codes)]
+    if icon_ranges:
+        cmd += ["--font", icons["iconfont"], "-r", ",".join(icon_ranges)]
+    cmd += ["-o", output, "--format", "bin"]
+
+    print(" ".join(cmd))
+    if not args.dry_run:
+        subprocess.run(cmd, check=True)
@@ -0,0 +1,141 @@
+#!/usr/bin/env python3
+
+# Converts PNG, JPG, BMP and GIF images into LVGL .bin images for openHASP
+#
+# The .bin images hold the RGB565 pixels of the display, so they are drawn straight from the file without
+# a decoder. Images with transparent pixels get an alpha byte per pixel (LV_IMG_CF_TRUE_COLOR_ALPHA).
+# Lines are RLE compressed when that is smaller, see src/hasp/hasp_image_rle.h for the format.
+# Requires Pillow: pip install pillow
+#
+# Example: python tools/hasp_img_convert.py images/background.png -o data/background.bin
+# Show it with: {"page":1,"id":2,"obj":"img","src":"L:/background.bin"}
+
+import argparse
+import os
+import struct
+import sys
+
+# lv_img_cf_t of LVGL v7
+CF_TRUE_COLOR = 4
+CF_TRUE_COLOR_ALPHA = 5
+CF_RLE_TRUE_COLOR = 24  # LV_IMG_CF_USER_ENCODED_0
+CF_RLE_TRUE_COLOR_ALPHA = 25  # LV_IMG_CF_USER_ENCODED_1
+
+MAX_SIZE = 2047  # w and h are 11 bits in the lvgl image header
+IMAGE_EXTENSIONS = (".png", ".jpg", ".jpeg", ".bmp", ".gif")
+
+
+def header(cf, width, height):
+    """lv_img_header_t: cf:5, always_zero:3, reserved:2, w:11, h:11"""
+    return struct.pack("<I", cf | (width << 10) | (height << 21))
+
+
+def pixel_bytes(rgba, alpha):
+    """RGB565 like lv_color_t with LV_COLOR_16_SWAP 0, followed by the alpha byte"""
+    r, g, b, a = rgba
+    data = struct.pack("<H", ((r >> 3) << 11) | ((g >> 2) << 5) | (b >> 3))
+    return data + bytes([a]) if alpha else data
+
+
+def rle_line(pixels):
+    """Packets of one line: n < 128 is followed by n + 1 pixels, n >= 128 by one pixel repeated n - 127 times"""
+    out = bytearray()
+    literal = []
+    i = 0
+    while i < len(pixels):
+        run = 1
+        while i + run < len(pixels) and run < 128 and pixels[i + run] == pixels[i]:
+            run += 1
+        if run >= 3 or (run == 2 and not literal):
+            if literal:
+                out.append(len(literal) - 1)
+                out += b"".join(literal)
+                literal = []
+            out.append(127 + run)
+            out += pixels[i]
+            i += run
+        else:
+            literal.append(pixels[i])
+            i += 1
+            if len(literal) == 128:
+                out.append(127)
+                out += b"".join(literal)
+                literal = []
+    if literal:
+        out.append(len(literal) - 1)
+        out += b"".join(literal)
+    return bytes(out)
+
+
+def encode(rgba, width, height, alpha, rle="auto"):
+    """Returns the .bin file of width x height RGBA tuples, rle is "yes", "no" or "auto" for the smallest"""
+    if not 0 < width <= MAX_SIZE or not 0 < height <= MAX_SIZE:
+        raise ValueError("images are limited to %dx%d pixels" % (MAX_SIZE, MAX_SIZE))
+
+    lines = []
+    for y in range(height):
+        lines.append([pixel_bytes(p, alpha) for p in rgba[y * width:(y + 1) * width]])
+
+    raw = header(CF_TRUE_COLOR_ALPHA if alpha else CF_TRUE_COLOR, width, height)
+    raw += b"".join(b"".join(line) for line in lines)
+    if rle == "no":
+        return raw
+
+    packed = [rle_line(line) for line in lines]
+    offset = 4 + 4 * (height + 1)  # behind the header and the line offsets
+    offsets = []
+    for line in packed:
+        offsets.append(offset)
+        offset += len(line)
+    offsets.append(offset)
+
+    compressed = header(CF_RLE_TRUE_COLOR_ALPHA if alpha else CF_RLE_TRUE_COLOR, width, height)
+    compressed += struct.pack("<%dI" % len(offsets), *offsets) + b"".join(packed)
+    if rle == "auto" and len(compressed) >= len(raw):
+        return raw
+    return compressed
+
+
+def convert(src, dst, rle="auto", alpha=None):
+    """Convert an image file, alpha is None to only keep the alpha channel when it is used"""
+    from PIL import Image
+
+    with Image.open(src) as img:
+        img = img.convert("RGBA")
+        rgba = list(img.getdata())
+        width, height = img.size
+
+    if alpha is None:
+        alpha = any(p[3] < 255 for p in rgba)
+    data = encode(rgba, width, height, alpha, rle)
+
+    with open(dst, "wb") as f:
+        f.write(data)
+    return data
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Convert images into LVGL .bin images for openHASP")
+    parser.add_argument("images", nargs="+", help="PNG, JPG, BMP or GIF images")
+    parser.add_argument("-o", "--output", help="output file of a single image, or the output folder")
+    parser.add_argument("--rle", choices=["auto", "yes", "no"], default="auto",
+                        help="compress the lines, auto only when that is smaller (default)")
+    parser.add_argument("--no-alpha", action="store_true", help="drop the transparency of the images")
+    args = parser.parse_args()
+
+    for src in args.images:
+        name = os.path.splitext(os.path.basename(src))[0] + ".bin"
+        if args.output and (len(args.images) > 1 or os.path.isdir(args.output)):
+            dst = os.path.join(args.output, name)
+        else:
+            dst = args.output or os.path.join(os.path.dirname(src), name)
+
+        try:
+            data = convert(src, dst, args.rle, False if args.no_alpha else None)
+        except (OSError, ValueError) as error:
+            sys.exit("%s: %s" % (src, error))
+        print("%s -> %s (%d bytes%s)" % (src, dst, len(data), ", RLE" if data[0] & 0x1F >= CF_RLE_TRUE_COLOR else ""))
+
+
+if __name__ == "__main__":
+    main()
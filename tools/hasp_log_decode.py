@@ -0,0 +1,210 @@
+#!/usr/bin/env python3
+
+# Formats a binary log ring dump of openHASP into text
+#
+# Firmware built with HASP_LOG_RING_SIZE keeps the log commands in a RAM ring without formatting them.
+# Only the address of the format string is stored, so the firmware.elf of the same build is needed to
+# look up the format strings. The ring is downloaded from http://<plate>/logring or saved to the flash
+# with the "logring" command.
+#
+# Example: python tools/hasp_log_decode.py logring.bin .pio/build/esp32-touchdown/firmware.elf
+
+import argparse
+import struct
+import sys
+
+LOG_RING_VERSION = 1
+LOG_RING_BOOT_LEVEL = 0xFF
+
+# Same names as debug_get_tag() in src/hasp_debug.cpp
+TAGS = {
+    0: "MAIN", 1: "HASP", 2: "ATTR", 3: "MSGR", 4: "OOBE", 5: "HAL ", 6: "DRVR", 8: "EVNT",
+    10: "DBUG", 11: "UART", 12: "TELN", 13: "SYSL", 14: "TASM",
+    20: "CONF", 21: "GUI ", 22: "TFT ",
+    30: "EPRM", 31: "FILE", 40: "GPIO",
+    60: "ETH ", 61: "WIFI", 62: "HTTP", 63: "OTA ", 64: "MDNS", 65: "MQTT", 66: "MQTT PUB", 67: "MQTT RCV",
+    68: "FTP ", 69: "TIME", 71: "WG  ",
+    90: "LVGL", 91: "LVFS", 92: "FONT",
+    99: "CUST",
+}
+
+LEVELS = {0: "FATAL", 1: "ALERT", 2: "CRIT", 3: "ERROR", 4: "WARN", 5: "INFO", 6: "TRACE", 7: "VERB", 8: "DEBUG",
+          9: "OUT"}
+
+# esp_reset_reason_t of the ESP32
+RESET_REASONS = {0: "unknown", 1: "power on", 2: "external", 3: "software", 4: "panic", 5: "interrupt watchdog",
+                 6: "task watchdog", 7: "watchdog", 8: "deep sleep", 9: "brownout", 10: "sdio"}
+
+
+class Elf:
+    """Reads zero terminated strings at their address from the sections of an ELF file"""
+
+    def __init__(self, filename):
+        with open(filename, "rb") as f:
+            self.data = f.read()
+        if self.data[:4] != b"\x7fELF":
+            raise ValueError("%s is not an ELF file" % filename)
+
+        is64 = self.data[4] == 2
+        endian = "<" if self.data[5] == 1 else ">"
+        if is64:
+            shoff, = struct.unpack_from(endian + "Q", self.data, 0x28)
+            shentsize, shnum = struct.unpack_from(endian + "HH", self.data, 0x3A)
+            fmt = endian + "IIQQQQ"
+        else:
+            shoff, = struct.unpack_from(endian + "I", self.data, 0x20)
+            shentsize, shnum = struct.unpack_from(endian + "HH", self.data, 0x2E)
+            fmt = endian + "IIIIII"
+
+        self.sections = []
+        for i in range(shnum):
+            _, sh_type, _, addr, offset, size = struct.unpack_from(fmt, self.data, shoff + i * shentsize)
+            if addr and sh_type != 8:  # SHT_NOBITS has no data in the file
+                self.sections.append((addr, offset, size))
+
+    def string(self, address):
+        for addr, offset, size in self.sections:
+            if addr <= address < addr + size:
+                start = offset + address - addr
+                end = self.data.find(b"\0", start, offset + size)
+                return self.data[start:end].decode("utf-8", "replace")
+        return None
+
+
+def read_items(payload):
+    """Splits the LogRecord of ArduinoLog into (type, value) items"""
+    items = []
+    pos = 0
+    while pos < len(payload):
+        kind = chr(payload[pos])
+        pos += 1
+        if kind in "Fp":
+            value, = struct.unpack_from("<I", payload, pos)
+            pos += 4
+        elif kind == "i":
+            value, = struct.unpack_from("<i", payload, pos)
+            pos += 4
+        elif kind == "q":
+            value, = struct.unpack_from("<q", payload, pos)
+            pos += 8
+        elif kind == "d":
+            value, = struct.unpack_from("<d", payload, pos)
+            pos += 8
+        elif kind == "s":
+            length = payload[pos]
+            value = payload[pos + 1:pos + 1 + length].decode("utf-8", "replace")
+            pos += 1 + length
+        elif kind == "?":
+            value = None
+        else:
+            break  # corrupt record
+        items.append((kind, value))
+    return items
+
+
+def item_string(item, elf):
+    kind, value = item
+    if kind == "s":
+        return value
+    if kind in "Fp":
+        text = elf.string(value) if elf else None
+        return text if text is not None else "<0x%08x>" % value
+    return "?"
+
+
+def item_int(item):
+    kind, value = item
+    if kind in "iqFp":
+        return value
+    if kind == "d":
+        return int(value)
+    return 0
+
+
+def format_message(items, elf):
+    """Applies the format string like Logging::printFormat does on the device"""
+    if not items:
+        return ""
+    fmt = item_string(items[0], elf)
+    args = iter(items[1:])
+    missing = ("?", None)
+    out = []
+    i = 0
+    while i < len(fmt):
+        c = fmt[i]
+        i += 1
+        if c != "%" or i >= len(fmt):
+            out.append(c)
+            continue
+        f = fmt[i]
+        i += 1
+        if f == "%":
+            out.append("%")
+        elif f in "sS":
+            out.append(item_string(next(args, missing), elf))
+        elif f in "dil":
+            out.append(str(item_int(next(args, missing))))
+        elif f == "u":
+            out.append(str(item_int(next(args, missing)) & 0xFFFFFFFF))
+        elif f in "DF":
+            kind, value = next(args, missing)
+            out.append("%.2f" % (value if kind == "d" else 0))
+        elif f in "xX":
+            out.append(("0x" if f == "X" else "") + "%X" % (item_int(next(args, missing)) & 0xFFFFFFFF))
+        elif f in "bB":
+            out.append(("0b" if f == "B" else "") + "{:b}".format(item_int(next(args, missing)) & 0xFFFFFFFF))
+        elif f == "c":
+            out.append(chr(item_int(next(args, missing)) & 0xFF))
+        elif f == "t":
+            out.append("T" if item_int(next(args, missing)) == 1 else "F")
+        elif f == "T":
+            out.append("true" if item_int(next(args, missing)) == 1 else "false")
+    return "".join(out)
+
+
+def decode(dump, elf, out):
+    if len(dump) < 16 or dump[:7] != b"HASPLOG":
+        raise ValueError("not a log ring dump")
+    if dump[7] != LOG_RING_VERSION:
+        raise ValueError("unsupported log ring version %d" % dump[7])
+
+    uptime, ring_size = struct.unpack_from("<II", dump, 8)
+    out.write("# Dumped at %.3f s uptime, %d of %d bytes used\n" % (uptime / 1000, len(dump) - 16, ring_size))
+
+    pos = 16
+    while pos + 8 <= len(dump):
+        size, millis, tag, level = struct.unpack_from("<HIBB", dump, pos)
+        if size < 8 or pos + size > len(dump):
+            out.write("# Corrupt record at offset %d\n" % pos)
+            break
+        items = read_items(dump[pos + 8:pos + size])
+        pos += size
+
+        if level == LOG_RING_BOOT_LEVEL:
+            reason = item_int(items[0]) if items else None
+            text = "" if reason is None else ", reset reason: %s" % RESET_REASONS.get(reason, reason)
+            out.write("# ---- Boot%s ----\n" % text)
+            continue
+
+        out.write("[%10.3f] %-5s %s: %s\n" % (millis / 1000, LEVELS.get(level, level), TAGS.get(tag, "----"),
+                                              format_message(items, elf)))
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Format a binary log ring dump of openHASP")
+    parser.add_argument("dump", help="logring.bin downloaded from the plate")
+    parser.add_argument("elf", nargs="?", help="firmware.elf of the same build, to look up the format strings")
+    args = parser.parse_args()
+
+    with open(args.dump, "rb") as f:
+        dump = f.read()
+    elf = Elf(args.elf) if args.elf else None
+
+    try:
+        decode(dump, elf, sys.stdout)
+    except ValueError as error:
+        sys.exit("%s: %s" % (args.dump, error))
+
+
+if __name__ == "__main__":
+    main()
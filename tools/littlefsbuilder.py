@@ -1,2 +1,38 @@
 Import("env")
-env.Replace( MKSPIFFSTOOL=env.get("PROJECT_DIR") + '/tools/mklittlefs' )
\ No newline at end of file
+import os
+import sys
+
+env.Replace( MKSPIFFSTOOL=env.get("PROJECT_DIR") + '/tools/mklittlefs' )
+
+# Convert the images in the custom_images_dir folder, "images" by default, to LVGL .bin images in the data
+# folder before the filesystem image is built. Set custom_images_rle = no in the env to skip compression.
+def convert_images(source, target, env):
+    project_dir = env.subst("$PROJECT_DIR")
+    image_dir = os.path.join(project_dir, env.GetProjectOption("custom_images_dir", "images"))
+    data_dir = env.subst("$PROJECT_DATA_DIR")
+    rle = env.GetProjectOption("custom_images_rle", "auto")
+    if not os.path.isdir(image_dir):
+        return
+
+    sys.path.insert(0, os.path.join(project_dir, "tools"))
+    import hasp_img_convert
+
+    for root, _, files in os.walk(image_dir):
+        for name in files:
+            if not name.lower().endswith(hasp_img_convert.IMAGE_EXTENSIONS):
+                continue
+            src = os.path.join(root, name)
+            folder = os.path.join(data_dir, os.path.relpath(root, image_dir))
+            dst = os.path.join(folder, os.path.splitext(name)[0] + ".bin")
+            if os.path.exists(dst) and os.path.getmtime(dst) >= os.path.getmtime(src):
+                continue
+
+            os.makedirs(folder, exist_ok=True)
+            try:
+                data = hasp_img_convert.convert(src, dst, rle)
+            except ImportError:
+                print("Pillow is needed to convert the images: pip install pillow")
+                return
+            print("Converted %s to %s (%d bytes)" % (os.path.relpath(src, project_dir), os.path.relpath(dst, project_dir), len(data)))
+
+env.AddPreAction("$BUILD_DIR/${ESP32_FS_IMAGE_NAME}.bin", convert_images)